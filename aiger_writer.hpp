@@ -0,0 +1,295 @@
+#pragma once
+
+#include <algorithm>
+#include <bitset>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "cut_database.hpp"
+#include "lut_arena.hpp"
+
+/* AIG output of the rebuild (`rebuild_from_cpsat <output>.aig`).
+ *
+ * Every LUT of a `lut_arena` is decomposed into two-input ANDs and written as
+ * binary AIGER, so the DAC'19 flow reads the rebuilt circuit without the BLIF
+ * round trip through ABC (`blif_to_aig.py`). A LUT is the ISOP of its ON-set
+ * or of its OFF-set, complemented, whichever has fewer literals; the cubes and
+ * their disjunction are balanced AND trees, and LUTs of more than 6 inputs are
+ * multiplexed on their upper variables. ANDs are structurally hashed over the
+ * whole netlist, so logic shared by several LUTs is created once. The symbol
+ * table keeps the PI and PO names.
+ */
+namespace cpsat
+{
+
+struct aiger_stats
+{
+  uint32_t ands{ 0u };
+
+  /*! \brief Complemented AND fanins and outputs, i.e. the inverters of the AIG. */
+  uint32_t complemented_edges{ 0u };
+};
+
+/*! \brief Structurally hashed AIG over AIGER literals (`2 * variable + complement`). */
+class aig_builder
+{
+public:
+  using literal = uint32_t;
+
+  explicit aig_builder( uint32_t num_pis ) : _num_pis( num_pis ) {}
+
+  literal get_constant( bool value ) const
+  {
+    return value ? 1u : 0u;
+  }
+
+  literal pi( uint32_t i ) const
+  {
+    return 2u * ( 1u + i );
+  }
+
+  literal create_and( literal a, literal b )
+  {
+    if ( a > b )
+    {
+      std::swap( a, b );
+    }
+    if ( a == 0u || a == ( b ^ 1u ) )
+      return 0u;
+    if ( a == 1u || a == b )
+      return b;
+    auto const key = ( uint64_t( b ) << 32u ) | a;
+    auto const it = _strash.find( key );
+    if ( it != _strash.end() )
+    {
+      return it->second;
+    }
+    _ands.emplace_back( b, a );
+    literal const lit = 2u * ( _num_pis + static_cast<uint32_t>( _ands.size() ) );
+    _strash.emplace( key, lit );
+    return lit;
+  }
+
+  literal create_or( literal a, literal b )
+  {
+    return create_and( a ^ 1u, b ^ 1u ) ^ 1u;
+  }
+
+  literal create_mux( literal sel, literal then_lit, literal else_lit )
+  {
+    if ( then_lit == else_lit )
+    {
+      return then_lit;
+    }
+    return create_or( create_and( sel, then_lit ), create_and( sel ^ 1u, else_lit ) );
+  }
+
+  /*! \brief Balanced AND (or OR) tree over `lits`, which is used as scratch space. */
+  literal create_nary( std::vector<literal>& lits, bool is_or )
+  {
+    if ( lits.empty() )
+    {
+      return get_constant( !is_or );
+    }
+    auto const flip = is_or ? 1u : 0u;
+    for ( auto& l : lits )
+    {
+      l ^= flip;
+    }
+    while ( lits.size() > 1u )
+    {
+      auto out = 0u;
+      for ( auto i = 0u; i + 1u < lits.size(); i += 2u )
+      {
+        lits[out++] = create_and( lits[i], lits[i + 1u] );
+      }
+      if ( lits.size() % 2u == 1u )
+      {
+        lits[out++] = lits.back();
+      }
+      lits.resize( out );
+    }
+    return lits.front() ^ flip;
+  }
+
+  uint32_t num_pis() const
+  {
+    return _num_pis;
+  }
+
+  uint32_t num_ands() const
+  {
+    return static_cast<uint32_t>( _ands.size() );
+  }
+
+  /*! \brief Fanins (larger literal first) of AND `i`, whose literal is `2 * (num_pis() + 1 + i)`. */
+  std::pair<literal, literal> const& and_fanins( uint32_t i ) const
+  {
+    return _ands[i];
+  }
+
+private:
+  uint32_t _num_pis;
+  std::vector<std::pair<literal, literal>> _ands;
+  std::unordered_map<uint64_t, literal> _strash;
+};
+
+namespace detail
+{
+
+/*! \brief Sum of products over `inputs` of a function of at most 6 variables, in the smaller of both polarities. */
+inline aig_builder::literal word_to_aig( aig_builder& aig, uint64_t word, aig_builder::literal const* inputs, uint32_t num_vars,
+                                         std::vector<std::pair<uint32_t, uint32_t>>& on_cubes,
+                                         std::vector<std::pair<uint32_t, uint32_t>>& off_cubes,
+                                         std::vector<aig_builder::literal>& cube_lits,
+                                         std::vector<aig_builder::literal>& sum_lits )
+{
+  word = replicate_word( word, num_vars );
+  on_cubes.clear();
+  off_cubes.clear();
+  word_isop( word, word, num_vars, 0u, 0u, on_cubes );
+  word_isop( ~word, ~word, num_vars, 0u, 0u, off_cubes );
+  auto literals = []( auto const& cubes ) {
+    std::size_t count = 0u;
+    for ( auto const& cube : cubes )
+    {
+      count += std::bitset<32>( cube.first ).count();
+    }
+    return count;
+  };
+  bool const use_off = literals( off_cubes ) < literals( on_cubes );
+  auto const& cubes = use_off ? off_cubes : on_cubes;
+
+  sum_lits.clear();
+  for ( auto const& [mask, bits] : cubes )
+  {
+    cube_lits.clear();
+    for ( auto v = 0u; v < num_vars; ++v )
+    {
+      if ( ( mask >> v ) & 1u )
+      {
+        cube_lits.push_back( inputs[v] ^ ( ( bits >> v ) & 1u ? 0u : 1u ) );
+      }
+    }
+    sum_lits.push_back( aig.create_nary( cube_lits, false ) );
+  }
+  return aig.create_nary( sum_lits, true ) ^ ( use_off ? 1u : 0u );
+}
+
+inline void write_aiger_unsigned( std::ostream& os, uint32_t value )
+{
+  while ( value >= 0x80u )
+  {
+    os.put( static_cast<char>( ( value & 0x7fu ) | 0x80u ) );
+    value >>= 7u;
+  }
+  os.put( static_cast<char>( value ) );
+}
+
+} // namespace detail
+
+/*! \brief Decomposes the LUTs of `net` into an AIG; returns it with the literal driving each PO in `outputs`. */
+inline aig_builder lut_arena_to_aig( lut_arena const& net, std::vector<aig_builder::literal>& outputs )
+{
+  using literal = aig_builder::literal;
+  aig_builder aig( net.num_pis() );
+  std::vector<literal> signal_lits( net.size() );
+  signal_lits[net.get_constant( false )] = aig.get_constant( false );
+  signal_lits[net.get_constant( true )] = aig.get_constant( true );
+  for ( auto i = 0u; i < net.num_pis(); ++i )
+  {
+    signal_lits[2u + i] = aig.pi( i );
+  }
+
+  std::vector<std::pair<uint32_t, uint32_t>> on_cubes, off_cubes;
+  std::vector<literal> inputs, blocks, cube_lits, sum_lits;
+  for ( auto i = 0u; i < net.num_luts(); ++i )
+  {
+    auto const& l = net.lut_at( i );
+    inputs.clear();
+    for ( auto f = net.fanins_begin( l ); f != net.fanins_end( l ); ++f )
+    {
+      inputs.push_back( signal_lits[*f] );
+    }
+    auto const word_vars = std::min( l.num_fanins, 6u );
+    auto const words = net.tt_begin( l );
+    blocks.clear();
+    for ( auto b = 0u; b < tt_num_words( l.num_fanins ); ++b )
+    {
+      blocks.push_back( detail::word_to_aig( aig, words[b], inputs.data(), word_vars, on_cubes, off_cubes, cube_lits, sum_lits ) );
+    }
+    /* block b holds the minterms with bit k of b as variable 6 + k */
+    for ( auto v = 6u; v < l.num_fanins; ++v )
+    {
+      for ( auto b = 0u; 2u * b < blocks.size(); ++b )
+      {
+        blocks[b] = aig.create_mux( inputs[v], blocks[2u * b + 1u], blocks[2u * b] );
+      }
+      blocks.resize( blocks.size() / 2u );
+    }
+    signal_lits[2u + net.num_pis() + i] = blocks.front();
+  }
+
+  outputs.clear();
+  for ( auto i = 0u; i < net.num_pos(); ++i )
+  {
+    outputs.push_back( signal_lits[net.po_driver( i )] );
+  }
+  return aig;
+}
+
+/*! \brief Writes `net` as binary AIGER (`aig M I 0 O A`) with a PI/PO symbol table; false if the file cannot be written. */
+inline bool write_aiger( lut_arena const& net, std::string const& filename, aiger_stats* st = nullptr )
+{
+  std::vector<aig_builder::literal> outputs;
+  auto const aig = lut_arena_to_aig( net, outputs );
+
+  std::vector<char> buffer( 1u << 20u );
+  std::ofstream os;
+  os.rdbuf()->pubsetbuf( buffer.data(), static_cast<std::streamsize>( buffer.size() ) );
+  os.open( filename, std::ios::binary );
+  if ( !os )
+  {
+    return false;
+  }
+
+  auto const num_pis = aig.num_pis();
+  os << "aig " << ( num_pis + aig.num_ands() ) << ' ' << num_pis << " 0 " << outputs.size() << ' ' << aig.num_ands() << "\n";
+  for ( auto lit : outputs )
+  {
+    os << lit << "\n";
+  }
+  uint32_t complemented = 0u;
+  for ( auto i = 0u; i < aig.num_ands(); ++i )
+  {
+    auto const lhs = 2u * ( num_pis + 1u + i );
+    auto const& [rhs0, rhs1] = aig.and_fanins( i );
+    detail::write_aiger_unsigned( os, lhs - rhs0 );
+    detail::write_aiger_unsigned( os, rhs0 - rhs1 );
+    complemented += ( rhs0 & 1u ) + ( rhs1 & 1u );
+  }
+  for ( auto i = 0u; i < num_pis; ++i )
+  {
+    os << 'i' << i << ' ' << net.pi_name( i ) << "\n";
+  }
+  for ( auto i = 0u; i < outputs.size(); ++i )
+  {
+    os << 'o' << i << ' ' << net.po_name( i ) << "\n";
+    complemented += outputs[i] > 1u ? ( outputs[i] & 1u ) : 0u;
+  }
+  os << "c\nrebuild_from_cpsat\n";
+  os.flush();
+
+  if ( st != nullptr )
+  {
+    st->ands = aig.num_ands();
+    st->complemented_edges = complemented;
+  }
+  return static_cast<bool>( os );
+}
+
+} // namespace cpsat
@@ -0,0 +1,538 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <kitty/dynamic_truth_table.hpp>
+
+#include <lorina/blif.hpp>
+
+#include <mockturtle/io/blif_reader.hpp>
+#include <mockturtle/traits.hpp>
+
+#include "thread_pool.hpp"
+
+/* Memory-mapped BLIF loader for combinational k-LUT netlists.
+ *
+ * The file is mapped and tokenized in place: names and cover rows are
+ * string views into the mapping. `.names` covers are then turned into
+ * truth tables on all threads, and the network is built in one sequential
+ * pass. PIs, nodes and POs are created in the order lorina's reader with
+ * mockturtle's `blif_reader` creates them, so node indices (and therefore
+ * cut files) are the same with either reader.
+ *
+ * Only what that order can be reproduced for is handled here: `.model`,
+ * `.inputs`, `.outputs`, `.names` and `.end`, with every `.names` placed
+ * after the definitions of its inputs. Anything else (latches, subcircuits,
+ * out-of-order definitions) is left to lorina by `read_blif_file`.
+ */
+namespace cpsat
+{
+
+enum class blif_load_status
+{
+  success,
+  unsupported, /* valid BLIF outside the subset above; the network is untouched */
+  error
+};
+
+namespace detail
+{
+
+/*! \brief Read-only mapping of a whole file. */
+class mapped_file
+{
+public:
+  mapped_file() = default;
+  mapped_file( mapped_file const& ) = delete;
+  mapped_file& operator=( mapped_file const& ) = delete;
+
+  ~mapped_file()
+  {
+    if ( _data != nullptr )
+    {
+      ::munmap( const_cast<char*>( _data ), _size );
+    }
+  }
+
+  bool open( std::string const& filename )
+  {
+    int fd = ::open( filename.c_str(), O_RDONLY );
+    if ( fd < 0 )
+    {
+      return false;
+    }
+    struct stat st;
+    if ( ::fstat( fd, &st ) != 0 )
+    {
+      ::close( fd );
+      return false;
+    }
+    _size = static_cast<size_t>( st.st_size );
+    if ( _size == 0u )
+    {
+      ::close( fd );
+      return true;
+    }
+    void* addr = ::mmap( nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0 );
+    ::close( fd );
+    if ( addr == MAP_FAILED )
+    {
+      _size = 0u;
+      return false;
+    }
+    ::madvise( addr, _size, MADV_SEQUENTIAL );
+    _data = static_cast<char const*>( addr );
+    return true;
+  }
+
+  std::string_view contents() const { return _data != nullptr ? std::string_view( _data, _size ) : std::string_view(); }
+
+private:
+  char const* _data{ nullptr };
+  size_t _size{ 0u };
+};
+
+/*! \brief Cover row of a `.names` block: input cube and output value. */
+struct blif_cover_row
+{
+  std::string_view cube;
+  char value;
+};
+
+struct blif_names_block
+{
+  uint32_t first_input; /* into blif_netlist::names */
+  uint32_t num_inputs;
+  std::string_view output;
+  uint32_t first_row; /* into blif_netlist::rows */
+  uint32_t num_rows;
+};
+
+/*! \brief Tokenized netlist; every view points into the mapped file. */
+struct blif_netlist
+{
+  /*! \brief PI (`block == no_block`) or `.names` block, in file order. */
+  struct event
+  {
+    uint32_t block;
+    std::string_view name;
+  };
+  static constexpr uint32_t no_block = UINT32_MAX;
+
+  std::vector<event> events;
+  std::vector<std::string_view> outputs;
+  std::vector<std::string_view> names;
+  std::vector<blif_names_block> blocks;
+  std::vector<blif_cover_row> rows;
+};
+
+/*! \brief Splits the file into logical lines (comments stripped, `\` continuations joined) and their tokens. */
+class blif_tokenizer
+{
+public:
+  explicit blif_tokenizer( std::string_view text )
+      : _text( text )
+  {
+  }
+
+  /*! \brief Tokens of the next non-empty logical line; false at the end of the file. */
+  bool next_line( std::vector<std::string_view>& tokens )
+  {
+    tokens.clear();
+    while ( _pos < _text.size() )
+    {
+      auto end = _text.find( '\n', _pos );
+      if ( end == std::string_view::npos )
+      {
+        end = _text.size();
+      }
+      auto line = _text.substr( _pos, end - _pos );
+      _pos = end + 1u;
+
+      auto const comment = line.find( '#' );
+      if ( comment != std::string_view::npos )
+      {
+        line = line.substr( 0, comment );
+      }
+      while ( !line.empty() && is_space( line.back() ) )
+      {
+        line.remove_suffix( 1u );
+      }
+      bool const continued = !line.empty() && line.back() == '\\';
+      if ( continued )
+      {
+        line.remove_suffix( 1u );
+      }
+
+      split( line, tokens );
+      if ( !continued && !tokens.empty() )
+      {
+        return true;
+      }
+    }
+    return !tokens.empty();
+  }
+
+private:
+  static bool is_space( char c )
+  {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\f' || c == '\v';
+  }
+
+  static void split( std::string_view line, std::vector<std::string_view>& tokens )
+  {
+    size_t i = 0u;
+    while ( i < line.size() )
+    {
+      while ( i < line.size() && is_space( line[i] ) )
+      {
+        ++i;
+      }
+      auto const begin = i;
+      while ( i < line.size() && !is_space( line[i] ) )
+      {
+        ++i;
+      }
+      if ( i > begin )
+      {
+        tokens.push_back( line.substr( begin, i - begin ) );
+      }
+    }
+  }
+
+  std::string_view _text;
+  size_t _pos{ 0u };
+};
+
+/*! \brief Tokenizes `text` into `nl`; returns `unsupported` for constructs outside the loader's subset or malformed lines. */
+inline blif_load_status tokenize_blif( std::string_view text, blif_netlist& nl )
+{
+  blif_tokenizer tokenizer( text );
+  std::vector<std::string_view> tokens;
+  bool in_model = false;
+  bool in_names = false;
+  bool ended = false;
+  while ( !ended && tokenizer.next_line( tokens ) )
+  {
+    auto const& cmd = tokens[0];
+    if ( cmd[0] != '.' )
+    {
+      if ( !in_names || tokens.size() > 2u )
+      {
+        return blif_load_status::unsupported; /* let lorina report it */
+      }
+      auto& block = nl.blocks.back();
+      blif_cover_row row;
+      if ( tokens.size() == 1u )
+      {
+        row = { std::string_view(), cmd.size() == 1u ? cmd[0] : '?' };
+      }
+      else
+      {
+        row = { tokens[0], tokens[1].size() == 1u ? tokens[1][0] : '?' };
+      }
+      nl.rows.push_back( row );
+      ++block.num_rows;
+      continue;
+    }
+
+    in_names = false;
+    if ( cmd == ".model" )
+    {
+      if ( in_model )
+      {
+        return blif_load_status::unsupported; /* hierarchical netlist */
+      }
+      in_model = true;
+    }
+    else if ( cmd == ".inputs" )
+    {
+      for ( auto i = 1u; i < tokens.size(); ++i )
+      {
+        nl.events.push_back( { blif_netlist::no_block, tokens[i] } );
+      }
+    }
+    else if ( cmd == ".outputs" )
+    {
+      nl.outputs.insert( nl.outputs.end(), tokens.begin() + 1, tokens.end() );
+    }
+    else if ( cmd == ".names" )
+    {
+      if ( tokens.size() < 2u )
+      {
+        return blif_load_status::unsupported;
+      }
+      blif_names_block block;
+      block.first_input = static_cast<uint32_t>( nl.names.size() );
+      block.num_inputs = static_cast<uint32_t>( tokens.size() - 2u );
+      block.output = tokens.back();
+      block.first_row = static_cast<uint32_t>( nl.rows.size() );
+      block.num_rows = 0u;
+      nl.names.insert( nl.names.end(), tokens.begin() + 1, tokens.end() - 1 );
+      nl.events.push_back( { static_cast<uint32_t>( nl.blocks.size() ), block.output } );
+      nl.blocks.push_back( block );
+      in_names = true;
+    }
+    else if ( cmd == ".end" )
+    {
+      ended = true;
+    }
+    else
+    {
+      return blif_load_status::unsupported; /* .latch, .subckt, .gate, ... */
+    }
+  }
+  if ( !ended )
+  {
+    return blif_load_status::unsupported; /* lorina's reader creates the POs at .end */
+  }
+  return blif_load_status::success;
+}
+
+/*! \brief Truth table of a cover as `blif_reader` builds it; false if the cover is malformed.
+ *
+ * Character `i` of a cube is variable `i`; an off-set cover (output `0`)
+ * is complemented. Rows are evaluated word by word, no cubes are built.
+ */
+inline bool cover_to_truth_table( blif_netlist const& nl, blif_names_block const& block, kitty::dynamic_truth_table& tt )
+{
+  static constexpr uint64_t neg_masks[] = {
+      0x5555555555555555u, 0x3333333333333333u, 0x0f0f0f0f0f0f0f0fu,
+      0x00ff00ff00ff00ffu, 0x0000ffff0000ffffu, 0x00000000ffffffffu };
+
+  auto const n = block.num_inputs;
+  if ( n > 32u )
+  {
+    return false; /* kitty::cube limit, as in blif_reader */
+  }
+  tt = kitty::dynamic_truth_table( n );
+  uint64_t const used = n >= 6u ? ~uint64_t( 0 ) : ( uint64_t( 1 ) << ( 1u << n ) ) - 1u;
+
+  char polarity = 0;
+  for ( auto r = 0u; r < block.num_rows; ++r )
+  {
+    auto const& row = nl.rows[block.first_row + r];
+    if ( row.cube.size() != n || ( row.value != '0' && row.value != '1' ) || ( polarity != 0 && row.value != polarity ) )
+    {
+      return false;
+    }
+    polarity = row.value;
+
+    uint64_t low_mask = used;
+    uint64_t high_care = 0u, high_value = 0u;
+    for ( auto i = 0u; i < n; ++i )
+    {
+      auto const c = row.cube[i];
+      if ( c == '-' )
+      {
+        continue;
+      }
+      if ( c != '0' && c != '1' )
+      {
+        return false;
+      }
+      if ( i < 6u )
+      {
+        low_mask &= c == '1' ? ~neg_masks[i] : neg_masks[i];
+      }
+      else
+      {
+        high_care |= uint64_t( 1 ) << ( i - 6u );
+        high_value |= uint64_t( c == '1' ) << ( i - 6u );
+      }
+    }
+    uint64_t w = 0u;
+    for ( auto it = tt.begin(); it != tt.end(); ++it, ++w )
+    {
+      if ( ( w & high_care ) == high_value )
+      {
+        *it |= low_mask;
+      }
+    }
+  }
+
+  if ( polarity == '0' )
+  {
+    for ( auto it = tt.begin(); it != tt.end(); ++it )
+    {
+      *it = ~*it & used;
+    }
+  }
+  return true;
+}
+
+} // namespace detail
+
+/*! \brief Loads `filename` into the empty network `ntk` with the mapped loader.
+ *
+ * Covers are converted on `num_threads` threads (0: one per hardware
+ * thread). `error` means the file could not be mapped; on `unsupported`
+ * or `error`, `ntk` has not been modified.
+ */
+template<class Ntk>
+blif_load_status read_blif_mapped( std::string const& filename, Ntk& ntk, std::string& error, uint32_t num_threads = 0u )
+{
+  using signal = typename Ntk::signal;
+
+  detail::mapped_file file;
+  if ( !file.open( filename ) )
+  {
+    error = "cannot open '" + filename + "'";
+    return blif_load_status::error;
+  }
+
+  detail::blif_netlist nl;
+  if ( auto const status = detail::tokenize_blif( file.contents(), nl ); status != blif_load_status::success )
+  {
+    return status;
+  }
+
+  // Resolve names to the event defining them; every .names must follow the
+  // definitions of its inputs for the creation order to match lorina's
+  std::vector<uint32_t> fanin_events( nl.names.size() );
+  std::vector<uint32_t> output_events;
+  output_events.reserve( nl.outputs.size() );
+  {
+    std::unordered_map<std::string_view, uint32_t> defined;
+    defined.reserve( nl.events.size() );
+    for ( auto e = 0u; e < nl.events.size(); ++e )
+    {
+      auto const& event = nl.events[e];
+      if ( event.block != detail::blif_netlist::no_block )
+      {
+        auto const& block = nl.blocks[event.block];
+        for ( auto i = block.first_input; i < block.first_input + block.num_inputs; ++i )
+        {
+          auto const it = defined.find( nl.names[i] );
+          if ( it == defined.end() )
+          {
+            return blif_load_status::unsupported;
+          }
+          fanin_events[i] = it->second;
+        }
+      }
+      defined[event.name] = e; /* a redefinition shadows the old signal, as in blif_reader */
+    }
+    for ( auto const& o : nl.outputs )
+    {
+      auto const it = defined.find( o );
+      if ( it == defined.end() )
+      {
+        return blif_load_status::unsupported;
+      }
+      output_events.push_back( it->second );
+    }
+  }
+
+  // Covers to truth tables, in parallel for large netlists
+  std::vector<kitty::dynamic_truth_table> functions( nl.blocks.size() );
+  std::atomic<bool> malformed{ false };
+  std::function<void( uint32_t, uint32_t )> const convert = [&]( uint32_t, uint32_t b ) {
+    if ( !detail::cover_to_truth_table( nl, nl.blocks[b], functions[b] ) )
+    {
+      malformed = true;
+    }
+  };
+  auto const threads = nl.blocks.size() >= 4096u ? resolve_num_threads( num_threads ) : 1u;
+  if ( threads > 1u )
+  {
+    thread_pool pool( threads );
+    pool.parallel_for( static_cast<uint32_t>( nl.blocks.size() ), convert );
+  }
+  else
+  {
+    for ( auto b = 0u; b < nl.blocks.size(); ++b )
+    {
+      convert( 0u, b );
+    }
+  }
+  if ( malformed )
+  {
+    return blif_load_status::unsupported; /* let lorina report it */
+  }
+
+  // Build the network in file order, as blif_reader's callbacks do
+  std::vector<signal> signals( nl.events.size() );
+  std::vector<signal> children;
+  for ( auto e = 0u; e < nl.events.size(); ++e )
+  {
+    auto const& event = nl.events[e];
+    if ( event.block == detail::blif_netlist::no_block )
+    {
+      signals[e] = ntk.create_pi();
+      if constexpr ( mockturtle::has_set_name_v<Ntk> )
+      {
+        ntk.set_name( signals[e], std::string( event.name ) );
+      }
+      continue;
+    }
+
+    auto const& block = nl.blocks[event.block];
+    if ( block.num_inputs == 0u )
+    {
+      bool const value = block.num_rows > 0u && nl.rows[block.first_row].value == '1';
+      signals[e] = ntk.get_constant( value );
+      continue;
+    }
+    children.clear();
+    for ( auto i = block.first_input; i < block.first_input + block.num_inputs; ++i )
+    {
+      children.push_back( signals[fanin_events[i]] );
+    }
+    signals[e] = ntk.create_node( children, functions[event.block] );
+  }
+
+  for ( auto o = 0u; o < nl.outputs.size(); ++o )
+  {
+    ntk.create_po( signals[output_events[o]] );
+    if constexpr ( mockturtle::has_set_output_name_v<Ntk> )
+    {
+      ntk.set_output_name( ntk.num_pos() - 1u, std::string( nl.outputs[o] ) );
+    }
+  }
+  return blif_load_status::success;
+}
+
+/*! \brief Reads `filename` into `ntk`: the mapped loader when it applies, lorina's reader otherwise.
+ *
+ * Returns false after printing the reason if neither can read the file.
+ */
+template<class Ntk>
+bool read_blif_file( std::string const& filename, Ntk& ntk, uint32_t num_threads = 0u )
+{
+  std::string error;
+  switch ( read_blif_mapped( filename, ntk, error, num_threads ) )
+  {
+  case blif_load_status::success:
+    return true;
+  case blif_load_status::error:
+    std::cerr << "Error reading BLIF '" << filename << "': " << error << "\n";
+    return false;
+  case blif_load_status::unsupported:
+    break;
+  }
+
+  mockturtle::blif_reader reader( ntk );
+  if ( lorina::read_blif( filename, reader ) != lorina::return_code::success )
+  {
+    std::cerr << "Error reading BLIF '" << filename << "'\n";
+    return false;
+  }
+  return true;
+}
+
+} // namespace cpsat
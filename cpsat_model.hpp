@@ -0,0 +1,721 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <ortools/sat/cp_model.h>
+#include <ortools/sat/cp_model_solver.h>
+#include <ortools/sat/sat_parameters.pb.h>
+
+#include "cut_database.hpp"
+#include "cut_rebuild.hpp"
+
+/* CP-SAT cut selection over a cut database, the C++ counterpart of
+ * `main_cpsat.solve_circuit`. Model, objectives, depth bound and phase
+ * parameters follow the Python code; variables are addressed by node
+ * position instead of by name, so building the model is linear in the
+ * number of cuts and leaves.
+ */
+namespace cpsat
+{
+
+/*! \brief Objective weights, same defaults as in main_cpsat.py. */
+struct objective_weights
+{
+  int64_t lambda_inv{ 10 };
+  int64_t lambda_area{ 1 };
+  int64_t alpha_depth{ 100 };
+  int64_t beta_area{ 10 };
+  int64_t gamma_inv{ 1 };
+};
+
+/*! \brief Parameters of a single CP-SAT call (`solve_model` in main_cpsat.py). */
+struct phase_params
+{
+  double time_limit{ 10.0 };
+  double absolute_gap{ 0.0 }; /* 0: not set */
+  double relative_gap{ 0.0 }; /* 0: not set */
+  int num_workers{ 50 };
+  int seed{ 1 };
+  bool stop_after_first{ false };
+};
+
+/*! \brief Entry of `solve_params::hint` for a node the hint does not decide, e.g. the changed logic of an ECO hint. */
+constexpr uint32_t open_hint = no_chosen_cut - 1u;
+
+struct solve_params
+{
+  /*! \brief One of `og`, `inv`, `area`, `depth`, `overall`. */
+  std::string objective{ "og" };
+
+  /*! \brief Enforce this global depth instead of minimizing it, in LUT levels (levels of the input network with `cone_costs`). */
+  std::optional<uint32_t> fix_depth;
+
+  /*! \brief Area and depth objectives on `cut_record::cone_area` and `cone_depth` instead of leaves and LUT levels. */
+  bool cone_costs{ false };
+
+  objective_weights weights;
+
+  /*! \brief Solve of the `og`, `inv` and `area` objectives. */
+  phase_params single{ 15.0, 0.0, 0.05, 50, 0, false };
+
+  /*! \brief Phase A of `depth`/`overall`: minimize D, stop at the first solution. */
+  phase_params phase_a{ 120.0, 1.0, 0.0, 16, 1, true };
+
+  /*! \brief Phase B of `depth`/`overall`: D fixed, minimize the tie-breaker. */
+  phase_params phase_b{ 60.0, 0.0, 0.0, 16, 1, false };
+
+  /*! \brief Chosen cut per node index to start the first solve from (e.g. a greedy cover); empty: no hint.
+   *
+   * Phase B always starts from the phase A solution. Entries equal to
+   * `open_hint` leave the node to the solver.
+   */
+  std::vector<uint32_t> hint;
+
+  /*! \brief Fixes the cuts chosen by `hint` for the nodes that stay used, in every phase, instead of only hinting them (ECO mode). */
+  bool fix_hint{ false };
+
+  bool verbose{ false };
+};
+
+struct solve_result
+{
+  std::string status;
+  bool feasible{ false };
+  double objective_value{ 0.0 };
+
+  /*! \brief Global depth D, set for depth models. */
+  std::optional<int64_t> depth;
+
+  /*! \brief Phase B objective, set when phase B found a solution. */
+  std::optional<double> tie_objective;
+
+  /*! \brief Chosen cut per node index, `no_chosen_cut` for unused nodes. */
+  std::vector<uint32_t> chosen_cut;
+};
+
+/*! \brief Objectives accepted by `solve_cut_selection`. */
+inline bool is_known_objective( std::string const& mode )
+{
+  return mode == "og" || mode == "original" || mode == "inv" || mode == "area" || mode == "depth" || mode == "overall";
+}
+
+inline bool is_depth_objective( std::string const& mode )
+{
+  return mode == "depth" || mode == "overall";
+}
+
+namespace detail
+{
+
+constexpr uint32_t no_node = std::numeric_limits<uint32_t>::max();
+
+inline bool is_self_cut( cut_database_view const& db, node_record const& nd, cut_record const& cut )
+{
+  return cut.num_leaves == 1u && db.leaves[cut.leaf_begin] == nd.index;
+}
+
+/*! \brief Position in `db.nodes` of each node index, `no_node` for PIs and constants. */
+inline std::vector<uint32_t> node_positions( cut_database_view const& db )
+{
+  std::vector<uint32_t> pos( db.num_names, no_node );
+  for ( auto i = 0u; i < db.num_nodes; ++i )
+  {
+    pos[db.nodes[i].index] = i;
+  }
+  return pos;
+}
+
+/*! \brief Root forced when the cut file has no outputs: `Nout` if present, else the last node. */
+inline uint32_t fallback_root( cut_database_view const& db )
+{
+  for ( auto i = 0u; i < db.num_nodes; ++i )
+  {
+    if ( db.name( db.nodes[i].index ) == "Nout" )
+    {
+      return i;
+    }
+  }
+  return db.num_nodes == 0u ? no_node : db.num_nodes - 1u;
+}
+
+/*! \brief `db` with the cone costs of its cuts as `area_cost` and `depth_cost`; `cuts` holds the copied records.
+ *
+ * The level bounds of the nodes count LUT levels and stay valid, if loose:
+ * a cut spans at least one level of the input network.
+ */
+inline cut_database_view with_cone_costs( cut_database_view db, std::vector<cut_record>& cuts )
+{
+  cuts.assign( db.cuts, db.cuts + db.num_cuts );
+  for ( auto& cut : cuts )
+  {
+    cut.area_cost = cut.cone_area;
+    cut.depth_cost = cut.cone_depth;
+  }
+  db.cuts = cuts.data();
+  return db;
+}
+
+} // namespace detail
+
+/*! \brief Heuristic depth upper bound, as `_compute_depth_upper_bound`.
+ *
+ * Greedy minimum depth over the non-trivial cuts of each node, with slack,
+ * and never below the number of nodes. Nodes are stored in topological
+ * order, so one forward pass replaces the memoized recursion.
+ */
+inline uint32_t compute_depth_upper_bound( cut_database_view const& db )
+{
+  auto const pos = detail::node_positions( db );
+  std::vector<uint32_t> depth( db.num_nodes, 0u );
+  for ( auto i = 0u; i < db.num_nodes; ++i )
+  {
+    auto const& nd = db.nodes[i];
+    auto best = std::numeric_limits<uint32_t>::max();
+    for ( auto cut = db.cuts_begin( nd ); cut != db.cuts_end( nd ); ++cut )
+    {
+      if ( detail::is_self_cut( db, nd, *cut ) || ( cut->flags & cut_infeasible ) )
+      {
+        continue;
+      }
+      uint32_t leaf_depth = 0u;
+      for ( auto leaf = db.leaves_begin( *cut ); leaf != db.leaves_end( *cut ); ++leaf )
+      {
+        if ( pos[*leaf] != detail::no_node && pos[*leaf] < i )
+        {
+          leaf_depth = std::max( leaf_depth, depth[pos[*leaf]] );
+        }
+      }
+      best = std::min( best, leaf_depth + std::max( cut->depth_cost, 1u ) );
+    }
+    depth[i] = best == std::numeric_limits<uint32_t>::max() ? 0u : best;
+  }
+
+  uint32_t const num_nodes = std::max( db.num_nodes, 1u );
+  uint32_t base = 0u;
+  bool has_root = false;
+  auto add_root = [&]( uint32_t p ) {
+    has_root = true;
+    base = std::max( base, p == detail::no_node ? 0u : depth[p] );
+  };
+  for ( auto i = 0u; i < db.num_outputs; ++i )
+  {
+    add_root( pos[db.outputs[i]] );
+  }
+  if ( db.num_outputs == 0u && db.num_nodes > 0u )
+  {
+    add_root( detail::fallback_root( db ) );
+  }
+  if ( !has_root )
+  {
+    base = num_nodes;
+  }
+
+  // add slack so the "upper bound" is not accidentally too tight
+  auto const ub_with_slack = std::max( base + 10u, static_cast<uint32_t>( base * 1.5 ) );
+  // force UB to be at least the number of nodes to avoid infeasibility from an undershoot
+  return std::max( 1u, std::max( ub_with_slack, num_nodes ) );
+}
+
+/*! \brief The model of `build_model`: one literal per node and per non-trivial cut.
+ *
+ * The exporter's reduction is applied: infeasible cuts get no literal, and
+ * forced nodes and cuts share the constant true literal instead of a
+ * decision variable.
+ *
+ * With a `depth_bound`, one level variable per node and the global depth D
+ * are added, linked to the chosen cuts by big-M constraints.
+ */
+class cut_selection_model
+{
+public:
+  explicit cut_selection_model( cut_database_view const& db, std::optional<uint32_t> depth_bound = std::nullopt,
+                                std::optional<uint32_t> fix_depth = std::nullopt )
+      : _db( db ), _node_pos( detail::node_positions( db ) )
+  {
+    using operations_research::sat::LinearExpr;
+
+    _used.reserve( db.num_nodes );
+    for ( auto i = 0u; i < db.num_nodes; ++i )
+    {
+      _used.push_back( ( db.nodes[i].flags & node_forced ) ? _model.TrueVar() : _model.NewBoolVar() );
+    }
+
+    _node_cut_begin.reserve( db.num_nodes + 1u );
+    for ( auto i = 0u; i < db.num_nodes; ++i )
+    {
+      auto const& nd = db.nodes[i];
+      _node_cut_begin.push_back( static_cast<uint32_t>( _cut_vars.size() ) );
+      for ( auto c = nd.cut_begin; c < nd.cut_begin + nd.num_cuts; ++c )
+      {
+        if ( detail::is_self_cut( db, nd, db.cuts[c] ) || ( db.cuts[c].flags & cut_infeasible ) )
+        {
+          continue; // trivial and infeasible cuts do not implement the node
+        }
+        _cut_vars.push_back( ( db.cuts[c].flags & cut_forced ) ? _model.TrueVar() : _model.NewBoolVar() );
+        _cut_ids.push_back( c );
+      }
+    }
+    _node_cut_begin.push_back( static_cast<uint32_t>( _cut_vars.size() ) );
+
+    // (A) exactly 1 cut if node used, 0 otherwise
+    // (B) cut -> leaves used (for internal leaves)
+    std::vector<operations_research::sat::BoolVar> node_cuts;
+    for ( auto i = 0u; i < db.num_nodes; ++i )
+    {
+      node_cuts.assign( _cut_vars.begin() + _node_cut_begin[i], _cut_vars.begin() + _node_cut_begin[i + 1] );
+      if ( node_cuts.empty() )
+      {
+        _model.AddEquality( _used[i], 0 );
+        continue;
+      }
+      _model.AddEquality( LinearExpr::Sum( node_cuts ), _used[i] );
+
+      for ( auto v = _node_cut_begin[i]; v < _node_cut_begin[i + 1]; ++v )
+      {
+        auto const& cut = db.cuts[_cut_ids[v]];
+        for ( auto leaf = db.leaves_begin( cut ); leaf != db.leaves_end( cut ); ++leaf )
+        {
+          if ( _node_pos[*leaf] != detail::no_node )
+          {
+            _model.AddImplication( _cut_vars[v], _used[_node_pos[*leaf]] );
+          }
+        }
+      }
+    }
+
+    if ( depth_bound )
+    {
+      add_depth_constraints( *depth_bound, fix_depth );
+    }
+
+    // force outputs as roots, or the fallback root if there are none
+    for ( auto i = 0u; i < db.num_outputs; ++i )
+    {
+      if ( _node_pos[db.outputs[i]] != detail::no_node )
+      {
+        _model.AddEquality( _used[_node_pos[db.outputs[i]]], 1 );
+      }
+    }
+    if ( db.num_outputs == 0u && db.num_nodes > 0u )
+    {
+      _model.AddEquality( _used[detail::fallback_root( db )], 1 );
+    }
+  }
+
+  bool has_depth() const
+  {
+    return _depth.has_value();
+  }
+
+  /*! \brief The global depth D; only valid if `has_depth()`. */
+  operations_research::sat::IntVar depth_var() const
+  {
+    return *_depth;
+  }
+
+  /*! \brief Sets the objective.
+   *
+   * Accepts the CLI objectives plus the phase B tie-breakers
+   * `overall_tiebreak` and `depth_tiebreak_area`. Returns false for unknown
+   * modes and for `depth`/`overall` on a model without depth constraints.
+   */
+  bool apply_objective( std::string const& mode, objective_weights const& w )
+  {
+    using operations_research::sat::LinearExpr;
+
+    if ( is_depth_objective( mode ) && !_depth )
+    {
+      return false;
+    }
+    if ( mode == "depth" )
+    {
+      _model.Minimize( *_depth );
+      return true;
+    }
+
+    int64_t w_inv, w_area;
+    if ( mode == "og" || mode == "original" )
+    {
+      w_inv = w.lambda_inv;
+      w_area = w.lambda_area;
+    }
+    else if ( mode == "inv" )
+    {
+      w_inv = 1;
+      w_area = 0;
+    }
+    else if ( mode == "area" || mode == "depth_tiebreak_area" )
+    {
+      w_inv = 0;
+      w_area = 1;
+    }
+    else if ( mode == "overall" || mode == "overall_tiebreak" )
+    {
+      w_inv = w.gamma_inv;
+      w_area = w.beta_area;
+    }
+    else
+    {
+      return false;
+    }
+
+    std::vector<int64_t> coeffs( _cut_vars.size() );
+    for ( auto v = 0u; v < _cut_vars.size(); ++v )
+    {
+      auto const& cut = _db.cuts[_cut_ids[v]];
+      coeffs[v] = w_inv * cut.inv_cost + w_area * cut.area_cost;
+    }
+    auto objective = LinearExpr::WeightedSum( _cut_vars, coeffs );
+    if ( mode == "overall" )
+    {
+      objective += LinearExpr::Term( *_depth, w.alpha_depth );
+    }
+    _model.Minimize( objective );
+    return true;
+  }
+
+  /*! \brief Hints the cover `chosen_cut` (per node index), with the levels and depth it implies in a depth model.
+   *
+   * Forced literals are constants and get no hint. The hint need not be
+   * feasible; CP-SAT repairs it or ignores it. Nodes marked `open_hint` get
+   * no hint, and neither do the levels once any node is open.
+   */
+  void add_hint( std::vector<uint32_t> const& chosen_cut )
+  {
+    auto chosen_of = [&]( uint32_t i ) {
+      auto const idx = _db.nodes[i].index;
+      return idx < chosen_cut.size() ? chosen_cut[idx] : no_chosen_cut;
+    };
+    std::vector<int64_t> level( _db.num_nodes, 0 );
+    int64_t depth = 0;
+    bool partial = false;
+    for ( auto i = 0u; i < _db.num_nodes; ++i )
+    {
+      auto const& nd = _db.nodes[i];
+      auto const chosen = chosen_of( i );
+      if ( chosen == open_hint )
+      {
+        partial = true;
+        continue;
+      }
+      if ( !( nd.flags & node_forced ) )
+      {
+        _model.AddHint( _used[i], chosen != no_chosen_cut );
+      }
+      for ( auto v = _node_cut_begin[i]; v < _node_cut_begin[i + 1]; ++v )
+      {
+        auto const& cut = _db.cuts[_cut_ids[v]];
+        bool const taken = chosen == _cut_ids[v] - nd.cut_begin;
+        if ( !( cut.flags & cut_forced ) )
+        {
+          _model.AddHint( _cut_vars[v], taken );
+        }
+        if ( !taken )
+        {
+          continue;
+        }
+        for ( auto leaf = _db.leaves_begin( cut ); leaf != _db.leaves_end( cut ); ++leaf )
+        {
+          if ( _node_pos[*leaf] != detail::no_node )
+          {
+            level[i] = std::max( level[i], level[_node_pos[*leaf]] );
+          }
+        }
+        level[i] += std::max( cut.depth_cost, 1u );
+        depth = std::max( depth, level[i] );
+      }
+    }
+    if ( !_depth || partial )
+    {
+      return;
+    }
+    for ( auto i = 0u; i < _db.num_nodes; ++i )
+    {
+      _model.AddHint( _levels[i], level[i] );
+    }
+    _model.AddHint( *_depth, depth );
+  }
+
+  /*! \brief Fixes the cuts of the cover `chosen_cut` (per node index): a covered node that is used takes its chosen cut.
+   *
+   * Whether the node is used is left to the output and leaf constraints, so
+   * a cover node the changed logic no longer reaches can be dropped. Other
+   * nodes stay free; infeasible chosen cuts have no variable and are skipped.
+   */
+  void fix_cover( std::vector<uint32_t> const& chosen_cut )
+  {
+    for ( auto i = 0u; i < _db.num_nodes; ++i )
+    {
+      auto const& nd = _db.nodes[i];
+      auto const chosen = nd.index < chosen_cut.size() ? chosen_cut[nd.index] : no_chosen_cut;
+      if ( chosen == no_chosen_cut || chosen == open_hint )
+      {
+        continue;
+      }
+      for ( auto v = _node_cut_begin[i]; v < _node_cut_begin[i + 1]; ++v )
+      {
+        if ( _cut_ids[v] - nd.cut_begin == chosen )
+        {
+          _model.AddImplication( _used[i], _cut_vars[v] );
+        }
+      }
+    }
+  }
+
+  operations_research::sat::CpSolverResponse solve( phase_params const& ps ) const
+  {
+    operations_research::sat::SatParameters params;
+    params.set_random_seed( ps.seed );
+    params.set_num_search_workers( ps.num_workers );
+    params.set_max_time_in_seconds( ps.time_limit );
+    params.set_log_search_progress( false );
+    if ( ps.absolute_gap > 0.0 )
+    {
+      params.set_absolute_gap_limit( ps.absolute_gap );
+    }
+    if ( ps.relative_gap > 0.0 )
+    {
+      params.set_relative_gap_limit( ps.relative_gap );
+    }
+    if ( ps.stop_after_first )
+    {
+      params.set_stop_after_first_solution( true );
+    }
+    return operations_research::sat::SolveWithParameters( _model.Build(), params );
+  }
+
+  /*! \brief Chosen cut per node index (position among the node's cuts in the database). */
+  std::vector<uint32_t> chosen_cuts( operations_research::sat::CpSolverResponse const& response ) const
+  {
+    std::vector<uint32_t> chosen( _db.num_names, no_chosen_cut );
+    for ( auto i = 0u; i < _db.num_nodes; ++i )
+    {
+      if ( !operations_research::sat::SolutionBooleanValue( response, _used[i] ) )
+      {
+        continue;
+      }
+      for ( auto v = _node_cut_begin[i]; v < _node_cut_begin[i + 1]; ++v )
+      {
+        if ( operations_research::sat::SolutionBooleanValue( response, _cut_vars[v] ) )
+        {
+          chosen[_db.nodes[i].index] = _cut_ids[v] - _db.nodes[i].cut_begin;
+          break;
+        }
+      }
+    }
+    return chosen;
+  }
+
+private:
+  void add_depth_constraints( uint32_t depth_bound, std::optional<uint32_t> fix_depth )
+  {
+    using operations_research::Domain;
+    using operations_research::sat::LinearExpr;
+
+    // per-node level bounds of the cut file: a used node lies in [min_level, B - height]
+    int64_t const big_m = std::max( 1u, depth_bound );
+    int64_t const bound = fix_depth ? std::min<int64_t>( big_m, *fix_depth ) : big_m;
+    std::vector<int64_t> max_level( _db.num_nodes, 0 );
+    _levels.reserve( _db.num_nodes );
+    for ( auto i = 0u; i < _db.num_nodes; ++i )
+    {
+      auto const& nd = _db.nodes[i];
+      int64_t min_level = std::max( nd.min_level, 1u );
+      max_level[i] = nd.height == no_level ? -1 : bound - static_cast<int64_t>( nd.height );
+      if ( max_level[i] < min_level )
+      {
+        min_level = max_level[i] = 0;
+        _model.AddEquality( _used[i], 0 ); // no output can use the node within the bound
+      }
+      _levels.push_back( _model.NewIntVar( Domain( 0, max_level[i] ) ) );
+
+      // link levels to usage to avoid floating levels
+      _model.AddLessOrEqual( _levels[i], LinearExpr::Term( _used[i], max_level[i] ) );
+      _model.AddGreaterOrEqual( _levels[i], LinearExpr::Term( _used[i], min_level ) );
+    }
+    _depth = _model.NewIntVar( Domain( 0, big_m ) );
+
+    for ( auto i = 0u; i < _db.num_nodes; ++i )
+    {
+      for ( auto v = _node_cut_begin[i]; v < _node_cut_begin[i + 1]; ++v )
+      {
+        auto const& cut = _db.cuts[_cut_ids[v]];
+        int64_t const step = std::max( cut.depth_cost, 1u );
+        for ( auto leaf = _db.leaves_begin( cut ); leaf != _db.leaves_end( cut ); ++leaf )
+        {
+          if ( _node_pos[*leaf] == detail::no_node )
+          {
+            continue; // PIs are at level 0
+          }
+          // L_node >= L_leaf + step - M * (1 - cut), M = max L_leaf + step
+          int64_t const m = max_level[_node_pos[*leaf]] + step;
+          _model.AddGreaterOrEqual( LinearExpr( _levels[i] ) - _levels[_node_pos[*leaf]] - LinearExpr::Term( _cut_vars[v], m ),
+                                    step - m );
+        }
+      }
+      _model.AddGreaterOrEqual( *_depth, _levels[i] );
+    }
+
+    if ( fix_depth )
+    {
+      _model.AddEquality( *_depth, static_cast<int64_t>( *fix_depth ) );
+    }
+  }
+
+private:
+  cut_database_view const& _db;
+  operations_research::sat::CpModelBuilder _model;
+  std::vector<uint32_t> _node_pos;
+  std::vector<operations_research::sat::BoolVar> _used;
+  std::vector<operations_research::sat::BoolVar> _cut_vars;
+  std::vector<uint32_t> _cut_ids;
+  std::vector<uint32_t> _node_cut_begin;
+  std::vector<operations_research::sat::IntVar> _levels;
+  std::optional<operations_research::sat::IntVar> _depth;
+};
+
+/*! \brief Solves cut selection like `solve_circuit`.
+ *
+ * `og`, `inv` and `area` are solved once. `depth` and `overall` run phase A
+ * (minimize D) and then phase B (D fixed, minimize area resp. the weighted
+ * area/inverter cost), keeping the phase A solution if phase B fails. With
+ * `fix_depth`, phase A is skipped and D is fixed to the given value.
+ */
+inline solve_result solve_cut_selection( cut_database_view const& db, solve_params const& ps )
+{
+  using namespace operations_research::sat;
+
+  auto is_feasible = []( CpSolverResponse const& response ) {
+    return response.status() == CpSolverStatus::OPTIMAL || response.status() == CpSolverStatus::FEASIBLE;
+  };
+
+  solve_result res;
+  if ( !is_known_objective( ps.objective ) )
+  {
+    res.status = "MODEL_INVALID";
+    return res;
+  }
+
+  if ( ps.cone_costs )
+  {
+    std::vector<cut_record> cuts;
+    auto cone_ps = ps;
+    cone_ps.cone_costs = false;
+    return solve_cut_selection( detail::with_cone_costs( db, cuts ), cone_ps );
+  }
+
+  if ( !is_depth_objective( ps.objective ) && !ps.fix_depth )
+  {
+    cut_selection_model model( db );
+    model.apply_objective( ps.objective, ps.weights );
+    if ( !ps.hint.empty() )
+    {
+      model.add_hint( ps.hint );
+      if ( ps.fix_hint )
+      {
+        model.fix_cover( ps.hint );
+      }
+    }
+    auto const response = model.solve( ps.single );
+    res.status = CpSolverStatus_Name( response.status() );
+    res.feasible = is_feasible( response );
+    if ( res.feasible )
+    {
+      res.objective_value = response.objective_value();
+      res.chosen_cut = model.chosen_cuts( response );
+    }
+    return res;
+  }
+
+  auto const depth_bound = std::max( compute_depth_upper_bound( db ), std::max( db.num_nodes, 1u ) );
+  if ( ps.verbose )
+  {
+    std::cout << "Using depth upper bound UB = " << depth_bound << "\n";
+  }
+  std::string const tie_mode = ps.objective == "depth" ? "depth_tiebreak_area" : "overall_tiebreak";
+
+  std::optional<uint32_t> fixed_depth = ps.fix_depth;
+  if ( !fixed_depth )
+  {
+    // Phase A: depth-only minimize D with relaxed gap and short cap
+    cut_selection_model phase_a( db, depth_bound );
+    phase_a.apply_objective( "depth", ps.weights );
+    if ( !ps.hint.empty() )
+    {
+      phase_a.add_hint( ps.hint );
+      if ( ps.fix_hint )
+      {
+        phase_a.fix_cover( ps.hint );
+      }
+    }
+    auto const response = phase_a.solve( ps.phase_a );
+    res.status = CpSolverStatus_Name( response.status() );
+    if ( ps.verbose )
+    {
+      std::cout << "Phase A status: " << res.status << "\n";
+    }
+    if ( !is_feasible( response ) )
+    {
+      return res;
+    }
+    res.feasible = true;
+    res.depth = SolutionIntegerValue( response, phase_a.depth_var() );
+    res.objective_value = static_cast<double>( *res.depth );
+    res.chosen_cut = phase_a.chosen_cuts( response );
+    fixed_depth = static_cast<uint32_t>( *res.depth );
+    if ( ps.verbose )
+    {
+      std::cout << "Phase A best depth D = " << *res.depth << "\n";
+    }
+  }
+
+  // Phase B: fix depth and minimize tie-breaker (or the requested area/inv objective)
+  cut_selection_model phase_b( db, depth_bound, fixed_depth );
+  phase_b.apply_objective( is_depth_objective( ps.objective ) ? tie_mode : ps.objective, ps.weights );
+  if ( res.feasible )
+  {
+    phase_b.add_hint( res.chosen_cut );
+  }
+  else if ( !ps.hint.empty() )
+  {
+    phase_b.add_hint( ps.hint );
+  }
+  if ( ps.fix_hint && !ps.hint.empty() )
+  {
+    phase_b.fix_cover( ps.hint );
+  }
+  auto const response = phase_b.solve( ps.phase_b );
+  auto const status_b = CpSolverStatus_Name( response.status() );
+  if ( ps.verbose )
+  {
+    std::cout << "Phase B status: " << status_b << "\n";
+  }
+  if ( !is_feasible( response ) )
+  {
+    if ( !res.feasible )
+    {
+      res.status = status_b;
+    }
+    else if ( ps.verbose )
+    {
+      std::cout << "No feasible solution in Phase B; returning Phase A solution.\n";
+    }
+    return res;
+  }
+
+  res.status = status_b;
+  res.feasible = true;
+  res.depth = SolutionIntegerValue( response, phase_b.depth_var() );
+  res.tie_objective = response.objective_value();
+  res.objective_value = is_depth_objective( ps.objective ) ? static_cast<double>( *res.depth ) : response.objective_value();
+  res.chosen_cut = phase_b.chosen_cuts( response );
+  return res;
+}
+
+} // namespace cpsat
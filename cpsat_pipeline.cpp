@@ -0,0 +1,323 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <mockturtle/algorithms/cut_enumeration.hpp>
+#include <mockturtle/io/write_blif.hpp>
+#include <mockturtle/networks/klut.hpp>
+#include <mockturtle/views/names_view.hpp>
+
+#include "blif_loader.hpp"
+#include "cpsat_model.hpp"
+#include "cut_cover.hpp"
+#include "cut_database.hpp"
+#include "cut_database_json.hpp"
+#include "cut_eco.hpp"
+#include "cut_export.hpp"
+#include "cut_rebuild.hpp"
+#include "parallel_cut_enumeration.hpp"
+
+/* In-process BLIF -> cut enumeration -> CP-SAT -> rebuild.
+ *
+ * Each BLIF is parsed once; the network, the cut database and the solution
+ * stay in memory between the stages, so a directory sweep pays neither
+ * process startup nor a cut file round trip per design.
+ */
+namespace
+{
+
+struct pipeline_params
+{
+  uint32_t cut_size{ 4 };
+  int threads{ -1 }; /* -1: sequential mockturtle enumeration */
+  std::string cuts_format; /* empty: do not write the cut file */
+  uint32_t cut_limit{ cpsat::default_cut_limit };
+  cpsat::cut_priority priority{ cpsat::cut_priority::none };
+  cpsat::cut_pruning_params pruning;
+  cpsat::solve_params solve;
+  std::optional<cpsat::cover_objective> hint_cover; /* unset: CP-SAT starts without a hint */
+  cpsat::rebuild_params rebuild;
+};
+
+double seconds_since( std::chrono::steady_clock::time_point start )
+{
+  return std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+}
+
+bool run_design( std::filesystem::path const& blif_file, std::filesystem::path const& out_dir, pipeline_params const& ps )
+{
+  using namespace mockturtle;
+
+  auto const stem = blif_file.stem().string();
+  auto const t_start = std::chrono::steady_clock::now();
+
+  klut_network klut;
+  names_view<klut_network> ntk{ klut };
+  if ( !cpsat::read_blif_file( blif_file.string(), ntk, ps.threads < 0 ? 0u : static_cast<uint32_t>( ps.threads ) ) )
+  {
+    return false;
+  }
+  auto const t_read = seconds_since( t_start );
+
+  auto t_stage = std::chrono::steady_clock::now();
+  cut_enumeration_params cps;
+  cps.cut_size = ps.cut_size;
+  cps.cut_limit = cpsat::enumeration_cut_limit( ps.cut_limit, ps.priority );
+  auto pruning = ps.pruning;
+  cpsat::apply_cut_priority( pruning, ps.cut_limit, ps.priority );
+  std::optional<network_cuts<names_view<klut_network>, true>> cut_res;
+  std::optional<cpsat::parallel_network_cuts<names_view<klut_network>>> parallel_res;
+  if ( ps.threads < 0 )
+  {
+    cut_res.emplace( cut_enumeration<names_view<klut_network>, true>( ntk, cps ) );
+  }
+  else
+  {
+    cpsat::parallel_cut_params pps;
+    pps.cut_size = cps.cut_size;
+    pps.cut_limit = cps.cut_limit;
+    pps.num_threads = static_cast<uint32_t>( ps.threads );
+    parallel_res.emplace( ntk, pps );
+  }
+  cpsat::cut_exporter<names_view<klut_network>> exporter( ntk );
+  auto export_cuts = [&]( auto& sink ) {
+    if ( parallel_res )
+      parallel_res->export_nodes( sink );
+    else
+      exporter.export_nodes( *cut_res, sink );
+  };
+  auto export_nodes = [&]( auto& sink ) {
+    if ( !pruning.enabled() )
+    {
+      export_cuts( sink );
+      return;
+    }
+    cpsat::pruning_cut_sink<std::decay_t<decltype( sink )>> pruned( sink, pruning );
+    export_cuts( pruned );
+  };
+  auto const reachable = exporter.reachable_nodes();
+  auto export_reduced = [&]( auto& sink ) {
+    cpsat::reducing_cut_sink<std::decay_t<decltype( sink )>> reduced( sink, reachable, exporter.outputs() );
+    export_nodes( reduced );
+    return reduced.finish();
+  };
+  auto cut_db = exporter.empty_database( cps.cut_size, ps.cut_limit, ps.priority, pruning.top_n,
+                                         cpsat::enumeration_of( parallel_res.has_value(), pruning ) );
+  if ( !cut_db.mark_reduction( export_reduced( cut_db ) ) )
+  {
+    std::cerr << "[" << stem << "] Error: the model reduction names a node or cut that was not exported\n";
+    return false;
+  }
+  auto const db = cut_db.view();
+  auto const t_enum = seconds_since( t_stage );
+
+  // written cut files carry signatures, so they can serve as `cut_enumeration --eco-base`
+  if ( !ps.cuts_format.empty() )
+  {
+    cut_db.set_signatures( cpsat::structural_signatures( ntk, exporter.node_names() ) );
+    bool const binary = ps.cuts_format == "binary";
+    auto const cuts_file = ( out_dir / ( stem + ( binary ? "_cuts.cdb" : "_cuts.json" ) ) ).string();
+    if ( !( binary ? cpsat::write_cut_database( cut_db, cuts_file ) : cpsat::write_cut_database_json( cut_db, cuts_file ) ) )
+    {
+      std::cerr << "[" << stem << "] Error writing cuts '" << cuts_file << "'\n";
+      return false;
+    }
+  }
+
+  t_stage = std::chrono::steady_clock::now();
+  auto solve_ps = ps.solve;
+  if ( ps.hint_cover )
+  {
+    solve_ps.hint = cpsat::greedy_cover( db, *ps.hint_cover ).chosen_cut;
+  }
+  auto const result = cpsat::solve_cut_selection( db, solve_ps );
+  auto const t_solve = seconds_since( t_stage );
+  std::cout << "[" << stem << "] CP-SAT status: " << result.status;
+  if ( result.feasible )
+  {
+    std::cout << " objective (" << ps.solve.objective << ") = " << result.objective_value;
+    if ( result.depth )
+    {
+      std::cout << " D = " << *result.depth;
+    }
+  }
+  std::cout << "\n";
+  if ( !result.feasible )
+  {
+    return false;
+  }
+
+  t_stage = std::chrono::steady_clock::now();
+  auto const chosen_file = ( out_dir / ( stem + "_chosen_cuts.json" ) ).string();
+  {
+    std::ofstream os( chosen_file );
+    cpsat::write_chosen_cuts_json( os, db, result.chosen_cut, cpsat::no_chosen_cut );
+    if ( !os.flush() )
+    {
+      std::cerr << "[" << stem << "] Error writing chosen cuts '" << chosen_file << "'\n";
+      return false;
+    }
+  }
+  cpsat::rebuild_stats st;
+  auto const new_ntk = cpsat::rebuild_network( ntk, db, result.chosen_cut, st, ps.rebuild );
+  auto const rebuilt_file = ( out_dir / ( stem + "_rebuilt.blif" ) ).string();
+  {
+    std::ofstream os( rebuilt_file );
+    write_blif( new_ntk, os );
+    if ( !os.flush() )
+    {
+      std::cerr << "[" << stem << "] Error writing rebuilt BLIF '" << rebuilt_file << "'\n";
+      return false;
+    }
+  }
+  auto const t_rebuild = seconds_since( t_stage );
+
+  std::cout << "[" << stem << "] nodes " << ntk.size() << " -> " << new_ntk.size()
+            << ", cuts " << db.num_cuts << ", selected " << st.selected_nodes;
+  if ( ps.rebuild.strash )
+  {
+    std::cout << ", strashed " << st.strashed_nodes;
+  }
+  std::cout << "\n";
+  std::cout << "[" << stem << "] read " << t_read << "s, enumerate " << t_enum << "s, solve "
+            << t_solve << "s, rebuild " << t_rebuild << "s, total " << seconds_since( t_start ) << "s\n";
+  return true;
+}
+
+} // namespace
+
+int main( int argc, char** argv )
+{
+  std::vector<std::string> positional;
+  pipeline_params ps;
+  bool known_priority = true;
+  bool known_cover = true;
+  for ( int i = 1; i < argc; ++i )
+  {
+    std::string const arg = argv[i];
+    if ( arg == "--objective" && i + 1 < argc )
+    {
+      ps.solve.objective = argv[++i];
+    }
+    else if ( arg == "--fix-depth" && i + 1 < argc )
+    {
+      ps.solve.fix_depth = static_cast<uint32_t>( std::atoi( argv[++i] ) );
+    }
+    else if ( arg == "--cone-costs" )
+    {
+      ps.solve.cone_costs = true;
+    }
+    else if ( arg == "--time-limit" && i + 1 < argc )
+    {
+      ps.solve.single.time_limit = std::atof( argv[++i] );
+    }
+    else if ( arg == "--num-workers" && i + 1 < argc )
+    {
+      ps.solve.single.num_workers = std::atoi( argv[++i] );
+    }
+    else if ( arg == "--threads" && i + 1 < argc )
+    {
+      ps.threads = std::max( 0, std::atoi( argv[++i] ) );
+    }
+    else if ( arg == "--write-cuts" && i + 1 < argc )
+    {
+      ps.cuts_format = argv[++i];
+    }
+    else if ( arg == "--cut-limit" && i + 1 < argc )
+    {
+      ps.cut_limit = static_cast<uint32_t>( std::max( 2, std::atoi( argv[++i] ) ) );
+    }
+    else if ( arg == "--cut-priority" && i + 1 < argc )
+    {
+      known_priority = cpsat::parse_cut_priority( argv[++i], ps.priority );
+    }
+    else if ( arg == "--hint-cover" && i + 1 < argc )
+    {
+      cpsat::cover_objective objective;
+      known_cover = cpsat::parse_cover_objective( argv[++i], objective );
+      ps.hint_cover = objective;
+    }
+    else if ( arg == "--strash" )
+    {
+      ps.rebuild.strash = true;
+    }
+    else if ( arg == "--prune-dominated" )
+    {
+      ps.pruning.prune_dominated = true;
+    }
+    else if ( arg == "--top-n" && i + 1 < argc )
+    {
+      ps.pruning.top_n = static_cast<uint32_t>( std::max( 0, std::atoi( argv[++i] ) ) );
+    }
+    else if ( arg == "--top-n-objective" && i + 1 < argc )
+    {
+      ps.pruning.top_n_objective = argv[++i];
+    }
+    else
+    {
+      positional.push_back( arg );
+    }
+  }
+
+  bool const known_objective = cpsat::is_known_objective( ps.solve.objective );
+  bool const known_format = ps.cuts_format.empty() || ps.cuts_format == "json" || ps.cuts_format == "binary";
+  bool const known_pruning = cpsat::is_known_pruning_objective( ps.pruning.top_n_objective );
+  if ( positional.size() < 2 || !known_objective || !known_format || !known_priority || !known_pruning || !known_cover )
+  {
+    std::cerr << "Usage: cpsat_pipeline <input.blif|blif_dir> <output_dir> [K]\n"
+                 "                      [--objective og|inv|area|depth|overall] [--fix-depth D]\n"
+                 "                      [--time-limit S] [--num-workers N] [--write-cuts json|binary]\n"
+                 "                      [--threads N] [--cut-limit C] [--cut-priority none|area|inv|depth]\n"
+                 "                      [--prune-dominated] [--strash]\n"
+                 "                      [--top-n N] [--top-n-objective inv|area|depth|overall]\n"
+                 "                      [--hint-cover area|depth] [--cone-costs]\n"
+                 "Area counts cut leaves and D (--fix-depth) LUT levels; with --cone-costs they count the\n"
+                 "input-network nodes covered by a cut and the input-network levels.\n";
+    return 1;
+  }
+  if ( positional.size() >= 3 )
+  {
+    auto const K = std::atoi( positional[2].c_str() );
+    ps.cut_size = K > 0 ? K : 4;
+  }
+
+  std::filesystem::path const input = positional[0];
+  std::filesystem::path const out_dir = positional[1];
+  std::filesystem::create_directories( out_dir );
+
+  std::vector<std::filesystem::path> blif_files;
+  if ( std::filesystem::is_directory( input ) )
+  {
+    for ( auto const& entry : std::filesystem::directory_iterator( input ) )
+    {
+      if ( entry.is_regular_file() && entry.path().extension() == ".blif" )
+      {
+        blif_files.push_back( entry.path() );
+      }
+    }
+    std::sort( blif_files.begin(), blif_files.end() );
+    std::cerr << "[info] Found " << blif_files.size() << " BLIF files in " << input.string() << "\n";
+  }
+  else
+  {
+    blif_files.push_back( input );
+  }
+
+  uint32_t failures = 0u;
+  for ( auto const& blif_file : blif_files )
+  {
+    if ( !run_design( blif_file, out_dir, ps ) )
+    {
+      std::cerr << "[warn] pipeline failed for " << blif_file.string() << "\n";
+      ++failures;
+    }
+  }
+  return failures == 0u ? 0 : 2;
+}
@@ -0,0 +1,149 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include <nlohmann/json.hpp>
+
+#include "cpsat_model.hpp"
+#include "cut_database.hpp"
+#include "cut_database_json.hpp"
+
+/* Native replacement for `main_cpsat.py --cuts ... --out ...`: builds the
+ * CP-SAT model straight from the cut file and writes the same chosen cuts
+ * JSON, with the solver status added for the flow driver.
+ */
+int main( int argc, char** argv )
+{
+  std::string cuts_path;
+  std::string out_path;
+  std::string hint_path; /* empty: no warm start */
+  cpsat::solve_params ps;
+  ps.verbose = true;
+
+  bool valid = true;
+  for ( int i = 1; i < argc; ++i )
+  {
+    std::string const arg = argv[i];
+    if ( arg == "--cuts" && i + 1 < argc )
+    {
+      cuts_path = argv[++i];
+    }
+    else if ( arg == "--out" && i + 1 < argc )
+    {
+      out_path = argv[++i];
+    }
+    else if ( arg == "--objective" && i + 1 < argc )
+    {
+      ps.objective = argv[++i];
+    }
+    else if ( arg == "--fix-depth" && i + 1 < argc )
+    {
+      ps.fix_depth = static_cast<uint32_t>( std::atoi( argv[++i] ) );
+    }
+    else if ( arg == "--cone-costs" )
+    {
+      ps.cone_costs = true;
+    }
+    else if ( arg == "--hint" && i + 1 < argc )
+    {
+      hint_path = argv[++i];
+    }
+    else if ( arg == "--fix-hint" )
+    {
+      ps.fix_hint = true;
+    }
+    else if ( arg == "--num-workers" && i + 1 < argc )
+    {
+      /* one core budget for all phases, e.g. the solve stage share of run_full_flow's scheduler */
+      auto const workers = std::max( std::atoi( argv[++i] ), 1 );
+      ps.single.num_workers = workers;
+      ps.phase_a.num_workers = workers;
+      ps.phase_b.num_workers = workers;
+    }
+    else
+    {
+      valid = false;
+    }
+  }
+
+  if ( !valid || cuts_path.empty() || out_path.empty() || !cpsat::is_known_objective( ps.objective ) || ( ps.fix_hint && hint_path.empty() ) )
+  {
+    std::cerr << "Usage: cpsat_solve --cuts <cuts.json|cuts.cdb> --out <chosen_cuts.json>\n"
+                 "                   [--objective og|inv|area|depth|overall] [--fix-depth D]\n"
+                 "                   [--cone-costs] [--num-workers N] [--hint hint.json [--fix-hint]]\n"
+                 "Area counts cut leaves and D (--fix-depth) LUT levels; with --cone-costs they count the\n"
+                 "input-network nodes covered by a cut and the input-network levels.\n";
+    return 1;
+  }
+
+  auto const t_start = std::chrono::steady_clock::now();
+  cpsat::loaded_cut_database cut_file;
+  {
+    std::string error;
+    if ( !cut_file.load( cuts_path, error ) )
+    {
+      std::cerr << "Invalid cut file '" << cuts_path << "': " << error << "\n";
+      return 2;
+    }
+  }
+  auto const& db = cut_file.view();
+  auto const t_load = std::chrono::duration<double>( std::chrono::steady_clock::now() - t_start ).count();
+  std::cout << "Loaded " << db.num_nodes << " nodes, " << db.num_cuts << " cuts in " << t_load << "s\n";
+
+  if ( !hint_path.empty() )
+  {
+    ps.hint.assign( db.num_names, cpsat::no_chosen_cut );
+    std::vector<uint32_t> open_nodes;
+    if ( !cpsat::read_chosen_cuts_json( hint_path, db, ps.hint, &open_nodes ) )
+    {
+      return 2;
+    }
+    for ( auto idx : open_nodes )
+    {
+      if ( idx < ps.hint.size() )
+      {
+        ps.hint[idx] = cpsat::open_hint;
+      }
+    }
+  }
+
+  auto const result = cpsat::solve_cut_selection( db, ps );
+  std::cout << "Status: " << result.status << "\n";
+  if ( !result.feasible )
+  {
+    std::cout << "No feasible solution.\n";
+    return 3;
+  }
+  std::cout << "Objective value (" << ps.objective << ") = " << result.objective_value << "\n";
+  if ( result.depth )
+  {
+    std::cout << "Global depth D = " << *result.depth << "\n";
+  }
+  if ( result.tie_objective )
+  {
+    std::cout << "Phase B tie-break objective = " << *result.tie_objective << "\n";
+  }
+
+  nlohmann::json extra;
+  extra["status"] = result.status;
+  extra["objective_value"] = result.objective_value;
+  if ( result.depth )
+  {
+    extra["depth"] = *result.depth;
+  }
+  {
+    std::ofstream os( out_path );
+    if ( !os )
+    {
+      std::cerr << "Cannot write '" << out_path << "'\n";
+      return 2;
+    }
+    cpsat::write_chosen_cuts_json( os, db, result.chosen_cut, cpsat::no_chosen_cut, extra );
+  }
+  std::cout << "Written chosen cuts to " << out_path << "\n";
+  return 0;
+}
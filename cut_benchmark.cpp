@@ -0,0 +1,469 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include <lorina/aiger.hpp>
+#include <mockturtle/algorithms/cut_enumeration.hpp>
+#include <mockturtle/io/aiger_reader.hpp>
+#include <mockturtle/io/write_blif.hpp>
+#include <mockturtle/networks/aig.hpp>
+#include <mockturtle/networks/klut.hpp>
+#include <mockturtle/views/names_view.hpp>
+
+#include "blif_loader.hpp"
+#include "cut_cover.hpp"
+#include "cut_database.hpp"
+#include "cut_database_json.hpp"
+#include "cut_export.hpp"
+#include "cut_rebuild.hpp"
+#include "parallel_cut_enumeration.hpp"
+#include "tool_stats.hpp"
+
+/* Performance benchmark of the C++ cut pipeline.
+ *
+ * Every design is run through the stages of cut_enumeration and
+ * rebuild_from_cpsat -- BLIF read, cut enumeration, costing and export into a
+ * cut database, cut file write, rebuild -- for each (K, cut limit) pair of
+ * the grid, `repeat` times. AIGER inputs (e.g. the DAC'19 `benchmarks/` set)
+ * are converted to BLIF once, so the BLIF loader is measured as in the flow.
+ * The rebuild uses a greedy area-flow cover instead of a CP-SAT solution,
+ * keeping the solver out of the measurement.
+ *
+ * Times are medians over the repetitions; `--baseline` compares the cut
+ * throughput with an earlier CSV and fails on a regression.
+ */
+namespace
+{
+
+struct benchmark_params
+{
+  std::vector<uint32_t> cut_sizes{ 4u, 6u };
+  std::vector<uint32_t> cut_limits{ 8u, 32u };
+  uint32_t repeat{ 3u };
+  int threads{ -1 }; /* -1: sequential mockturtle enumeration */
+  std::string format{ "json" };
+  std::filesystem::path work_dir{ std::filesystem::temp_directory_path() / "cut_benchmark" };
+};
+
+struct benchmark_result
+{
+  std::string design;
+  uint32_t cut_size;
+  uint32_t cut_limit;
+  uint32_t network_nodes{ 0u };
+  uint32_t cut_nodes{ 0u };
+  uint32_t cuts{ 0u };
+  uint64_t tt_words{ 0u };
+  uint64_t db_bytes{ 0u };
+  uint64_t file_bytes{ 0u };
+  uint32_t rebuilt_nodes{ 0u };
+  double read_s{ 0.0 };
+  double enumerate_s{ 0.0 };
+  double export_s{ 0.0 };
+  double write_s{ 0.0 };
+  double rebuild_s{ 0.0 };
+  double total_s{ 0.0 };
+  uint64_t peak_rss_bytes{ 0u };
+
+  double cuts_per_s() const { return cuts / std::max( enumerate_s + export_s, 1e-9 ); }
+  double nodes_per_s() const { return network_nodes / std::max( total_s, 1e-9 ); }
+};
+
+double seconds_since( std::chrono::steady_clock::time_point start )
+{
+  return std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+}
+
+double median( std::vector<double> values )
+{
+  if ( values.empty() )
+  {
+    return 0.0;
+  }
+  std::sort( values.begin(), values.end() );
+  auto const mid = values.size() / 2u;
+  return values.size() % 2u ? values[mid] : 0.5 * ( values[mid - 1u] + values[mid] );
+}
+
+bool parse_list( std::string const& text, std::vector<uint32_t>& values )
+{
+  values.clear();
+  std::istringstream is( text );
+  std::string item;
+  while ( std::getline( is, item, ',' ) )
+  {
+    auto const v = std::atoi( item.c_str() );
+    if ( v <= 0 )
+    {
+      return false;
+    }
+    values.push_back( static_cast<uint32_t>( v ) );
+  }
+  return !values.empty();
+}
+
+/*! \brief BLIF of `input`: the file itself, or an AIGER file converted into `work_dir` (reused while newer than the AIG). */
+std::optional<std::filesystem::path> benchmark_blif( std::filesystem::path const& input, std::filesystem::path const& work_dir )
+{
+  if ( input.extension() != ".aig" && input.extension() != ".aag" )
+  {
+    return input;
+  }
+
+  auto const blif = work_dir / ( input.stem().string() + ".blif" );
+  std::error_code ec;
+  if ( std::filesystem::exists( blif, ec ) &&
+       std::filesystem::last_write_time( blif, ec ) >= std::filesystem::last_write_time( input, ec ) )
+  {
+    return blif;
+  }
+
+  mockturtle::aig_network aig;
+  auto const rc = input.extension() == ".aag"
+                      ? lorina::read_ascii_aiger( input.string(), mockturtle::aiger_reader( aig ) )
+                      : lorina::read_aiger( input.string(), mockturtle::aiger_reader( aig ) );
+  if ( rc != lorina::return_code::success )
+  {
+    std::cerr << "Error reading AIGER '" << input.string() << "'\n";
+    return std::nullopt;
+  }
+  mockturtle::write_blif( aig, blif.string() );
+  return blif;
+}
+
+uint64_t database_bytes( cpsat::cut_database const& db )
+{
+  return db.name_offsets.size() * sizeof( uint32_t ) + db.name_chars.size() +
+         db.nodes.size() * sizeof( cpsat::node_record ) + db.cuts.size() * sizeof( cpsat::cut_record ) +
+         ( db.leaves.size() + db.inputs.size() + db.outputs.size() ) * sizeof( uint32_t ) +
+         db.tt_words.size() * sizeof( uint64_t );
+}
+
+bool run_benchmark( std::filesystem::path const& blif_file, std::string const& design, uint32_t K, uint32_t C,
+                    benchmark_params const& ps, benchmark_result& res )
+{
+  using namespace mockturtle;
+
+  res.design = design;
+  res.cut_size = K;
+  res.cut_limit = C;
+  auto const cut_file = ps.work_dir / ( design + "_K" + std::to_string( K ) + "_C" + std::to_string( C ) +
+                                        ( ps.format == "binary" ? ".cdb" : ".json" ) );
+
+  std::vector<double> read_s, enumerate_s, export_s, write_s, rebuild_s, total_s;
+  for ( auto r = 0u; r < ps.repeat; ++r )
+  {
+    auto const t_start = std::chrono::steady_clock::now();
+    klut_network klut;
+    names_view<klut_network> ntk{ klut };
+    if ( !cpsat::read_blif_file( blif_file.string(), ntk, ps.threads < 0 ? 0u : static_cast<uint32_t>( ps.threads ) ) )
+    {
+      return false;
+    }
+    read_s.push_back( seconds_since( t_start ) );
+
+    auto t_stage = std::chrono::steady_clock::now();
+    cut_enumeration_params cps;
+    cps.cut_size = K;
+    cps.cut_limit = C;
+    std::optional<network_cuts<names_view<klut_network>, true>> cut_res;
+    std::optional<cpsat::parallel_network_cuts<names_view<klut_network>>> parallel_res;
+    if ( ps.threads < 0 )
+    {
+      cut_res.emplace( cut_enumeration<names_view<klut_network>, true>( ntk, cps ) );
+    }
+    else
+    {
+      cpsat::parallel_cut_params pps;
+      pps.cut_size = K;
+      pps.cut_limit = C;
+      pps.num_threads = static_cast<uint32_t>( ps.threads );
+      parallel_res.emplace( ntk, pps );
+    }
+    enumerate_s.push_back( seconds_since( t_stage ) );
+
+    t_stage = std::chrono::steady_clock::now();
+    cpsat::cut_exporter<names_view<klut_network>> exporter( ntk );
+    auto db = exporter.empty_database( K, C, cpsat::cut_priority::none, 0u, cpsat::enumeration_of( parallel_res.has_value(), {} ) );
+    auto const reachable = exporter.reachable_nodes();
+    cpsat::reducing_cut_sink<cpsat::cut_database> reduced( db, reachable, exporter.outputs() );
+    if ( parallel_res )
+      parallel_res->export_nodes( reduced );
+    else
+      exporter.export_nodes( *cut_res, reduced );
+    if ( !db.mark_reduction( reduced.finish() ) )
+    {
+      std::cerr << "Error: the model reduction of '" << design << "' names a node or cut that was not exported\n";
+      return false;
+    }
+    export_s.push_back( seconds_since( t_stage ) );
+
+    t_stage = std::chrono::steady_clock::now();
+    bool const written = ps.format == "binary" ? cpsat::write_cut_database( db, cut_file.string() )
+                                               : cpsat::write_cut_database_json( db, cut_file.string() );
+    write_s.push_back( seconds_since( t_stage ) );
+    if ( !written )
+    {
+      std::cerr << "Error writing cut file '" << cut_file.string() << "'\n";
+      return false;
+    }
+
+    t_stage = std::chrono::steady_clock::now();
+    auto const view = db.view();
+    auto const chosen = cpsat::greedy_cover( view ).chosen_cut;
+    cpsat::rebuild_stats st;
+    auto const new_ntk = cpsat::rebuild_network( ntk, view, chosen, st );
+    rebuild_s.push_back( seconds_since( t_stage ) );
+    total_s.push_back( seconds_since( t_start ) );
+
+    res.network_nodes = ntk.size();
+    res.cut_nodes = view.num_nodes;
+    res.cuts = view.num_cuts;
+    res.tt_words = view.num_tt_words;
+    res.db_bytes = database_bytes( db );
+    res.file_bytes = cpsat::file_bytes( cut_file.string() );
+    res.rebuilt_nodes = new_ntk.size();
+  }
+
+  res.read_s = median( read_s );
+  res.enumerate_s = median( enumerate_s );
+  res.export_s = median( export_s );
+  res.write_s = median( write_s );
+  res.rebuild_s = median( rebuild_s );
+  res.total_s = median( total_s );
+  res.peak_rss_bytes = cpsat::peak_rss_bytes();
+  return true;
+}
+
+void write_csv( std::ostream& os, std::vector<benchmark_result> const& results )
+{
+  os << "design,K,C,network_nodes,cut_nodes,cuts,tt_words,db_bytes,file_bytes,rebuilt_nodes,"
+        "read_s,enumerate_s,export_s,write_s,rebuild_s,total_s,cuts_per_s,nodes_per_s,peak_rss_bytes\n";
+  for ( auto const& r : results )
+  {
+    os << r.design << "," << r.cut_size << "," << r.cut_limit << "," << r.network_nodes << "," << r.cut_nodes << ","
+       << r.cuts << "," << r.tt_words << "," << r.db_bytes << "," << r.file_bytes << "," << r.rebuilt_nodes << ","
+       << r.read_s << "," << r.enumerate_s << "," << r.export_s << "," << r.write_s << "," << r.rebuild_s << ","
+       << r.total_s << "," << r.cuts_per_s() << "," << r.nodes_per_s() << "," << r.peak_rss_bytes << "\n";
+  }
+}
+
+/*! \brief `cuts_per_s` of an earlier `--csv` file, keyed by design, K and C. */
+std::map<std::tuple<std::string, uint32_t, uint32_t>, double> read_baseline( std::string const& filename )
+{
+  std::map<std::tuple<std::string, uint32_t, uint32_t>, double> baseline;
+  std::ifstream is( filename );
+  std::string line;
+  if ( !std::getline( is, line ) )
+  {
+    return baseline;
+  }
+
+  auto split = []( std::string const& text ) {
+    std::vector<std::string> fields;
+    std::istringstream ls( text );
+    std::string field;
+    while ( std::getline( ls, field, ',' ) )
+    {
+      fields.push_back( field );
+    }
+    return fields;
+  };
+  auto const header = split( line );
+  auto column = [&]( std::string const& name ) {
+    return static_cast<std::size_t>( std::find( header.begin(), header.end(), name ) - header.begin() );
+  };
+  auto const c_design = column( "design" ), c_k = column( "K" ), c_c = column( "C" ), c_rate = column( "cuts_per_s" );
+  while ( std::getline( is, line ) )
+  {
+    auto const fields = split( line );
+    if ( std::max( { c_design, c_k, c_c, c_rate } ) >= fields.size() )
+    {
+      continue;
+    }
+    baseline[{ fields[c_design], static_cast<uint32_t>( std::atoi( fields[c_k].c_str() ) ),
+               static_cast<uint32_t>( std::atoi( fields[c_c].c_str() ) )}] = std::atof( fields[c_rate].c_str() );
+  }
+  return baseline;
+}
+
+} // namespace
+
+int main( int argc, char** argv )
+{
+  std::vector<std::string> positional;
+  benchmark_params ps;
+  std::string csv_file, baseline_file;
+  double tolerance = 0.1;
+  bool valid = true;
+  for ( int i = 1; i < argc; ++i )
+  {
+    std::string const arg = argv[i];
+    if ( arg == "--k" && i + 1 < argc )
+    {
+      valid &= parse_list( argv[++i], ps.cut_sizes );
+    }
+    else if ( arg == "--cut-limit" && i + 1 < argc )
+    {
+      valid &= parse_list( argv[++i], ps.cut_limits );
+    }
+    else if ( arg == "--repeat" && i + 1 < argc )
+    {
+      ps.repeat = static_cast<uint32_t>( std::max( 1, std::atoi( argv[++i] ) ) );
+    }
+    else if ( arg == "--threads" && i + 1 < argc )
+    {
+      ps.threads = std::max( 0, std::atoi( argv[++i] ) );
+    }
+    else if ( arg == "--format" && i + 1 < argc )
+    {
+      ps.format = argv[++i];
+      valid &= ps.format == "json" || ps.format == "binary";
+    }
+    else if ( arg == "--work-dir" && i + 1 < argc )
+    {
+      ps.work_dir = argv[++i];
+    }
+    else if ( arg == "--csv" && i + 1 < argc )
+    {
+      csv_file = argv[++i];
+    }
+    else if ( arg == "--baseline" && i + 1 < argc )
+    {
+      baseline_file = argv[++i];
+    }
+    else if ( arg == "--tolerance" && i + 1 < argc )
+    {
+      tolerance = std::atof( argv[++i] );
+    }
+    else
+    {
+      positional.push_back( arg );
+    }
+  }
+  valid &= std::all_of( ps.cut_limits.begin(), ps.cut_limits.end(), []( auto c ) { return c >= 2u; } );
+
+  if ( positional.empty() || !valid )
+  {
+    std::cerr << "Usage: cut_benchmark <bench_dir|file.aig|file.blif>... [--k 4,6] [--cut-limit 8,32]\n"
+                 "                     [--repeat R] [--threads N] [--format json|binary] [--work-dir DIR]\n"
+                 "                     [--csv FILE] [--baseline FILE] [--tolerance 0.1]\n";
+    return 1;
+  }
+
+  std::vector<std::filesystem::path> inputs;
+  for ( auto const& p : positional )
+  {
+    if ( std::filesystem::is_directory( p ) )
+    {
+      std::vector<std::filesystem::path> files;
+      for ( auto const& entry : std::filesystem::directory_iterator( p ) )
+      {
+        auto const ext = entry.path().extension();
+        if ( entry.is_regular_file() && ( ext == ".aig" || ext == ".aag" || ext == ".blif" ) )
+        {
+          files.push_back( entry.path() );
+        }
+      }
+      std::sort( files.begin(), files.end() );
+      inputs.insert( inputs.end(), files.begin(), files.end() );
+    }
+    else
+    {
+      inputs.push_back( p );
+    }
+  }
+
+  std::error_code ec;
+  std::filesystem::create_directories( ps.work_dir, ec );
+  if ( ec )
+  {
+    std::cerr << "Error creating work directory '" << ps.work_dir.string() << "'\n";
+    return 1;
+  }
+
+  std::cout << std::left << std::setw( 14 ) << "design" << std::right << std::setw( 4 ) << "K" << std::setw( 5 ) << "C"
+            << std::setw( 10 ) << "nodes" << std::setw( 11 ) << "cuts" << std::setw( 10 ) << "read" << std::setw( 10 )
+            << "enum" << std::setw( 10 ) << "export" << std::setw( 10 ) << "write" << std::setw( 10 ) << "rebuild"
+            << std::setw( 12 ) << "cuts/s" << std::setw( 12 ) << "nodes/s" << std::setw( 10 ) << "RSS MB" << "\n";
+
+  std::vector<benchmark_result> results;
+  uint32_t failures = 0u;
+  for ( auto const& input : inputs )
+  {
+    auto const blif = benchmark_blif( input, ps.work_dir );
+    if ( !blif )
+    {
+      ++failures;
+      continue;
+    }
+    for ( auto const K : ps.cut_sizes )
+    {
+      for ( auto const C : ps.cut_limits )
+      {
+        benchmark_result r;
+        if ( !run_benchmark( *blif, input.stem().string(), K, C, ps, r ) )
+        {
+          ++failures;
+          continue;
+        }
+        std::cout << std::left << std::setw( 14 ) << r.design << std::right << std::setw( 4 ) << K << std::setw( 5 ) << C
+                  << std::setw( 10 ) << r.network_nodes << std::setw( 11 ) << r.cuts << std::fixed << std::setprecision( 4 )
+                  << std::setw( 10 ) << r.read_s << std::setw( 10 ) << r.enumerate_s << std::setw( 10 ) << r.export_s
+                  << std::setw( 10 ) << r.write_s << std::setw( 10 ) << r.rebuild_s << std::setprecision( 0 )
+                  << std::setw( 12 ) << r.cuts_per_s() << std::setw( 12 ) << r.nodes_per_s() << std::setprecision( 1 )
+                  << std::setw( 10 ) << r.peak_rss_bytes / ( 1024.0 * 1024.0 ) << std::defaultfloat << std::endl;
+        results.push_back( r );
+      }
+    }
+  }
+
+  if ( !csv_file.empty() )
+  {
+    std::ofstream os( csv_file );
+    write_csv( os, results );
+    if ( !os )
+    {
+      std::cerr << "Error writing '" << csv_file << "'\n";
+      return 1;
+    }
+  }
+
+  uint32_t regressions = 0u;
+  if ( !baseline_file.empty() )
+  {
+    auto const baseline = read_baseline( baseline_file );
+    for ( auto const& r : results )
+    {
+      auto const it = baseline.find( { r.design, r.cut_size, r.cut_limit } );
+      if ( it == baseline.end() || it->second <= 0.0 )
+      {
+        continue;
+      }
+      auto const ratio = r.cuts_per_s() / it->second;
+      if ( ratio < 1.0 - tolerance )
+      {
+        std::cerr << "[regression] " << r.design << " K=" << r.cut_size << " C=" << r.cut_limit << ": "
+                  << r.cuts_per_s() << " cuts/s vs. " << it->second << " in the baseline (" << ratio << "x)\n";
+        ++regressions;
+      }
+    }
+    std::cerr << "[info] " << regressions << " regressions against " << baseline_file << "\n";
+  }
+
+  if ( failures > 0u )
+  {
+    return 2;
+  }
+  return regressions > 0u ? 4 : 0;
+}
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+
+#include <unistd.h>
+
+#include "cut_database.hpp"
+
+/* Content-addressed cache of cut files for cut_enumeration.
+ *
+ * An entry is named after a hash of the BLIF bytes and of every setting that
+ * changes the exported cuts, so reruns of the same design with a different
+ * solver objective copy the stored file instead of enumerating again.
+ */
+namespace cpsat
+{
+
+/*! \brief FNV-1a over `data`, continuing from `h`. */
+inline uint64_t fnv1a_64( std::string_view data, uint64_t h = 0xcbf29ce484222325u )
+{
+  for ( auto c : data )
+  {
+    h = ( h ^ static_cast<uint8_t>( c ) ) * 0x100000001b3u;
+  }
+  return h;
+}
+
+/*! \brief Cache key of `blif_file` enumerated with `settings`, or nothing if the file cannot be read.
+ *
+ * `settings` must spell out everything that affects the cut file (K, cut
+ * limit, priority, pruning, enumerator, format); the cut database version is
+ * mixed in so that entries of an older layout are never reused. The key is
+ * the hash followed by the BLIF size in bytes.
+ */
+inline std::optional<std::string> cut_cache_key( std::string const& blif_file, std::string const& settings )
+{
+  std::ifstream is( blif_file, std::ios::binary );
+  if ( !is )
+  {
+    return std::nullopt;
+  }
+  std::string const content( ( std::istreambuf_iterator<char>( is ) ), std::istreambuf_iterator<char>() );
+  if ( is.bad() )
+  {
+    return std::nullopt;
+  }
+
+  auto h = fnv1a_64( content );
+  h = fnv1a_64( settings + ";cdb=" + std::to_string( cut_database_version ), h );
+
+  char key[40];
+  std::snprintf( key, sizeof( key ), "%016llx-%llu", static_cast<unsigned long long>( h ),
+                 static_cast<unsigned long long>( content.size() ) );
+  return std::string( key );
+}
+
+/*! \brief Cut files stored in a directory under their cache key. */
+class cut_cache
+{
+public:
+  explicit cut_cache( std::filesystem::path dir )
+      : _dir( std::move( dir ) )
+  {
+  }
+
+  /*! \brief Copies the entry `key` to `out_file`; returns false on a miss. */
+  bool fetch( std::string const& key, std::string const& extension, std::filesystem::path const& out_file ) const
+  {
+    auto const entry = _dir / ( key + extension );
+    std::error_code ec;
+    if ( !std::filesystem::is_regular_file( entry, ec ) )
+    {
+      return false;
+    }
+    std::filesystem::copy_file( entry, out_file, std::filesystem::copy_options::overwrite_existing, ec );
+    return !ec;
+  }
+
+  /*! \brief Adds `cut_file` as the entry `key`.
+   *
+   * The file is copied next to the entry and renamed into place, so
+   * concurrent runs never see a partial entry. The temporary name holds the
+   * process id and a per-process counter, so batch jobs storing the same key
+   * at once do not share it.
+   */
+  bool store( std::string const& key, std::string const& extension, std::filesystem::path const& cut_file ) const
+  {
+    std::error_code ec;
+    std::filesystem::create_directories( _dir, ec );
+    auto const entry = _dir / ( key + extension );
+    auto tmp = entry;
+    static std::atomic<uint64_t> num_stores{ 0u };
+    tmp += ".tmp" + std::to_string( static_cast<unsigned long>( ::getpid() ) ) + "-" + std::to_string( num_stores++ );
+    std::filesystem::copy_file( cut_file, tmp, std::filesystem::copy_options::overwrite_existing, ec );
+    if ( !ec )
+    {
+      std::filesystem::rename( tmp, entry, ec );
+    }
+    if ( ec )
+    {
+      std::filesystem::remove( tmp, ec );
+      return false;
+    }
+    return true;
+  }
+
+  std::filesystem::path const& dir() const { return _dir; }
+
+private:
+  std::filesystem::path _dir;
+};
+
+} // namespace cpsat
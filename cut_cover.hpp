@@ -0,0 +1,228 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "cut_database.hpp"
+#include "cut_rebuild.hpp"
+
+/* Greedy covers of a cut database, used as CP-SAT warm starts
+ * (`cut_enumeration --hint-cover`) and by cut_benchmark.
+ *
+ * Nodes are visited in topological order and every node gets a best
+ * feasible non-trivial cut; the cover is then extracted from the outputs
+ * down, taking the best cut of every node a chosen cut needs. `area` ranks
+ * cuts by area flow (the cut's area plus the flow of its leaves shared among
+ * their references) and repeats the pass once with the references of the
+ * first cover, as in area recovery of LUT mappers. `depth` ranks cuts by the
+ * level they give the node, with area flow as tie-breaker.
+ */
+namespace cpsat
+{
+
+enum class cover_objective
+{
+  area,
+  depth
+};
+
+inline bool parse_cover_objective( std::string const& name, cover_objective& objective )
+{
+  if ( name == "area" )
+    objective = cover_objective::area;
+  else if ( name == "depth" )
+    objective = cover_objective::depth;
+  else
+    return false;
+  return true;
+}
+
+inline std::string cover_objective_name( cover_objective objective )
+{
+  return objective == cover_objective::depth ? "depth" : "area";
+}
+
+struct cover_result
+{
+  /*! \brief Chosen cut per node index, `no_chosen_cut` for nodes outside the cover. */
+  std::vector<uint32_t> chosen_cut;
+
+  /*! \brief Sum of `area_cost` over the chosen cuts. */
+  uint64_t area{ 0u };
+
+  /*! \brief Largest level of an output, counting `max(depth_cost, 1)` per cut. */
+  uint32_t depth{ 0u };
+
+  uint32_t nodes{ 0u };
+
+  /*! \brief False if a required node has no feasible cut; the cover is partial then. */
+  bool complete{ true };
+};
+
+namespace detail
+{
+
+/*! \brief One forward pass: best cut position per node position, by `objective` over `refs`. */
+inline void best_cover_cuts( cut_database_view const& db, std::vector<uint32_t> const& pos, std::vector<double> const& refs,
+                             cover_objective objective, std::vector<uint32_t>& best, std::vector<uint32_t>& level )
+{
+  constexpr auto none = std::numeric_limits<uint32_t>::max();
+  std::vector<double> flow( db.num_nodes, 0.0 );
+  best.assign( db.num_nodes, none );
+  level.assign( db.num_nodes, 0u );
+  for ( auto i = 0u; i < db.num_nodes; ++i )
+  {
+    auto const& nd = db.nodes[i];
+    auto best_key = std::make_tuple( std::numeric_limits<double>::max(), std::numeric_limits<double>::max(), none );
+    for ( auto c = 0u; c < nd.num_cuts; ++c )
+    {
+      auto const& cut = db.cuts[nd.cut_begin + c];
+      if ( ( cut.num_leaves == 1u && *db.leaves_begin( cut ) == nd.index ) || ( cut.flags & cut_infeasible ) )
+      {
+        continue;
+      }
+      double cut_flow = cut.area_cost;
+      uint32_t cut_level = 0u;
+      bool feasible = true;
+      for ( auto leaf = db.leaves_begin( cut ); leaf != db.leaves_end( cut ); ++leaf )
+      {
+        auto const p = pos[*leaf];
+        if ( p == none )
+        {
+          continue; // PIs and constants are free and at level 0
+        }
+        if ( p >= i || best[p] == none )
+        {
+          feasible = false;
+          break;
+        }
+        cut_flow += flow[p] / refs[p];
+        cut_level = std::max( cut_level, level[p] );
+      }
+      if ( !feasible )
+      {
+        continue;
+      }
+      cut_level += std::max( cut.depth_cost, 1u );
+      auto const key = objective == cover_objective::depth ? std::make_tuple( double( cut_level ), cut_flow, cut.num_leaves )
+                                                           : std::make_tuple( cut_flow, double( cut_level ), cut.num_leaves );
+      if ( key < best_key )
+      {
+        best_key = key;
+        best[i] = c;
+        flow[i] = cut_flow;
+        level[i] = cut_level;
+      }
+    }
+  }
+}
+
+} // namespace detail
+
+/*! \brief Greedy cover of `db` for `objective`; forced cuts are kept since they are their node's only feasible cut. */
+inline cover_result greedy_cover( cut_database_view const& db, cover_objective objective = cover_objective::area )
+{
+  constexpr auto none = std::numeric_limits<uint32_t>::max();
+  std::vector<uint32_t> pos( db.num_names, none );
+  for ( auto i = 0u; i < db.num_nodes; ++i )
+  {
+    pos[db.nodes[i].index] = i;
+  }
+
+  /* first estimate of the references: nodes with a feasible cut on the leaf */
+  std::vector<double> refs( db.num_nodes, 0.0 );
+  std::vector<uint32_t> last_ref( db.num_nodes, none );
+  for ( auto i = 0u; i < db.num_nodes; ++i )
+  {
+    auto const& nd = db.nodes[i];
+    for ( auto cut = db.cuts_begin( nd ); cut != db.cuts_end( nd ); ++cut )
+    {
+      if ( cut->flags & cut_infeasible )
+      {
+        continue;
+      }
+      for ( auto leaf = db.leaves_begin( *cut ); leaf != db.leaves_end( *cut ); ++leaf )
+      {
+        auto const p = pos[*leaf];
+        if ( p != none && p != i && last_ref[p] != i )
+        {
+          last_ref[p] = i;
+          refs[p] += 1.0;
+        }
+      }
+    }
+  }
+
+  auto extract = [&]( std::vector<uint32_t> const& best, std::vector<uint32_t> const& level, std::vector<double>& cover_refs ) {
+    cover_result res;
+    res.chosen_cut.assign( db.num_names, no_chosen_cut );
+    cover_refs.assign( db.num_nodes, 0.0 );
+    std::vector<bool> required( db.num_nodes, false );
+    for ( auto o = 0u; o < db.num_outputs; ++o )
+    {
+      if ( pos[db.outputs[o]] != none )
+      {
+        required[pos[db.outputs[o]]] = true;
+        res.depth = std::max( res.depth, level[pos[db.outputs[o]]] );
+      }
+    }
+    for ( auto i = db.num_nodes; i-- > 0u; )
+    {
+      if ( !required[i] )
+      {
+        continue;
+      }
+      if ( best[i] == none )
+      {
+        res.complete = false;
+        continue;
+      }
+      auto const& nd = db.nodes[i];
+      auto const& cut = db.cuts[nd.cut_begin + best[i]];
+      res.chosen_cut[nd.index] = best[i];
+      res.area += cut.area_cost;
+      ++res.nodes;
+      for ( auto leaf = db.leaves_begin( cut ); leaf != db.leaves_end( cut ); ++leaf )
+      {
+        if ( pos[*leaf] != none )
+        {
+          required[pos[*leaf]] = true;
+          cover_refs[pos[*leaf]] += 1.0;
+        }
+      }
+    }
+    return res;
+  };
+
+  for ( auto& r : refs )
+  {
+    r = std::max( r, 1.0 );
+  }
+  std::vector<uint32_t> best, level;
+  std::vector<double> cover_refs;
+  detail::best_cover_cuts( db, pos, refs, objective, best, level );
+  auto res = extract( best, level, cover_refs );
+  if ( objective != cover_objective::area )
+  {
+    return res;
+  }
+
+  /* area recovery: flows shared among the references of the first cover */
+  for ( auto i = 0u; i < db.num_nodes; ++i )
+  {
+    refs[i] = std::max( cover_refs[i], 1.0 );
+  }
+  detail::best_cover_cuts( db, pos, refs, objective, best, level );
+  auto recovered = extract( best, level, cover_refs );
+  if ( std::make_tuple( !recovered.complete, recovered.area ) < std::make_tuple( !res.complete, res.area ) )
+  {
+    return recovered;
+  }
+  return res;
+}
+
+} // namespace cpsat
@@ -0,0 +1,871 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/* Binary cut database shared by cut_enumeration, rebuild_from_cpsat and main_cpsat.py.
+ *
+ * File layout (little endian, every section starts on an 8-byte boundary):
+ *
+ *   header        cut_database_header
+ *   name_offsets  uint32[num_names + 1]  byte ranges into name_chars, indexed by network node index
+ *   nodes         node_record[num_nodes] exported (non-PI, non-constant) nodes in topological order
+ *   cuts          cut_record[num_cuts]   cuts of all nodes, grouped by node
+ *   leaves        uint32[num_leaves]     leaf node indices of all cuts
+ *   inputs        uint32[num_inputs]     PI node indices
+ *   outputs       uint32[num_outputs]    output node indices
+ *   tt_words      uint64[num_tt_words]   interned cut truth tables, tt_num_words( num_leaves ) words per function
+ *   name_chars    char[name_bytes]
+ *
+ * The header stores the byte offset of every section, so readers can map the file and use it in place.
+ * Each distinct truth table is stored once; `cut_record::tt_begin` is the word offset of the cut's
+ * function and doubles as its function ID (cuts with equal words share it).
+ *
+ * Version 2 added `cut_record::shared_cost`, covered nodes other than the root that also fan out of
+ * the cut's cone (see `cut_cone_costs` in cut_export.hpp), and made `area_cost` and `depth_cost`
+ * structural as well; version 7 moved those to their own fields.
+ *
+ * Version 3 added `node_record::flags` and `cut_record::flags`, the model reduction of the exporter
+ * (see `reducing_cut_sink` in cut_export.hpp): nodes outside the transitive fanin of the outputs are
+ * not exported, `node_forced` nodes are used by every cover, `cut_forced` cuts are the only feasible
+ * cut of a forced node and `cut_infeasible` cuts have a leaf that can never be implemented. Self cuts
+ * are never feasible and are not flagged.
+ *
+ * Version 4 added `node_record::min_level` and `node_record::height`, the level bounds of the depth
+ * model: a used node sits at least `min_level` levels above the inputs (its minimum depth over the
+ * feasible cuts) and at least `height` levels below an output, so with depth bound D its level lies in
+ * `[min_level, D - height]`. `no_level` marks a node that no output can use. Zero is always a valid,
+ * loose bound.
+ *
+ * Version 5 added `node_record::signature`, a structural hash of the node's function and the signatures
+ * of its fanins down to the named PIs (see `structural_signatures` in cut_eco.hpp). Nodes with equal
+ * signatures in two networks have the same transitive fanin, which is how ECO mode finds the nodes whose
+ * cuts it can reuse. Zero means unknown.
+ *
+ * Version 6 added `cut_database_header::top_n` and `cut_database_header::enumeration`: the top-N
+ * pruning of the export (0 if none, including the pruning of a cut priority), whether dominated cuts
+ * were pruned or cuts dropped at window boundaries, and whether the cuts come from
+ * `parallel_cut_enumeration.hpp` or mockturtle. ECO mode only reuses unpruned cut sets of the
+ * native enumerator (see cut_eco.hpp).
+ *
+ * Version 7 added `cut_record::cone_area` and `cut_record::cone_depth`, the structural area and depth
+ * of version 2 (nodes covered, nodes on the longest leaf-to-root path). `area_cost` and `depth_cost`
+ * are the LUT costs again, the number of leaves and one level per cut, so the depth objective and
+ * `--fix-depth` count LUT levels; the solvers use the cone costs with `--cone-costs`.
+ */
+namespace cpsat
+{
+
+constexpr char cut_database_magic[8] = { 'C', 'P', 'S', 'A', 'T', 'C', 'D', 'B' };
+constexpr uint32_t cut_database_version = 7u;
+
+/*! \brief `node_record::height` of a node that is not a feasible leaf on any path to an output. */
+constexpr uint32_t no_level = std::numeric_limits<uint32_t>::max();
+
+enum cut_database_section : uint32_t
+{
+  section_name_offsets = 0,
+  section_nodes,
+  section_cuts,
+  section_leaves,
+  section_inputs,
+  section_outputs,
+  section_tt_words,
+  section_name_chars,
+  num_cut_database_sections
+};
+
+struct cut_database_header
+{
+  char magic[8];
+  uint32_t version;
+  uint32_t cut_size;
+  uint32_t cut_limit;
+  uint32_t num_names;
+  uint32_t num_nodes;
+  uint32_t num_cuts;
+  uint32_t num_leaves;
+  uint32_t num_inputs;
+  uint32_t num_outputs;
+  uint32_t cut_priority;
+  uint32_t top_n;
+  uint32_t enumeration;
+  uint64_t num_tt_words;
+  uint64_t name_bytes;
+  uint64_t offsets[num_cut_database_sections];
+};
+static_assert( sizeof( cut_database_header ) == 136, "cut database header must stay 136 bytes" );
+
+struct node_record
+{
+  uint32_t index;
+  uint32_t cut_begin;
+  uint32_t num_cuts;
+  uint32_t flags;
+  uint32_t min_level;
+  uint32_t height;
+  uint64_t signature;
+};
+
+struct cut_record
+{
+  uint32_t leaf_begin;
+  uint32_t num_leaves;
+  uint32_t tt_begin;
+  uint32_t inv_cost;
+  uint32_t area_cost;
+  uint32_t depth_cost;
+  uint32_t shared_cost;
+  uint32_t cone_area;
+  uint32_t cone_depth;
+  uint32_t flags;
+};
+
+enum node_flags : uint32_t
+{
+  node_forced = 1u
+};
+
+enum cut_flags : uint32_t
+{
+  cut_forced = 1u,
+  cut_infeasible = 2u
+};
+
+/*! \brief How the cuts of a database were produced (`cut_database_header::enumeration`). */
+enum enumeration_flags : uint32_t
+{
+  enumeration_native = 1u,           /* parallel_cut_enumeration.hpp instead of mockturtle's cut_enumeration */
+  enumeration_pruned_dominated = 2u, /* exported through `cut_pruning_params::prune_dominated` */
+  enumeration_windowed = 4u          /* cuts across window boundaries dropped (cut_windows.hpp) */
+};
+
+/*! \brief Decisions the exporter settles before the solver runs; cuts are `( node index, cut position within the node )`. */
+struct model_reduction
+{
+  std::vector<uint32_t> forced_nodes;
+  std::vector<std::pair<uint32_t, uint32_t>> forced_cuts;
+  std::vector<std::pair<uint32_t, uint32_t>> infeasible_cuts;
+  std::vector<std::tuple<uint32_t, uint32_t, uint32_t>> level_bounds; /* ( node index, min_level, height ) */
+  uint64_t dropped_nodes{ 0u };
+};
+
+/*! \brief Metric of the exporter's priority-cut mode (best `cut_limit` cuts per node); `none` keeps the enumerator's cuts. */
+enum class cut_priority : uint32_t
+{
+  none = 0,
+  area = 1,
+  inv = 2,
+  depth = 3
+};
+
+inline char const* cut_priority_name( cut_priority priority )
+{
+  switch ( priority )
+  {
+  case cut_priority::area:
+    return "area";
+  case cut_priority::inv:
+    return "inv";
+  case cut_priority::depth:
+    return "depth";
+  default:
+    return "none";
+  }
+}
+
+/*! \brief Parses `none`, `area`, `inv` or `depth`; returns false for anything else. */
+inline bool parse_cut_priority( std::string_view name, cut_priority& priority )
+{
+  for ( auto p : { cut_priority::none, cut_priority::area, cut_priority::inv, cut_priority::depth } )
+  {
+    if ( name == cut_priority_name( p ) )
+    {
+      priority = p;
+      return true;
+    }
+  }
+  return false;
+}
+
+/*! \brief Number of 64-bit words of a truth table over `num_vars` variables. */
+inline uint32_t tt_num_words( uint32_t num_vars )
+{
+  return num_vars <= 6u ? 1u : ( 1u << ( num_vars - 6u ) );
+}
+
+namespace detail
+{
+
+/* FNV-1a over 64-bit words */
+template<typename WordIt>
+inline uint64_t hash_words( WordIt begin, WordIt end )
+{
+  uint64_t h = 0xcbf29ce484222325u;
+  for ( ; begin != end; ++begin )
+  {
+    h = ( h ^ static_cast<uint64_t>( *begin ) ) * 0x100000001b3u;
+  }
+  return h;
+}
+
+struct word_vector_hash
+{
+  std::size_t operator()( std::vector<uint64_t> const& words ) const
+  {
+    return static_cast<std::size_t>( hash_words( words.begin(), words.end() ) );
+  }
+};
+
+} // namespace detail
+
+/*! \brief Hex string of a truth table, most significant digit first (same spelling as `kitty::to_hex`). */
+template<typename WordIt>
+inline std::string tt_to_hex( WordIt words, uint32_t num_vars )
+{
+  static char const digits[] = "0123456789abcdef";
+  uint64_t const num_digits = num_vars <= 2u ? 1u : ( uint64_t( 1 ) << ( num_vars - 2u ) );
+  std::string hex( num_digits, '0' );
+  for ( uint64_t d = 0; d < num_digits; ++d )
+  {
+    auto const word = words[d / 16u];
+    hex[num_digits - 1u - d] = digits[( word >> ( 4u * ( d % 16u ) ) ) & 0xfu];
+  }
+  return hex;
+}
+
+/*! \brief Parses a `tt_to_hex` string into `tt_num_words( num_vars )` words; returns false on malformed input. */
+template<typename WordIt>
+inline bool tt_from_hex( std::string_view hex, uint32_t num_vars, WordIt words )
+{
+  uint64_t const num_digits = num_vars <= 2u ? 1u : ( uint64_t( 1 ) << ( num_vars - 2u ) );
+  if ( hex.size() != num_digits )
+  {
+    return false;
+  }
+  for ( auto w = 0u; w < tt_num_words( num_vars ); ++w )
+  {
+    words[w] = 0u;
+  }
+  for ( uint64_t d = 0; d < num_digits; ++d )
+  {
+    char const c = hex[num_digits - 1u - d];
+    uint64_t value;
+    if ( c >= '0' && c <= '9' )
+      value = c - '0';
+    else if ( c >= 'a' && c <= 'f' )
+      value = c - 'a' + 10;
+    else if ( c >= 'A' && c <= 'F' )
+      value = c - 'A' + 10;
+    else
+      return false;
+    words[d / 16u] |= value << ( 4u * ( d % 16u ) );
+  }
+  return true;
+}
+
+/*! \brief Read-only access to a cut database, either mapped from disk or backed by a `cut_database`. */
+struct cut_database_view
+{
+  uint32_t cut_size{ 0 };
+  uint32_t cut_limit{ 0 };
+  cut_priority priority{ cut_priority::none };
+  uint32_t top_n{ 0 };
+  uint32_t enumeration{ 0 };
+  uint32_t num_names{ 0 };
+  uint32_t num_nodes{ 0 };
+  uint32_t num_cuts{ 0 };
+  uint32_t num_leaves{ 0 };
+  uint32_t num_inputs{ 0 };
+  uint32_t num_outputs{ 0 };
+  uint64_t num_tt_words{ 0 };
+
+  uint32_t const* name_offsets{ nullptr };
+  node_record const* nodes{ nullptr };
+  cut_record const* cuts{ nullptr };
+  uint32_t const* leaves{ nullptr };
+  uint32_t const* inputs{ nullptr };
+  uint32_t const* outputs{ nullptr };
+  uint64_t const* tt_words{ nullptr };
+  char const* name_chars{ nullptr };
+
+  std::string_view name( uint32_t index ) const
+  {
+    return std::string_view( name_chars + name_offsets[index], name_offsets[index + 1] - name_offsets[index] );
+  }
+
+  cut_record const* cuts_begin( node_record const& nd ) const { return cuts + nd.cut_begin; }
+  cut_record const* cuts_end( node_record const& nd ) const { return cuts + nd.cut_begin + nd.num_cuts; }
+
+  uint32_t const* leaves_begin( cut_record const& cut ) const { return leaves + cut.leaf_begin; }
+  uint32_t const* leaves_end( cut_record const& cut ) const { return leaves + cut.leaf_begin + cut.num_leaves; }
+
+  uint64_t const* tt_begin( cut_record const& cut ) const { return tt_words + cut.tt_begin; }
+  uint64_t const* tt_end( cut_record const& cut ) const { return tt_words + cut.tt_begin + tt_num_words( cut.num_leaves ); }
+};
+
+/*! \brief The flags of a cut database as lists, the inverse of `cut_database::mark_reduction` (`dropped_nodes` is not stored). */
+inline model_reduction stored_reduction( cut_database_view const& db )
+{
+  model_reduction reduction;
+  for ( auto i = 0u; i < db.num_nodes; ++i )
+  {
+    auto const& nd = db.nodes[i];
+    if ( nd.flags & node_forced )
+    {
+      reduction.forced_nodes.push_back( nd.index );
+    }
+    reduction.level_bounds.emplace_back( nd.index, nd.min_level, nd.height );
+    for ( auto c = 0u; c < nd.num_cuts; ++c )
+    {
+      auto const flags = db.cuts[nd.cut_begin + c].flags;
+      if ( flags & cut_forced )
+      {
+        reduction.forced_cuts.emplace_back( nd.index, c );
+      }
+      if ( flags & cut_infeasible )
+      {
+        reduction.infeasible_cuts.emplace_back( nd.index, c );
+      }
+    }
+  }
+  return reduction;
+}
+
+/*! \brief Lookup from node names to node indices over the names interned in a cut database.
+ *
+ * Open addressing on the name table itself: slots hold node indices and
+ * compare against `db.name( index )`, so building and querying allocate
+ * no strings. Built once per database; the database must outlive it.
+ */
+class node_name_index
+{
+public:
+  static constexpr uint32_t npos = UINT32_MAX;
+
+  explicit node_name_index( cut_database_view const& db )
+      : _db( db )
+  {
+    std::size_t num_slots = 16u;
+    while ( num_slots < 2u * static_cast<std::size_t>( db.num_nodes ) )
+    {
+      num_slots <<= 1u;
+    }
+    _slots.assign( num_slots, npos );
+    _mask = num_slots - 1u;
+    for ( auto i = 0u; i < db.num_nodes; ++i )
+    {
+      auto const index = db.nodes[i].index;
+      auto slot = hash( db.name( index ) ) & _mask;
+      while ( _slots[slot] != npos && db.name( _slots[slot] ) != db.name( index ) )
+      {
+        slot = ( slot + 1u ) & _mask;
+      }
+      _slots[slot] = index; // duplicate names keep the last node, as a map assignment would
+    }
+  }
+
+  /*! \brief Node index of `name`, or `npos` if no exported node has that name. */
+  uint32_t find( std::string_view name ) const
+  {
+    for ( auto slot = hash( name ) & _mask; _slots[slot] != npos; slot = ( slot + 1u ) & _mask )
+    {
+      if ( _db.name( _slots[slot] ) == name )
+      {
+        return _slots[slot];
+      }
+    }
+    return npos;
+  }
+
+private:
+  /* FNV-1a */
+  static std::size_t hash( std::string_view name )
+  {
+    uint64_t h = 0xcbf29ce484222325u;
+    for ( auto c : name )
+    {
+      h = ( h ^ static_cast<uint8_t>( c ) ) * 0x100000001b3u;
+    }
+    return static_cast<std::size_t>( h );
+  }
+
+  cut_database_view _db;
+  std::vector<uint32_t> _slots;
+  std::size_t _mask{ 0u };
+};
+
+/*! \brief In-memory cut database as produced by the exporter. */
+struct cut_database
+{
+  uint32_t cut_size{ 0 };
+  uint32_t cut_limit{ 0 };
+  cut_priority priority{ cut_priority::none };
+
+  /*! \brief Cuts per node kept by the top-N pruning of the export, 0 if none. */
+  uint32_t top_n{ 0 };
+
+  /*! \brief `enumeration_flags` of the enumeration and export that produced the cuts. */
+  uint32_t enumeration{ 0 };
+
+  std::vector<uint32_t> name_offsets{ 0u };
+  std::string name_chars;
+  std::vector<node_record> nodes;
+  std::vector<cut_record> cuts;
+  std::vector<uint32_t> leaves;
+  std::vector<uint32_t> inputs;
+  std::vector<uint32_t> outputs;
+  std::vector<uint64_t> tt_words;
+
+  /*! \brief Word hash to offset in `tt_words`, for interning. */
+  std::unordered_multimap<uint64_t, uint32_t> tt_index;
+
+  /*! \brief Appends the name of the next network node index. */
+  void add_name( std::string_view name )
+  {
+    name_chars.append( name.data(), name.size() );
+    name_offsets.push_back( static_cast<uint32_t>( name_chars.size() ) );
+  }
+
+  void begin_node( uint32_t index )
+  {
+    nodes.push_back( { index, static_cast<uint32_t>( cuts.size() ), 0u, 0u, 0u, 0u, 0u } );
+  }
+
+  /*! \brief Appends a cut to the node opened last with `begin_node`. */
+  template<typename LeafIt, typename WordIt>
+  void add_cut( LeafIt leaves_begin, LeafIt leaves_end, WordIt tt_begin, uint32_t inv_cost, uint32_t area_cost, uint32_t depth_cost,
+                uint32_t shared_cost, uint32_t cone_area, uint32_t cone_depth )
+  {
+    cut_record cut;
+    cut.leaf_begin = static_cast<uint32_t>( leaves.size() );
+    leaves.insert( leaves.end(), leaves_begin, leaves_end );
+    cut.num_leaves = static_cast<uint32_t>( leaves.size() ) - cut.leaf_begin;
+    cut.tt_begin = intern_truth_table( tt_begin, tt_num_words( cut.num_leaves ) );
+    cut.inv_cost = inv_cost;
+    cut.area_cost = area_cost;
+    cut.depth_cost = depth_cost;
+    cut.shared_cost = shared_cost;
+    cut.cone_area = cone_area;
+    cut.cone_depth = cone_depth;
+    cut.flags = 0u;
+    cuts.push_back( cut );
+  }
+
+  /*! \brief Closes the node opened last: its cuts are the ones appended since `begin_node`. */
+  void end_node()
+  {
+    nodes.back().num_cuts = static_cast<uint32_t>( cuts.size() ) - nodes.back().cut_begin;
+  }
+
+  /*! \brief Sets `node_record::signature` from `signatures`, indexed by node index. */
+  void set_signatures( std::vector<uint64_t> const& signatures )
+  {
+    for ( auto& nd : nodes )
+    {
+      nd.signature = nd.index < signatures.size() ? signatures[nd.index] : 0u;
+    }
+  }
+
+  /*! \brief Sets the flags of `reduction`; returns false if it names a node or cut that is not stored. */
+  bool mark_reduction( model_reduction const& reduction )
+  {
+    std::vector<uint32_t> pos;
+    for ( auto i = 0u; i < nodes.size(); ++i )
+    {
+      if ( nodes[i].index >= pos.size() )
+      {
+        pos.resize( nodes[i].index + 1u, std::numeric_limits<uint32_t>::max() );
+      }
+      pos[nodes[i].index] = i;
+    }
+    auto find_node = [&]( uint32_t index ) -> node_record* {
+      return index < pos.size() && pos[index] != std::numeric_limits<uint32_t>::max() ? &nodes[pos[index]] : nullptr;
+    };
+    for ( auto index : reduction.forced_nodes )
+    {
+      auto* nd = find_node( index );
+      if ( nd == nullptr )
+      {
+        return false;
+      }
+      nd->flags |= node_forced;
+    }
+    for ( auto const& [index, min_level, height] : reduction.level_bounds )
+    {
+      auto* nd = find_node( index );
+      if ( nd == nullptr )
+      {
+        return false;
+      }
+      nd->min_level = min_level;
+      nd->height = height;
+    }
+    auto mark_cut = [&]( std::pair<uint32_t, uint32_t> const& c, uint32_t flag ) {
+      auto* nd = find_node( c.first );
+      if ( nd == nullptr || c.second >= nd->num_cuts )
+      {
+        return false;
+      }
+      cuts[nd->cut_begin + c.second].flags |= flag;
+      return true;
+    };
+    for ( auto const& c : reduction.forced_cuts )
+    {
+      if ( !mark_cut( c, cut_forced ) )
+      {
+        return false;
+      }
+    }
+    for ( auto const& c : reduction.infeasible_cuts )
+    {
+      if ( !mark_cut( c, cut_infeasible ) )
+      {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /*! \brief Offset of `num_words` words in `tt_words`, appended only if no earlier cut stored the same words. */
+  template<typename WordIt>
+  uint32_t intern_truth_table( WordIt words, uint32_t num_words )
+  {
+    auto const h = detail::hash_words( words, words + num_words );
+    auto const range = tt_index.equal_range( h );
+    for ( auto it = range.first; it != range.second; ++it )
+    {
+      auto const offset = it->second;
+      if ( offset + num_words <= tt_words.size() && std::equal( words, words + num_words, tt_words.begin() + offset ) )
+      {
+        return offset;
+      }
+    }
+    auto const offset = static_cast<uint32_t>( tt_words.size() );
+    tt_words.insert( tt_words.end(), words, words + num_words );
+    tt_index.emplace( h, offset );
+    return offset;
+  }
+
+  cut_database_view view() const
+  {
+    cut_database_view v;
+    v.cut_size = cut_size;
+    v.cut_limit = cut_limit;
+    v.priority = priority;
+    v.top_n = top_n;
+    v.enumeration = enumeration;
+    v.num_names = static_cast<uint32_t>( name_offsets.size() - 1u );
+    v.num_nodes = static_cast<uint32_t>( nodes.size() );
+    v.num_cuts = static_cast<uint32_t>( cuts.size() );
+    v.num_leaves = static_cast<uint32_t>( leaves.size() );
+    v.num_inputs = static_cast<uint32_t>( inputs.size() );
+    v.num_outputs = static_cast<uint32_t>( outputs.size() );
+    v.num_tt_words = tt_words.size();
+    v.name_offsets = name_offsets.data();
+    v.nodes = nodes.data();
+    v.cuts = cuts.data();
+    v.leaves = leaves.data();
+    v.inputs = inputs.data();
+    v.outputs = outputs.data();
+    v.tt_words = tt_words.data();
+    v.name_chars = name_chars.data();
+    return v;
+  }
+};
+
+namespace detail
+{
+
+inline uint64_t align8( uint64_t offset )
+{
+  return ( offset + 7u ) & ~uint64_t( 7u );
+}
+
+} // namespace detail
+
+/*! \brief Writes a cut database in the binary layout described above. */
+inline bool write_cut_database( cut_database const& db, std::string const& filename )
+{
+  std::ofstream os( filename, std::ios::binary | std::ios::trunc );
+  if ( !os )
+  {
+    return false;
+  }
+
+  cut_database_header header;
+  std::memset( &header, 0, sizeof( header ) );
+  std::memcpy( header.magic, cut_database_magic, sizeof( header.magic ) );
+  header.version = cut_database_version;
+  header.cut_size = db.cut_size;
+  header.cut_limit = db.cut_limit;
+  header.cut_priority = static_cast<uint32_t>( db.priority );
+  header.top_n = db.top_n;
+  header.enumeration = db.enumeration;
+  header.num_names = static_cast<uint32_t>( db.name_offsets.size() - 1u );
+  header.num_nodes = static_cast<uint32_t>( db.nodes.size() );
+  header.num_cuts = static_cast<uint32_t>( db.cuts.size() );
+  header.num_leaves = static_cast<uint32_t>( db.leaves.size() );
+  header.num_inputs = static_cast<uint32_t>( db.inputs.size() );
+  header.num_outputs = static_cast<uint32_t>( db.outputs.size() );
+  header.num_tt_words = db.tt_words.size();
+  header.name_bytes = db.name_chars.size();
+
+  uint64_t const sizes[num_cut_database_sections] = {
+      db.name_offsets.size() * sizeof( uint32_t ),
+      db.nodes.size() * sizeof( node_record ),
+      db.cuts.size() * sizeof( cut_record ),
+      db.leaves.size() * sizeof( uint32_t ),
+      db.inputs.size() * sizeof( uint32_t ),
+      db.outputs.size() * sizeof( uint32_t ),
+      db.tt_words.size() * sizeof( uint64_t ),
+      db.name_chars.size() };
+  char const* data[num_cut_database_sections] = {
+      reinterpret_cast<char const*>( db.name_offsets.data() ),
+      reinterpret_cast<char const*>( db.nodes.data() ),
+      reinterpret_cast<char const*>( db.cuts.data() ),
+      reinterpret_cast<char const*>( db.leaves.data() ),
+      reinterpret_cast<char const*>( db.inputs.data() ),
+      reinterpret_cast<char const*>( db.outputs.data() ),
+      reinterpret_cast<char const*>( db.tt_words.data() ),
+      db.name_chars.data() };
+
+  uint64_t offset = sizeof( cut_database_header );
+  for ( auto s = 0u; s < num_cut_database_sections; ++s )
+  {
+    header.offsets[s] = offset;
+    offset = detail::align8( offset + sizes[s] );
+  }
+
+  static char const padding[8] = {};
+  os.write( reinterpret_cast<char const*>( &header ), sizeof( header ) );
+  uint64_t written = sizeof( cut_database_header );
+  for ( auto s = 0u; s < num_cut_database_sections; ++s )
+  {
+    os.write( data[s], static_cast<std::streamsize>( sizes[s] ) );
+    written += sizes[s];
+    auto const pad = detail::align8( written ) - written;
+    os.write( padding, static_cast<std::streamsize>( pad ) );
+    written += pad;
+  }
+
+  return static_cast<bool>( os );
+}
+
+/*! \brief Returns true if `filename` starts with the binary cut database magic. */
+inline bool is_cut_database_file( std::string const& filename )
+{
+  std::ifstream is( filename, std::ios::binary );
+  char magic[sizeof( cut_database_magic )] = {};
+  is.read( magic, sizeof( magic ) );
+  return is.gcount() == sizeof( magic ) && std::memcmp( magic, cut_database_magic, sizeof( magic ) ) == 0;
+}
+
+/*! \brief Read-only memory mapping of a binary cut database. */
+class mapped_cut_database
+{
+public:
+  mapped_cut_database() = default;
+  mapped_cut_database( mapped_cut_database const& ) = delete;
+  mapped_cut_database& operator=( mapped_cut_database const& ) = delete;
+
+  ~mapped_cut_database()
+  {
+    close();
+  }
+
+  /*! \brief Maps `filename` and validates its header and all cut ranges.
+   *
+   * On failure, returns false and stores a description in `error`.
+   */
+  bool open( std::string const& filename, std::string& error )
+  {
+    close();
+
+    int fd = ::open( filename.c_str(), O_RDONLY );
+    if ( fd < 0 )
+    {
+      error = "cannot open '" + filename + "'";
+      return false;
+    }
+    struct stat st;
+    if ( ::fstat( fd, &st ) != 0 || static_cast<uint64_t>( st.st_size ) < sizeof( cut_database_header ) )
+    {
+      ::close( fd );
+      error = "'" + filename + "' is too small to be a cut database";
+      return false;
+    }
+    _size = static_cast<size_t>( st.st_size );
+    void* addr = ::mmap( nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0 );
+    ::close( fd );
+    if ( addr == MAP_FAILED )
+    {
+      _size = 0;
+      error = "cannot map '" + filename + "'";
+      return false;
+    }
+    _data = static_cast<char const*>( addr );
+
+    if ( !validate( error ) )
+    {
+      close();
+      return false;
+    }
+    return true;
+  }
+
+  void close()
+  {
+    if ( _data != nullptr )
+    {
+      ::munmap( const_cast<char*>( _data ), _size );
+      _data = nullptr;
+      _size = 0;
+    }
+    _view = {};
+  }
+
+  cut_database_view const& view() const
+  {
+    return _view;
+  }
+
+private:
+  bool validate( std::string& error )
+  {
+    cut_database_header header;
+    std::memcpy( &header, _data, sizeof( header ) );
+    if ( std::memcmp( header.magic, cut_database_magic, sizeof( header.magic ) ) != 0 )
+    {
+      error = "bad magic, not a cut database";
+      return false;
+    }
+    if ( header.version != cut_database_version )
+    {
+      error = "unsupported cut database version " + std::to_string( header.version ) +
+              " (expected " + std::to_string( cut_database_version ) + ")";
+      return false;
+    }
+
+    uint64_t const sizes[num_cut_database_sections] = {
+        ( uint64_t( header.num_names ) + 1u ) * sizeof( uint32_t ),
+        uint64_t( header.num_nodes ) * sizeof( node_record ),
+        uint64_t( header.num_cuts ) * sizeof( cut_record ),
+        uint64_t( header.num_leaves ) * sizeof( uint32_t ),
+        uint64_t( header.num_inputs ) * sizeof( uint32_t ),
+        uint64_t( header.num_outputs ) * sizeof( uint32_t ),
+        header.num_tt_words * sizeof( uint64_t ),
+        header.name_bytes };
+    for ( auto s = 0u; s < num_cut_database_sections; ++s )
+    {
+      if ( header.offsets[s] % 8u != 0u || header.offsets[s] > _size || sizes[s] > _size - header.offsets[s] )
+      {
+        error = "truncated or corrupt section " + std::to_string( s );
+        return false;
+      }
+    }
+
+    _view.cut_size = header.cut_size;
+    _view.cut_limit = header.cut_limit;
+    _view.priority = header.cut_priority <= static_cast<uint32_t>( cut_priority::depth ) ? static_cast<cut_priority>( header.cut_priority ) : cut_priority::none;
+    _view.top_n = header.top_n;
+    _view.enumeration = header.enumeration;
+    _view.num_names = header.num_names;
+    _view.num_nodes = header.num_nodes;
+    _view.num_cuts = header.num_cuts;
+    _view.num_leaves = header.num_leaves;
+    _view.num_inputs = header.num_inputs;
+    _view.num_outputs = header.num_outputs;
+    _view.num_tt_words = header.num_tt_words;
+    _view.name_offsets = reinterpret_cast<uint32_t const*>( _data + header.offsets[section_name_offsets] );
+    _view.nodes = reinterpret_cast<node_record const*>( _data + header.offsets[section_nodes] );
+    _view.cuts = reinterpret_cast<cut_record const*>( _data + header.offsets[section_cuts] );
+    _view.leaves = reinterpret_cast<uint32_t const*>( _data + header.offsets[section_leaves] );
+    _view.inputs = reinterpret_cast<uint32_t const*>( _data + header.offsets[section_inputs] );
+    _view.outputs = reinterpret_cast<uint32_t const*>( _data + header.offsets[section_outputs] );
+    _view.tt_words = reinterpret_cast<uint64_t const*>( _data + header.offsets[section_tt_words] );
+    _view.name_chars = _data + header.offsets[section_name_chars];
+
+    /* check every index once so consumers can use the view without bounds checks */
+    for ( auto i = 0u; i < header.num_names; ++i )
+    {
+      if ( _view.name_offsets[i] > _view.name_offsets[i + 1] )
+      {
+        error = "corrupt name table";
+        return false;
+      }
+    }
+    if ( _view.name_offsets[header.num_names] > header.name_bytes )
+    {
+      error = "corrupt name table";
+      return false;
+    }
+    for ( auto i = 0u; i < header.num_nodes; ++i )
+    {
+      auto const& nd = _view.nodes[i];
+      if ( nd.index >= header.num_names || uint64_t( nd.cut_begin ) + nd.num_cuts > header.num_cuts )
+      {
+        error = "corrupt node record " + std::to_string( i );
+        return false;
+      }
+    }
+    for ( auto i = 0u; i < header.num_cuts; ++i )
+    {
+      auto const& cut = _view.cuts[i];
+      if ( uint64_t( cut.leaf_begin ) + cut.num_leaves > header.num_leaves ||
+           cut.num_leaves > 31u ||
+           uint64_t( cut.tt_begin ) + tt_num_words( cut.num_leaves ) > header.num_tt_words )
+      {
+        error = "corrupt cut record " + std::to_string( i );
+        return false;
+      }
+    }
+    for ( auto i = 0u; i < header.num_leaves; ++i )
+    {
+      if ( _view.leaves[i] >= header.num_names )
+      {
+        error = "leaf index out of range";
+        return false;
+      }
+    }
+    for ( auto i = 0u; i < header.num_inputs; ++i )
+    {
+      if ( _view.inputs[i] >= header.num_names )
+      {
+        error = "input index out of range";
+        return false;
+      }
+    }
+    for ( auto i = 0u; i < header.num_outputs; ++i )
+    {
+      if ( _view.outputs[i] >= header.num_names )
+      {
+        error = "output index out of range";
+        return false;
+      }
+    }
+    return true;
+  }
+
+private:
+  char const* _data{ nullptr };
+  size_t _size{ 0 };
+  cut_database_view _view;
+};
+
+} // namespace cpsat
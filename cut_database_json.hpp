@@ -0,0 +1,513 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include "cut_database.hpp"
+
+/* JSON spelling of the cut database, kept for debugging.
+ *
+ *   {
+ *   "cuts_per_node": K, "cut_limit": C, "cut_priority": none|area|inv|depth,
+ *   "top_n": N, "prune_dominated": bool, "windowed": bool, "enumerator": native|mockturtle,
+ *   "inputs": [name, ...], "input_indices": [index, ...],
+ *   "outputs": [name, ...], "output_indices": [index, ...],
+ *   "nodes": [
+ *   {"index": i, "name": n, "signature": hex, "cuts": [{"leaves": [name, ...], "leaf_indices": [index, ...],
+ *                                     "truth_table": hex, "inv_cost": c, "depth_cost": c, "area_cost": c,
+ *                                     "shared_cost": c, "cone_area": c, "cone_depth": c}, ...]},
+ *   ...
+ *   ],
+ *   "forced_nodes": [index, ...], "forced_cuts": [[index, cut], ...], "infeasible_cuts": [[index, cut], ...],
+ *   "level_bounds": [[index, min_level, height], ...], "dropped_nodes": n
+ *   }
+ *
+ * The reduction keys follow the nodes because they are only known once all
+ * nodes are written; files without them have no forced or infeasible entries.
+ * `signature` is the node's structural signature as 16 hex digits; it is
+ * left out when unknown. Files without `enumerator` count as mockturtle's.
+ */
+namespace cpsat
+{
+
+inline std::string signature_to_hex( uint64_t signature )
+{
+  static constexpr char digits[] = "0123456789abcdef";
+  std::string hex( 16u, '0' );
+  for ( auto i = 16u; i-- > 0u; signature >>= 4u )
+  {
+    hex[i] = digits[signature & 0xfu];
+  }
+  return hex;
+}
+
+inline bool signature_from_hex( std::string const& hex, uint64_t& signature )
+{
+  if ( hex.empty() || hex.size() > 16u )
+  {
+    return false;
+  }
+  signature = 0u;
+  for ( auto c : hex )
+  {
+    uint64_t digit;
+    if ( c >= '0' && c <= '9' )
+      digit = c - '0';
+    else if ( c >= 'a' && c <= 'f' )
+      digit = c - 'a' + 10;
+    else if ( c >= 'A' && c <= 'F' )
+      digit = c - 'A' + 10;
+    else
+      return false;
+    signature = ( signature << 4u ) | digit;
+  }
+  return true;
+}
+
+/*! \brief Streams the cuts JSON one node record at a time.
+ *
+ * The top-level keys are written first, then one `{index, name, cuts}` object
+ * per line, so only a single node is ever held as a JSON value.
+ */
+class json_cut_writer
+{
+public:
+  json_cut_writer( std::ostream& os, std::vector<std::string> const& node_names )
+      : _os( os ), _node_names( node_names )
+  {
+  }
+
+  /*! \brief Opens the file with the settings of the cuts; `top_n` and `enumeration` are as in `cut_database`. */
+  void write_header( uint32_t cut_size, uint32_t cut_limit, cut_priority priority, uint32_t top_n, uint32_t enumeration,
+                     std::vector<uint32_t> const& inputs, std::vector<uint32_t> const& outputs )
+  {
+    _os << "{\n\"cuts_per_node\": " << cut_size
+        << ",\n\"cut_limit\": " << cut_limit
+        << ",\n\"cut_priority\": \"" << cut_priority_name( priority ) << "\""
+        << ",\n\"top_n\": " << top_n
+        << ",\n\"prune_dominated\": " << ( ( enumeration & enumeration_pruned_dominated ) ? "true" : "false" )
+        << ",\n\"windowed\": " << ( ( enumeration & enumeration_windowed ) ? "true" : "false" )
+        << ",\n\"enumerator\": \"" << ( ( enumeration & enumeration_native ) ? "native" : "mockturtle" ) << "\""
+        << ",\n\"inputs\": " << names_of( inputs ).dump()
+        << ",\n\"input_indices\": " << nlohmann::json( inputs ).dump()
+        << ",\n\"outputs\": " << names_of( outputs ).dump()
+        << ",\n\"output_indices\": " << nlohmann::json( outputs ).dump()
+        << ",\n\"nodes\": [";
+  }
+
+  /*! \brief Writes `signatures[index]` with every node from now on; `signatures` must outlive the writer. */
+  void set_signatures( std::vector<uint64_t> const& signatures )
+  {
+    _signatures = &signatures;
+  }
+
+  void begin_node( uint32_t index )
+  {
+    _node = nlohmann::json::object();
+    _node["index"] = index;
+    _node["name"] = _node_names[index];
+    if ( _signatures != nullptr && index < _signatures->size() && ( *_signatures )[index] != 0u )
+    {
+      _node["signature"] = signature_to_hex( ( *_signatures )[index] );
+    }
+    _cuts = nlohmann::json::array();
+  }
+
+  template<typename LeafIt, typename WordIt>
+  void add_cut( LeafIt leaves_begin, LeafIt leaves_end, WordIt tt_begin, uint32_t inv_cost, uint32_t area_cost, uint32_t depth_cost,
+                uint32_t shared_cost, uint32_t cone_area, uint32_t cone_depth )
+  {
+    nlohmann::json leaves = nlohmann::json::array();
+    nlohmann::json leaf_indices = nlohmann::json::array();
+    for ( auto it = leaves_begin; it != leaves_end; ++it )
+    {
+      leaves.push_back( _node_names[*it] );
+      leaf_indices.push_back( *it );
+    }
+
+    nlohmann::json cut_obj;
+    cut_obj["truth_table"] = tt_to_hex( tt_begin, static_cast<uint32_t>( leaves.size() ) );
+    cut_obj["leaves"] = std::move( leaves );
+    cut_obj["leaf_indices"] = std::move( leaf_indices );
+    cut_obj["inv_cost"] = inv_cost;
+    cut_obj["depth_cost"] = depth_cost;
+    cut_obj["area_cost"] = area_cost;
+    cut_obj["shared_cost"] = shared_cost;
+    cut_obj["cone_area"] = cone_area;
+    cut_obj["cone_depth"] = cone_depth;
+    _cuts.push_back( std::move( cut_obj ) );
+  }
+
+  void end_node()
+  {
+    _node["cuts"] = std::move( _cuts );
+    _os << ( _first_node ? "\n" : ",\n" ) << _node.dump();
+    _first_node = false;
+  }
+
+  void write_footer()
+  {
+    _os << "\n]\n}" << std::endl;
+  }
+
+  /*! \brief Closes the node list and writes the reduction keys. */
+  void write_footer( model_reduction const& reduction )
+  {
+    _os << "\n],\n\"forced_nodes\": " << nlohmann::json( reduction.forced_nodes ).dump()
+        << ",\n\"forced_cuts\": " << nlohmann::json( reduction.forced_cuts ).dump()
+        << ",\n\"infeasible_cuts\": " << nlohmann::json( reduction.infeasible_cuts ).dump()
+        << ",\n\"level_bounds\": " << nlohmann::json( reduction.level_bounds ).dump()
+        << ",\n\"dropped_nodes\": " << reduction.dropped_nodes
+        << "\n}" << std::endl;
+  }
+
+private:
+  nlohmann::json names_of( std::vector<uint32_t> const& indices ) const
+  {
+    nlohmann::json names = nlohmann::json::array();
+    for ( auto idx : indices )
+    {
+      names.push_back( _node_names[idx] );
+    }
+    return names;
+  }
+
+private:
+  std::ostream& _os;
+  std::vector<std::string> const& _node_names;
+  nlohmann::json _node;
+  nlohmann::json _cuts;
+  std::vector<uint64_t> const* _signatures{ nullptr };
+  bool _first_node{ true };
+};
+
+/*! \brief Reads a cuts JSON written by `json_cut_writer` into a `cut_database`.
+ *
+ * Names are known only for indices that appear in the file; the name table is
+ * sized to the largest such index. On failure, returns false and stores a
+ * description in `error`.
+ */
+inline bool read_cut_database_json( std::istream& is, cut_database& db, std::string& error )
+{
+  nlohmann::json j;
+  try
+  {
+    is >> j;
+  }
+  catch ( nlohmann::json::exception const& e )
+  {
+    error = e.what();
+    return false;
+  }
+
+  if ( !j.contains( "cuts_per_node" ) || !j.contains( "nodes" ) )
+  {
+    error = "missing required fields";
+    return false;
+  }
+
+  std::vector<std::string> names;
+  auto set_name = [&]( uint32_t index, std::string const& name ) {
+    if ( index >= names.size() )
+    {
+      names.resize( index + 1u );
+    }
+    names[index] = name;
+  };
+
+  try
+  {
+    db = {};
+    db.cut_size = j["cuts_per_node"].get<uint32_t>();
+    db.cut_limit = j.value( "cut_limit", 0u );
+    if ( !parse_cut_priority( j.value( "cut_priority", std::string( "none" ) ), db.priority ) )
+    {
+      error = "unknown 'cut_priority'";
+      return false;
+    }
+    db.top_n = j.value( "top_n", 0u );
+    db.enumeration = ( j.value( "prune_dominated", false ) ? enumeration_pruned_dominated : 0u ) |
+                     ( j.value( "windowed", false ) ? enumeration_windowed : 0u ) |
+                     ( j.value( "enumerator", std::string( "mockturtle" ) ) == "native" ? enumeration_native : 0u );
+
+    auto read_terminals = [&]( char const* key_names, char const* key_indices, std::vector<uint32_t>& target ) {
+      if ( !j.contains( key_indices ) )
+      {
+        error = std::string( "missing '" ) + key_indices + "'; regenerate the cuts with this cut_enumeration";
+        return false;
+      }
+      target = j[key_indices].get<std::vector<uint32_t>>();
+      auto const& list = j[key_names];
+      if ( list.size() != target.size() )
+      {
+        error = std::string( "'" ) + key_names + "' and '" + key_indices + "' differ in length";
+        return false;
+      }
+      for ( auto i = 0u; i < target.size(); ++i )
+      {
+        set_name( target[i], list[i].get<std::string>() );
+      }
+      return true;
+    };
+    if ( !read_terminals( "inputs", "input_indices", db.inputs ) ||
+         !read_terminals( "outputs", "output_indices", db.outputs ) )
+    {
+      return false;
+    }
+
+    std::vector<uint64_t> words;
+    for ( auto const& nd : j["nodes"] )
+    {
+      auto const index = nd["index"].get<uint32_t>();
+      set_name( index, nd["name"].get<std::string>() );
+      db.begin_node( index );
+      if ( nd.contains( "signature" ) && !signature_from_hex( nd["signature"].get<std::string>(), db.nodes.back().signature ) )
+      {
+        error = "malformed signature in node " + std::to_string( index );
+        return false;
+      }
+      for ( auto const& cut : nd["cuts"] )
+      {
+        if ( !cut.contains( "leaf_indices" ) || !cut.contains( "truth_table" ) )
+        {
+          error = "cut of node " + std::to_string( index ) + " has no leaf_indices/truth_table; regenerate the cuts with this cut_enumeration";
+          return false;
+        }
+        auto const leaf_indices = cut["leaf_indices"].get<std::vector<uint32_t>>();
+        auto const& leaves = cut["leaves"];
+        for ( auto i = 0u; i < leaf_indices.size() && i < leaves.size(); ++i )
+        {
+          set_name( leaf_indices[i], leaves[i].get<std::string>() );
+        }
+
+        auto const num_vars = static_cast<uint32_t>( leaf_indices.size() );
+        words.assign( tt_num_words( num_vars ), 0u );
+        if ( !tt_from_hex( cut["truth_table"].get<std::string>(), num_vars, words.begin() ) )
+        {
+          error = "malformed truth table in node " + std::to_string( index );
+          return false;
+        }
+        auto const area_cost = cut.value( "area_cost", num_vars );
+        auto const depth_cost = cut.value( "depth_cost", 1u );
+        db.add_cut( leaf_indices.begin(), leaf_indices.end(), words.begin(),
+                    cut.value( "inv_cost", 0u ),
+                    area_cost,
+                    depth_cost,
+                    cut.value( "shared_cost", 0u ),
+                    cut.value( "cone_area", area_cost ),
+                    cut.value( "cone_depth", depth_cost ) );
+      }
+      db.end_node();
+    }
+
+    model_reduction reduction;
+    reduction.forced_nodes = j.value( "forced_nodes", std::vector<uint32_t>{} );
+    reduction.forced_cuts = j.value( "forced_cuts", std::vector<std::pair<uint32_t, uint32_t>>{} );
+    reduction.infeasible_cuts = j.value( "infeasible_cuts", std::vector<std::pair<uint32_t, uint32_t>>{} );
+    reduction.level_bounds = j.value( "level_bounds", std::vector<std::tuple<uint32_t, uint32_t, uint32_t>>{} );
+    if ( !db.mark_reduction( reduction ) )
+    {
+      error = "'forced_nodes', 'forced_cuts', 'infeasible_cuts' or 'level_bounds' names a node or cut that is not in 'nodes'";
+      return false;
+    }
+  }
+  catch ( nlohmann::json::exception const& e )
+  {
+    error = e.what();
+    return false;
+  }
+
+  for ( auto const& name : names )
+  {
+    db.add_name( name );
+  }
+  return true;
+}
+
+/*! \brief Writes an in-memory cut database through `json_cut_writer`, as cut_enumeration streams it. */
+inline bool write_cut_database_json( cut_database const& db, std::string const& filename )
+{
+  auto const v = db.view();
+  std::vector<std::string> node_names( v.num_names );
+  for ( auto i = 0u; i < v.num_names; ++i )
+  {
+    node_names[i] = std::string( v.name( i ) );
+  }
+
+  std::ofstream os( filename );
+  json_cut_writer writer( os, node_names );
+  writer.write_header( db.cut_size, db.cut_limit, db.priority, db.top_n, db.enumeration, db.inputs, db.outputs );
+  std::vector<uint64_t> signatures( v.num_names, 0u );
+  for ( auto i = 0u; i < v.num_nodes; ++i )
+  {
+    signatures[v.nodes[i].index] = v.nodes[i].signature;
+  }
+  writer.set_signatures( signatures );
+  for ( auto i = 0u; i < v.num_nodes; ++i )
+  {
+    writer.begin_node( v.nodes[i].index );
+    for ( auto cut = v.cuts_begin( v.nodes[i] ); cut != v.cuts_end( v.nodes[i] ); ++cut )
+    {
+      writer.add_cut( v.leaves_begin( *cut ), v.leaves_end( *cut ), v.tt_begin( *cut ),
+                      cut->inv_cost, cut->area_cost, cut->depth_cost, cut->shared_cost, cut->cone_area, cut->cone_depth );
+    }
+    writer.end_node();
+  }
+  writer.write_footer( stored_reduction( v ) );
+  return static_cast<bool>( os );
+}
+
+/*! \brief Writes `{"chosen_cuts": {name: cut_index}, "chosen_cut_indices": [[node_index, cut_index], ...]}` as main_cpsat.py does.
+ *
+ * `chosen_cut` is indexed by node index; entries equal to `unused` are skipped.
+ * The index pairs are sorted by node index; the names are kept for readers
+ * that do not know the index form. Keys of `extra` (e.g. solver status) are
+ * written next to `chosen_cuts`.
+ */
+inline void write_chosen_cuts_json( std::ostream& os, cut_database_view const& db, std::vector<uint32_t> const& chosen_cut, uint32_t unused,
+                                    nlohmann::json const& extra = nlohmann::json::object() )
+{
+  nlohmann::json chosen = nlohmann::json::object();
+  std::vector<std::pair<uint32_t, uint32_t>> pairs;
+  for ( auto i = 0u; i < db.num_nodes; ++i )
+  {
+    auto const idx = db.nodes[i].index;
+    if ( idx < chosen_cut.size() && chosen_cut[idx] != unused )
+    {
+      chosen[std::string( db.name( idx ) )] = chosen_cut[idx];
+      pairs.emplace_back( idx, chosen_cut[idx] );
+    }
+  }
+  std::sort( pairs.begin(), pairs.end() );
+  nlohmann::json j = extra;
+  j["chosen_cuts"] = std::move( chosen );
+  j["chosen_cut_indices"] = pairs;
+  os << j.dump( 2 ) << std::endl;
+}
+
+/*! \brief Adds the chosen cuts of `chosen_json_path`, which refer to the cuts of `db`, to `chosen_cut`; the inverse of `write_chosen_cuts_json`.
+ *
+ * Index pairs are used when present, names otherwise. Entries of unknown
+ * nodes are skipped with a warning on stderr. If `open_nodes` is given, it
+ * receives the `open_node_indices` of an ECO hint: nodes the hint does not
+ * decide.
+ */
+inline bool read_chosen_cuts_json( std::string const& chosen_json_path, cut_database_view const& db, std::vector<uint32_t>& chosen_cut,
+                                   std::vector<uint32_t>* open_nodes = nullptr )
+{
+  nlohmann::json chosen_json;
+  {
+    std::ifstream chosen_stream( chosen_json_path );
+    if ( !chosen_stream )
+    {
+      std::cerr << "Cannot open chosen cuts JSON '" << chosen_json_path << "'\n";
+      return false;
+    }
+    chosen_stream >> chosen_json;
+  }
+
+  bool const indexed = chosen_json.contains( "chosen_cut_indices" ) && chosen_json["chosen_cut_indices"].is_array();
+  if ( !indexed && ( !chosen_json.contains( "chosen_cuts" ) || !chosen_json["chosen_cuts"].is_object() ) )
+  {
+    std::cerr << "Invalid chosen cuts JSON: missing 'chosen_cut_indices' array or 'chosen_cuts' object\n";
+    return false;
+  }
+
+  if ( indexed )
+  {
+    // [node_index, cut_index] pairs refer to the node indices of the cut file
+    for ( auto const& pair : chosen_json["chosen_cut_indices"] )
+    {
+      if ( !pair.is_array() || pair.size() != 2u || !pair[0].is_number_unsigned() || !pair[1].is_number_unsigned() )
+      {
+        std::cerr << "Invalid chosen cuts JSON: malformed entry " << pair.dump() << " in 'chosen_cut_indices'\n";
+        return false;
+      }
+      auto const idx = pair[0].get<uint32_t>();
+      if ( idx >= chosen_cut.size() )
+      {
+        std::cerr << "Warning: chosen cut references unknown node index " << idx << "\n";
+        continue;
+      }
+      chosen_cut[idx] = pair[1].get<uint32_t>();
+    }
+  }
+  else
+  {
+    // chosen cuts are keyed by the node names of the cut file
+    node_name_index name_to_index( db );
+    for ( auto it = chosen_json["chosen_cuts"].begin(); it != chosen_json["chosen_cuts"].end(); ++it )
+    {
+      auto const idx = name_to_index.find( it.key() );
+      if ( idx == node_name_index::npos || idx >= chosen_cut.size() )
+      {
+        std::cerr << "Warning: chosen cut references unknown node '" << it.key() << "'\n";
+        continue;
+      }
+      chosen_cut[idx] = it.value().get<uint32_t>();
+    }
+  }
+
+  if ( open_nodes != nullptr )
+  {
+    open_nodes->clear();
+    if ( chosen_json.contains( "open_node_indices" ) )
+    {
+      *open_nodes = chosen_json["open_node_indices"].get<std::vector<uint32_t>>();
+    }
+  }
+  return true;
+}
+
+/*! \brief Cut file of either format: binary files are mapped, JSON files are parsed into memory. */
+class loaded_cut_database
+{
+public:
+  bool load( std::string const& filename, std::string& error )
+  {
+    if ( is_cut_database_file( filename ) )
+    {
+      if ( !_mapped.open( filename, error ) )
+      {
+        return false;
+      }
+      _view = _mapped.view();
+      return true;
+    }
+
+    std::ifstream is( filename );
+    if ( !is )
+    {
+      error = "cannot open '" + filename + "'";
+      return false;
+    }
+    if ( !read_cut_database_json( is, _owned, error ) )
+    {
+      return false;
+    }
+    _view = _owned.view();
+    return true;
+  }
+
+  cut_database_view const& view() const
+  {
+    return _view;
+  }
+
+private:
+  mapped_cut_database _mapped;
+  cut_database _owned;
+  cut_database_view _view;
+};
+
+} // namespace cpsat
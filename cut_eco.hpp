@@ -0,0 +1,278 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "cut_database.hpp"
+#include "cut_rebuild.hpp"
+#include "parallel_cut_enumeration.hpp"
+
+/* ECO mode of cut_enumeration (`--eco-base`): re-run after a small netlist
+ * change without enumerating the unchanged logic again.
+ *
+ * Node names other than PI names are derived from node indices, which shift
+ * with every edit, so nodes are matched by a structural signature instead: a
+ * PI hashes its name, a constant its value, and a gate its function and the
+ * signatures of its fanins in order. Two nodes with the same signature have
+ * the same transitive fanin, so the cuts of a matched node in the base
+ * database, renumbered, are K-feasible cuts of the node with the same
+ * functions. They are a valid cut set, not necessarily the one a fresh
+ * enumeration would give: cut sets are truncated to `cut_limit` by size and
+ * leaf indices, and indices shift with every edit. Every matched node copies
+ * its cuts and only the unmatched ones, the fanout cone of the edit plus new
+ * logic, are enumerated. The solver can then keep the base cover on the
+ * matched nodes (`translate_cover`).
+ *
+ * Structurally identical gates share a signature, which then does not tell
+ * which of them a cut leaf stands for; such signatures are not matched, so
+ * the fanout of these gates is enumerated again.
+ */
+namespace cpsat
+{
+
+namespace detail
+{
+
+inline uint64_t signature_mix( uint64_t h, uint64_t v )
+{
+  h ^= v + 0x9e3779b97f4a7c15u + ( h << 6u ) + ( h >> 2u );
+  h ^= h >> 30u;
+  h *= 0xbf58476d1ce4e5b9u;
+  h ^= h >> 27u;
+  h *= 0x94d049bb133111ebu;
+  return h ^ ( h >> 31u );
+}
+
+inline uint64_t name_signature( uint64_t tag, std::string_view name )
+{
+  auto h = signature_mix( 0u, tag );
+  for ( auto c : name )
+  {
+    h = signature_mix( h, static_cast<unsigned char>( c ) );
+  }
+  return signature_mix( h, name.size() );
+}
+
+constexpr uint64_t pi_signature_tag = 1u;
+constexpr uint64_t constant_signature_tag = 2u;
+constexpr uint64_t gate_signature_tag = 3u;
+
+} // namespace detail
+
+/*! \brief Structural signature per node index of `ntk`; `names` are the exported node names (`cut_exporter::node_names`). */
+template<class Ntk>
+std::vector<uint64_t> structural_signatures( Ntk const& ntk, std::vector<std::string> const& names )
+{
+  std::vector<uint64_t> signatures( ntk.size(), 0u );
+  ntk.foreach_node( [&]( auto const& n ) {
+    auto const idx = ntk.node_to_index( n );
+    if ( ntk.is_constant( n ) )
+    {
+      signatures[idx] = detail::name_signature( detail::constant_signature_tag, names[idx] );
+      return;
+    }
+    if ( ntk.is_pi( n ) )
+    {
+      signatures[idx] = detail::name_signature( detail::pi_signature_tag, names[idx] );
+      return;
+    }
+    auto const& function = ntk.node_function( n );
+    auto h = detail::signature_mix( detail::gate_signature_tag, function.num_vars() );
+    for ( auto word = function.cbegin(); word != function.cend(); ++word )
+    {
+      h = detail::signature_mix( h, *word );
+    }
+    ntk.foreach_fanin( n, [&]( auto const& f ) {
+      h = detail::signature_mix( h, signatures[ntk.node_to_index( ntk.get_node( f ) )] );
+    } );
+    signatures[idx] = h == 0u ? 1u : h;
+  } );
+  return signatures;
+}
+
+struct eco_plan
+{
+  reused_cuts reuse;
+
+  /*! \brief Gates of the current network that are enumerated again. */
+  uint32_t changed_nodes{ 0u };
+
+  /*! \brief Gates whose cuts are copied from the base database. */
+  uint32_t reused_nodes{ 0u };
+
+  /*! \brief False if the base database stores no signatures, so nothing can be reused. */
+  bool base_has_signatures{ true };
+};
+
+/*! \brief Matches the gates of `ntk` against the exported nodes of `base`.
+ *
+ * Nodes are matched one to one: a signature is only used if exactly one node
+ * of `ntk` and one node of `base` have it. A gate is reused if it is matched
+ * and all leaves of the base cuts map to nodes of `ntk` below it, in the same
+ * order. Inputs and constants of `base` get their signatures from their names.
+ */
+template<class Ntk>
+eco_plan plan_eco( Ntk const& ntk, std::vector<uint64_t> const& signatures, cut_database_view const& base )
+{
+  constexpr auto none = reused_cuts::no_source;
+  eco_plan plan;
+  plan.reuse.db = base;
+  plan.reuse.source.assign( ntk.size(), none );
+  plan.reuse.leaf_map.assign( base.num_names, none );
+
+  std::unordered_map<uint64_t, uint32_t> current;
+  current.reserve( signatures.size() );
+  for ( auto idx = 0u; idx < signatures.size(); ++idx )
+  {
+    auto const it = current.emplace( signatures[idx], idx ).first;
+    if ( it->second != idx )
+    {
+      it->second = none; // shared by several nodes
+    }
+  }
+
+  // base names with their signatures: inputs and constants from their names, nodes as stored
+  std::vector<std::pair<uint32_t, uint64_t>> base_signatures;
+  std::vector<bool> is_input( base.num_names, false );
+  for ( auto i = 0u; i < base.num_inputs; ++i )
+  {
+    is_input[base.inputs[i]] = true;
+    base_signatures.emplace_back( base.inputs[i], detail::name_signature( detail::pi_signature_tag, base.name( base.inputs[i] ) ) );
+  }
+  std::vector<bool> is_node( base.num_names, false );
+  for ( auto i = 0u; i < base.num_nodes; ++i )
+  {
+    is_node[base.nodes[i].index] = true;
+    plan.base_has_signatures = plan.base_has_signatures && base.nodes[i].signature != 0u;
+    base_signatures.emplace_back( base.nodes[i].index, base.nodes[i].signature );
+  }
+  // the remaining leaves are constants, named "const<index>" by cut_exporter
+  for ( auto idx = 0u; idx < base.num_names; ++idx )
+  {
+    if ( !is_input[idx] && !is_node[idx] && !base.name( idx ).empty() )
+    {
+      base_signatures.emplace_back( idx, detail::name_signature( detail::constant_signature_tag, base.name( idx ) ) );
+    }
+  }
+
+  std::unordered_map<uint64_t, uint32_t> base_uses;
+  base_uses.reserve( base_signatures.size() );
+  for ( auto const& entry : base_signatures )
+  {
+    ++base_uses[entry.second];
+  }
+  for ( auto const& [old_idx, signature] : base_signatures )
+  {
+    auto const it = current.find( signature );
+    if ( signature != 0u && it != current.end() && it->second != none && base_uses[signature] == 1u )
+    {
+      plan.reuse.leaf_map[old_idx] = it->second;
+    }
+  }
+
+  for ( auto i = 0u; i < base.num_nodes; ++i )
+  {
+    auto const& nd = base.nodes[i];
+    auto const idx = plan.reuse.leaf_map[nd.index];
+    if ( idx == none || plan.reuse.source[idx] != none )
+    {
+      continue;
+    }
+    auto const n = ntk.index_to_node( idx );
+    if ( ntk.is_constant( n ) || ntk.is_pi( n ) )
+    {
+      continue;
+    }
+    bool usable = true;
+    for ( auto cut = base.cuts_begin( nd ); usable && cut != base.cuts_end( nd ); ++cut )
+    {
+      uint32_t previous = 0u;
+      for ( auto leaf = base.leaves_begin( *cut ); leaf != base.leaves_end( *cut ); ++leaf )
+      {
+        auto const mapped = plan.reuse.leaf_map[*leaf];
+        bool const self = cut->num_leaves == 1u && *leaf == nd.index;
+        if ( mapped == none || ( mapped >= idx && !self ) || ( leaf != base.leaves_begin( *cut ) && mapped <= previous ) )
+        {
+          usable = false;
+          break;
+        }
+        previous = mapped;
+      }
+    }
+    if ( usable )
+    {
+      plan.reuse.source[idx] = i;
+    }
+  }
+
+  ntk.foreach_gate( [&]( auto const& n ) {
+    if ( plan.reuse.source[ntk.node_to_index( n )] != none )
+      ++plan.reused_nodes;
+    else
+      ++plan.changed_nodes;
+  } );
+  return plan;
+}
+
+/*! \brief Translates the base cover `base_chosen` (per base node index) into cut positions of `db`, the new database.
+ *
+ * Reused nodes keep their base cut if `db` still has a cut with the mapped
+ * leaves; `chosen` (per node index of `db`) is `no_chosen_cut` for nodes the
+ * base cover does not use. All other nodes are listed in `open_nodes` and
+ * left to the solver.
+ */
+inline void translate_cover( eco_plan const& plan, std::vector<uint32_t> const& base_chosen, cut_database_view const& db,
+                             std::vector<uint32_t>& chosen, std::vector<uint32_t>& open_nodes )
+{
+  auto const& base = plan.reuse.db;
+  chosen.assign( db.num_names, no_chosen_cut );
+  open_nodes.clear();
+  std::vector<uint32_t> leaves;
+  for ( auto i = 0u; i < db.num_nodes; ++i )
+  {
+    auto const& nd = db.nodes[i];
+    auto const source = nd.index < plan.reuse.source.size() ? plan.reuse.source[nd.index] : reused_cuts::no_source;
+    if ( source == reused_cuts::no_source )
+    {
+      open_nodes.push_back( nd.index );
+      continue;
+    }
+    auto const& old_nd = base.nodes[source];
+    auto const old_cut = old_nd.index < base_chosen.size() ? base_chosen[old_nd.index] : no_chosen_cut;
+    if ( old_cut == no_chosen_cut )
+    {
+      continue;
+    }
+    if ( old_cut >= old_nd.num_cuts )
+    {
+      open_nodes.push_back( nd.index );
+      continue;
+    }
+    auto const& cut = base.cuts[old_nd.cut_begin + old_cut];
+    leaves.clear();
+    for ( auto leaf = base.leaves_begin( cut ); leaf != base.leaves_end( cut ); ++leaf )
+    {
+      leaves.push_back( plan.reuse.leaf_map[*leaf] );
+    }
+    for ( auto c = 0u; c < nd.num_cuts; ++c )
+    {
+      auto const& new_cut = db.cuts[nd.cut_begin + c];
+      if ( std::equal( db.leaves_begin( new_cut ), db.leaves_end( new_cut ), leaves.begin(), leaves.end() ) )
+      {
+        chosen[nd.index] = c;
+        break;
+      }
+    }
+    if ( chosen[nd.index] == no_chosen_cut )
+    {
+      open_nodes.push_back( nd.index );
+    }
+  }
+}
+
+} // namespace cpsat
@@ -1,201 +1,1147 @@
 #include <algorithm>
+#include <chrono>
 #include <cstdlib>
+#include <filesystem>
 #include <fstream>
 #include <iostream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <sstream>
 #include <string>
+#include <type_traits>
 #include <vector>
 
 #include <mockturtle/networks/klut.hpp>
 #include <mockturtle/views/names_view.hpp>
-#include <mockturtle/views/fanout_view.hpp>
-#include <mockturtle/io/blif_reader.hpp>
 #include <mockturtle/algorithms/cut_enumeration.hpp>
 
-#include <kitty/dynamic_truth_table.hpp>
-#include <kitty/operations.hpp>
-
-#include <lorina/blif.hpp>
-#include <nlohmann/json.hpp>
+#include "blif_loader.hpp"
+#include "cut_cache.hpp"
+#include "cut_cover.hpp"
+#include "cut_database.hpp"
+#include "cut_database_json.hpp"
+#include "cut_eco.hpp"
+#include "cut_export.hpp"
+#include "cut_service.hpp"
+#include "cut_windows.hpp"
+#include "parallel_cut_enumeration.hpp"
+#include "thread_pool.hpp"
+#include "tool_stats.hpp"
 
 namespace
 {
-uint32_t compute_inv_cost( kitty::dynamic_truth_table const& tt )
+
+struct enumeration_settings
+{
+  std::string format; /* empty: by output extension */
+  int cut_size{ 4 };
+  int threads{ -1 }; /* -1: sequential mockturtle enumeration */
+  cpsat::cut_pruning_params pruning;
+  uint32_t cut_limit{ cpsat::default_cut_limit };
+  cpsat::cut_priority priority{ cpsat::cut_priority::none };
+  std::string cache_dir; /* empty: no cut cache */
+  uint32_t window_size{ 0u }; /* 0: one cut file for the whole network */
+  std::optional<cpsat::cover_objective> hint_cover; /* unset: no hint file */
+  std::string eco_base;   /* empty: no ECO mode */
+  std::string eco_chosen; /* empty: no ECO hint */
+};
+
+/*! \brief Every setting that changes the exported cuts except the file format, as a cache key part. */
+std::string cut_settings( enumeration_settings const& es )
+{
+  return "K=" + std::to_string( es.cut_size ) + ";C=" + std::to_string( es.cut_limit ) +
+         ";priority=" + cpsat::cut_priority_name( es.priority ) +
+         ";dominated=" + std::to_string( es.pruning.prune_dominated ) +
+         ";top_n=" + std::to_string( es.pruning.top_n ) + ":" + es.pruning.top_n_objective +
+         ";enumerator=" + ( es.threads < 0 ? "mockturtle" : "parallel" );
+}
+
+/*! \brief Writes a greedy cover of `db` as a chosen cuts JSON with status `HINT` (`main_cpsat.py --hint`, `cpsat_solve --hint`). */
+bool write_hint( cpsat::cut_database_view const& db, std::string const& hint_file, cpsat::cover_objective objective, std::ostream& log,
+                 cpsat::tool_stats* stats )
+{
+  if ( stats )
+  {
+    stats->begin_phase( "hint" );
+  }
+  auto const cover = cpsat::greedy_cover( db, objective );
+  std::ofstream os( hint_file );
+  nlohmann::json extra;
+  extra["status"] = "HINT";
+  extra["cover"] = cpsat::cover_objective_name( objective );
+  extra["area"] = cover.area;
+  extra["depth"] = cover.depth;
+  extra["complete"] = cover.complete;
+  cpsat::write_chosen_cuts_json( os, db, cover.chosen_cut, cpsat::no_chosen_cut, extra );
+  if ( !os )
+  {
+    log << "Error writing hint '" << hint_file << "'\n";
+    return false;
+  }
+  log << "[info] Wrote " << cpsat::cover_objective_name( objective ) << " cover hint of " << cover.nodes << " nodes (area "
+      << cover.area << ", depth " << cover.depth << ( cover.complete ? "" : ", partial" ) << ") to " << hint_file << "\n";
+  if ( stats )
+  {
+    stats->end_phase();
+    stats->set( "hint_area", cover.area );
+    stats->set( "hint_depth", cover.depth );
+  }
+  return true;
+}
+
+/*! \brief Writes the cover `base_chosen_file` of the ECO base, translated to `db`, as a chosen cuts JSON with status `ECO`.
+ *
+ * Nodes without a translated cut are listed under `open_node_indices`; the
+ * solvers leave them unhinted (and unfixed with `--fix-hint`).
+ */
+bool write_eco_hint( cpsat::eco_plan const& plan, std::string const& base_chosen_file, cpsat::cut_database_view const& db,
+                     std::string const& hint_file, std::ostream& log, cpsat::tool_stats* stats )
+{
+  if ( stats )
+  {
+    stats->begin_phase( "eco_hint" );
+  }
+  std::vector<uint32_t> base_chosen( plan.reuse.db.num_names, cpsat::no_chosen_cut );
+  if ( !cpsat::read_chosen_cuts_json( base_chosen_file, plan.reuse.db, base_chosen ) )
+  {
+    return false;
+  }
+  std::vector<uint32_t> chosen, open_nodes;
+  cpsat::translate_cover( plan, base_chosen, db, chosen, open_nodes );
+  auto const kept = db.num_nodes - static_cast<uint32_t>( open_nodes.size() );
+
+  std::ofstream os( hint_file );
+  nlohmann::json extra;
+  extra["status"] = "ECO";
+  extra["open_node_indices"] = open_nodes;
+  cpsat::write_chosen_cuts_json( os, db, chosen, cpsat::no_chosen_cut, extra );
+  if ( !os )
+  {
+    log << "Error writing ECO hint '" << hint_file << "'\n";
+    return false;
+  }
+  log << "[info] Wrote ECO hint keeping the base cover on " << kept << " nodes, " << open_nodes.size() << " open, to "
+      << hint_file << "\n";
+  if ( stats )
+  {
+    stats->end_phase();
+    stats->set( "eco_open_nodes", static_cast<uint64_t>( open_nodes.size() ) );
+  }
+  return true;
+}
+
+/*! \brief Writes one cut file per window of `db` next to `out_file` and the manifest `<stem>_windows.json`.
+ *
+ * Window `k` goes to `<stem>_w<k><ext>`; the manifest names
+ * `<stem>_w<k>_chosen_cuts.json` as the place for its solution.
+ */
+template<class Ntk>
+bool write_windows( Ntk const& ntk, cpsat::cut_database const& db, std::string const& out_file, bool binary_output, uint32_t window_size,
+                    std::ostream& log, cpsat::tool_stats* stats )
 {
-  uint32_t cost = 0;
-  const auto num_vars = tt.num_vars();
-  for ( unsigned var = 0; var < num_vars; ++var )
+  std::filesystem::path const out_path( out_file );
+  auto const dir = out_path.parent_path();
+  auto const stem = out_path.stem().string();
+  auto const view = db.view();
+  cpsat::cut_windows windows( ntk, view, window_size );
+
+  cpsat::window_manifest manifest;
+  manifest.window_size = window_size;
+  manifest.outputs = db.outputs;
+  for ( auto o : db.outputs )
   {
-    auto tt0 = kitty::cofactor0( tt, var );
-    auto tt1 = kitty::cofactor1( tt, var );
-    auto bad_pos = tt0 & ~tt1;
-    auto bad_neg = tt1 & ~tt0;
-    if ( !kitty::is_const0( bad_pos ) && !kitty::is_const0( bad_neg ) )
+    manifest.output_names.emplace_back( view.name( o ) );
+  }
+  uint64_t dropped_cuts = 0u;
+  uint64_t bytes_written = 0u;
+  for ( auto w = 0u; w < windows.num_windows(); ++w )
+  {
+    auto const window_db = windows.database( w, dropped_cuts );
+    auto const name = stem + "_w" + std::to_string( w );
+    auto const file = ( dir / ( name + ( binary_output ? ".cdb" : ".json" ) ) ).string();
+    bool const written = binary_output ? cpsat::write_cut_database( window_db, file ) : cpsat::write_cut_database_json( window_db, file );
+    if ( !written )
     {
-      ++cost;
+      log << "Error writing window cut file '" << file << "'\n";
+      return false;
     }
+    bytes_written += cpsat::file_bytes( file );
+
+    cpsat::window_entry entry;
+    entry.cuts = std::filesystem::path( file ).filename().string();
+    entry.chosen = name + "_chosen_cuts.json";
+    entry.nodes = static_cast<uint32_t>( window_db.nodes.size() );
+    entry.cuts_count = static_cast<uint32_t>( window_db.cuts.size() );
+    entry.inputs = static_cast<uint32_t>( window_db.inputs.size() );
+    entry.outputs = static_cast<uint32_t>( window_db.outputs.size() );
+    manifest.windows.push_back( std::move( entry ) );
   }
-  return cost;
+
+  auto const manifest_file = ( dir / ( stem + "_windows.json" ) ).string();
+  if ( !cpsat::write_window_manifest( manifest, manifest_file ) )
+  {
+    log << "Error writing window manifest '" << manifest_file << "'\n";
+    return false;
+  }
+  log << "[info] Wrote " << manifest.windows.size() << " windows of up to " << window_size << " nodes ("
+      << windows.num_boundary_signals() << " boundary signals, " << dropped_cuts << " cuts crossing a boundary dropped) to "
+      << manifest_file << "\n";
+  if ( stats )
+  {
+    stats->end_phase();
+    stats->set( "windows", static_cast<uint64_t>( manifest.windows.size() ) );
+    stats->set( "boundary_signals", windows.num_boundary_signals() );
+    stats->set( "window_dropped_cuts", dropped_cuts );
+    stats->set( "bytes_written", bytes_written + cpsat::file_bytes( manifest_file ) );
+  }
+  return true;
 }
-} // namespace
 
-int main( int argc, char** argv )
+/*! \brief Enumerates the cuts of `blif_file` into `out_file`; progress goes to `log`.
+ *
+ * With `es.window_size`, the cuts are split into window files next to
+ * `out_file` (see `write_windows`) and `out_file` itself is not written.
+ *
+ * With `es.hint_cover`, a greedy cover of the exported cuts is written to
+ * `hint_file` as well (see `write_hint`).
+ *
+ * With `es.eco_base`, gates whose structure is unchanged since that cut file
+ * take their cuts from it and only the others are enumerated (cut_eco.hpp);
+ * with `es.eco_chosen` as well, the base cover is translated to the new cuts
+ * and written to `eco_hint_file` (see `write_eco_hint`).
+ *
+ * With `stats`, phase times and the counts of the exported cuts are recorded
+ * there. The export phase of a JSON file covers the cost computation, the
+ * JSON encoding and the writes, which are interleaved node by node.
+ *
+ * The server passes the already parsed `network` of `blif_file`, and `keep`
+ * to get the exported database back (the JSON is then written from it, as
+ * with hints); `keep` stays empty on a cut cache hit or with windows.
+ */
+bool enumerate_file( std::string const& blif_file, std::string const& out_file, enumeration_settings const& es, std::ostream& log,
+                     cpsat::tool_stats* stats = nullptr, std::string const& hint_file = {}, std::string const& eco_hint_file = {},
+                     mockturtle::names_view<mockturtle::klut_network> const* network = nullptr, cpsat::cut_database* keep = nullptr )
 {
-  constexpr uint32_t kCutLimit = 32;
   using namespace mockturtle;
 
-  if ( argc < 3 )
+  auto begin_phase = [&]( char const* name ) {
+    if ( stats )
+      stats->begin_phase( name );
+  };
+  auto report_output = [&]() {
+    if ( stats )
+    {
+      stats->end_phase();
+      stats->set( "bytes_written", cpsat::file_bytes( out_file ) );
+    }
+  };
+
+  auto const K = es.cut_size;
+  auto pruning = es.pruning;
+
+  // Binary output is selected explicitly or by the .cdb extension
+  auto format = es.format;
+  if ( format.empty() )
   {
-    std::cerr << "Usage: cut_enumeration <input.blif> <output.json> [K]\n";
-    return 1;
+    auto const ext_pos = out_file.rfind( '.' );
+    format = ( ext_pos != std::string::npos && out_file.substr( ext_pos ) == ".cdb" ) ? "binary" : "json";
   }
+  bool const binary_output = format == "binary";
 
-  std::string const blif_file  = argv[1];
-  std::string const json_file  = argv[2];
-  int K = 4;
-  if ( argc >= 4 )
+  // 0. Reuse a cut file of the same BLIF and settings from the cache
+  std::optional<cpsat::cut_cache> cache;
+  std::string cache_key;
+  std::string const cache_ext = binary_output ? ".cdb" : ".json";
+  if ( !es.cache_dir.empty() && es.window_size > 0u )
+  {
+    log << "[warn] The cut cache stores single cut files; not used with --window-size\n";
+  }
+  else if ( !es.cache_dir.empty() && !es.eco_base.empty() )
   {
-    K = std::atoi( argv[3] );
-    if ( K <= 0 ) K = 4;
+    log << "[warn] ECO results depend on the base cut file; the cut cache is not used with --eco-base\n";
   }
+  else if ( !es.cache_dir.empty() )
+  {
+    begin_phase( "cache_lookup" );
+    std::string const settings = cut_settings( es ) + ";format=" + format;
+    if ( auto const key = cpsat::cut_cache_key( blif_file, settings ) )
+    {
+      cache.emplace( es.cache_dir );
+      cache_key = *key;
+      if ( cache->fetch( cache_key, cache_ext, out_file ) )
+      {
+        log << "[info] Cut cache hit " << cache_key << cache_ext << " -> " << out_file << "\n";
+        if ( stats )
+        {
+          stats->set( "cache_hit", true );
+        }
+        report_output();
+        if ( es.hint_cover )
+        {
+          cpsat::loaded_cut_database cached;
+          std::string error;
+          if ( !cached.load( out_file, error ) )
+          {
+            log << "Error reading cached cut file '" << out_file << "': " << error << "\n";
+            return false;
+          }
+          return write_hint( cached.view(), hint_file, *es.hint_cover, log, stats );
+        }
+        return true;
+      }
+      log << "[info] Cut cache miss " << cache_key << cache_ext << "\n";
+    }
+  }
+  auto store_in_cache = [&]() {
+    if ( cache && !cache->store( cache_key, cache_ext, out_file ) )
+    {
+      log << "[warn] Could not add '" << out_file << "' to the cut cache in " << es.cache_dir << "\n";
+    }
+  };
 
-  // 1. Read BLIF into KLUT network
+  // 1. Read BLIF into KLUT network, unless the server has it parsed already
   klut_network klut;
-  names_view<klut_network> ntk{ klut };
-
+  names_view<klut_network> loaded{ klut };
+  if ( network == nullptr )
   {
-    blif_reader reader( ntk );
-    auto result = lorina::read_blif( blif_file, reader );
-    if ( result != lorina::return_code::success )
+    begin_phase( "read_blif" );
+    if ( !cpsat::read_blif_file( blif_file, loaded, es.threads < 0 ? 0u : static_cast<uint32_t>( es.threads ) ) )
     {
-      std::cerr << "Error reading BLIF\n";
-      return 1;
+      return false;
     }
   }
+  auto const& ntk = network ? *network : loaded;
 
-  fanout_view<names_view<klut_network>> fntk{ ntk };
+  log << "[info] PIs=" << ntk.num_pis()
+      << " POs=" << ntk.num_pos()
+      << " nodes=" << ntk.size()
+      << "  K=" << K << " C=" << es.cut_limit
+      << " priority=" << cpsat::cut_priority_name( es.priority ) << "\n";
+  if ( stats )
+  {
+    stats->set( "pis", ntk.num_pis() );
+    stats->set( "pos", ntk.num_pos() );
+    stats->set( "network_nodes", ntk.size() );
+  }
+
+  // names, inputs and outputs (real POs, or fanout-0 nodes as a fallback)
+  cpsat::cut_exporter<names_view<klut_network>> exporter( ntk );
+  auto const signatures = cpsat::structural_signatures( ntk, exporter.node_names() );
 
-  std::cerr << "[info] PIs=" << ntk.num_pis()
-            << " POs=" << ntk.num_pos()
-            << " nodes=" << ntk.size()
-            << "  K=" << K << "\n";
+  // ECO base: the cut file of the previous netlist, matched by structural signatures
+  cpsat::loaded_cut_database base;
+  std::optional<cpsat::eco_plan> eco;
+  if ( !es.eco_base.empty() )
+  {
+    begin_phase( "eco_match" );
+    std::error_code ec;
+    if ( std::filesystem::equivalent( es.eco_base, out_file, ec ) )
+    {
+      log << "Error: the ECO base '" << es.eco_base << "' is the output file; copy it first\n";
+      return false;
+    }
+    std::string error;
+    if ( !base.load( es.eco_base, error ) )
+    {
+      log << "Error reading ECO base '" << es.eco_base << "': " << error << "\n";
+      return false;
+    }
+    auto const base_view = base.view();
+    if ( base_view.cut_size != static_cast<uint32_t>( K ) || base_view.cut_limit != es.cut_limit || base_view.priority != es.priority )
+    {
+      log << "Error: the ECO base was enumerated with K=" << base_view.cut_size << " C=" << base_view.cut_limit
+          << " priority=" << cpsat::cut_priority_name( base_view.priority ) << "; use the same settings\n";
+      return false;
+    }
+    // reused cut sets must be complete: unpruned, from the native enumerator
+    if ( !( base_view.enumeration & cpsat::enumeration_native ) || base_view.top_n > 0u ||
+         ( base_view.enumeration & ( cpsat::enumeration_pruned_dominated | cpsat::enumeration_windowed ) ) )
+    {
+      log << "Error: the ECO base holds pruned, windowed or mockturtle-enumerated cuts; write it with --threads "
+             "and without --cut-priority, --prune-dominated, --top-n and --window-size\n";
+      return false;
+    }
+    eco.emplace( cpsat::plan_eco( ntk, signatures, base_view ) );
+    if ( !eco->base_has_signatures )
+    {
+      log << "[warn] The ECO base has nodes without signatures; those are enumerated again\n";
+    }
+    log << "[info] ECO: " << eco->changed_nodes << " gates changed or new, " << eco->reused_nodes << " reused from "
+        << es.eco_base << "\n";
+    if ( stats )
+    {
+      stats->set( "eco_changed_nodes", eco->changed_nodes );
+      stats->set( "eco_reused_nodes", eco->reused_nodes );
+    }
+  }
 
-  // 2. Cut enumeration
+  // 2. Cut enumeration: mockturtle's sequential one, or level-parallel with --threads (always in ECO mode)
+  begin_phase( "enumerate" );
   cut_enumeration_params ps;
   ps.cut_size = K;
-  ps.cut_limit = kCutLimit;
-  auto cut_res = cut_enumeration<names_view<klut_network>, true>( ntk, ps );
-
-  nlohmann::json j;
-  j["nodes"] = nlohmann::json::array();
-  j["outputs"] = nlohmann::json::array();
-  j["cuts_per_node"] = ps.cut_size;
-
-  // 3. Name each node; mark PIs
-  std::vector<std::string> node_names( ntk.size() );
-  std::vector<bool> is_pi( ntk.size(), false );
-
-  ntk.foreach_pi( [&]( auto const& s, auto /*index*/ ){
-    auto n   = ntk.get_node( s );
-    auto idx = ntk.node_to_index( n );
-    auto name = ntk.get_name( s );  // e.g. opcode[0]
-    node_names[idx] = name;
-    is_pi[idx] = true;
-  } );
+  ps.cut_limit = cpsat::enumeration_cut_limit( es.cut_limit, es.priority );
+  cpsat::apply_cut_priority( pruning, es.cut_limit, es.priority );
+  std::optional<network_cuts<names_view<klut_network>, true>> cut_res;
+  std::optional<cpsat::parallel_network_cuts<names_view<klut_network>>> parallel_res;
+  if ( es.threads < 0 )
+  {
+    cut_res.emplace( cut_enumeration<names_view<klut_network>, true>( ntk, ps ) );
+  }
+  else
+  {
+    cpsat::parallel_cut_params pps;
+    pps.cut_size = ps.cut_size;
+    pps.cut_limit = ps.cut_limit;
+    pps.num_threads = static_cast<uint32_t>( es.threads );
+    if ( eco )
+      parallel_res.emplace( ntk, pps, eco->reuse );
+    else
+      parallel_res.emplace( ntk, pps );
+    log << "[info] Enumerated " << parallel_res->num_levels() << " levels on "
+        << parallel_res->num_threads() << " threads\n";
+  }
+
+  // 3. Export through pruning, reduction and stats; the cut file records the pruning and the enumerator for ECO runs
+  auto const enumeration = cpsat::enumeration_of( parallel_res.has_value(), pruning );
+  begin_phase( "export" );
+  log << "[info] Exporting " << exporter.outputs().size() << " outputs\n";
 
-  ntk.foreach_node( [&]( auto n ){
-    auto idx = ntk.node_to_index( n );
-    if ( node_names[idx].empty() )
+  auto export_cuts = [&]( auto& sink ) {
+    if ( parallel_res )
+      parallel_res->export_nodes( sink );
+    else
+      exporter.export_nodes( *cut_res, sink );
+  };
+  auto export_nodes = [&]( auto& sink ) {
+    if ( !pruning.enabled() )
     {
-      if ( ntk.is_constant( n ) )
-      {
-        node_names[idx] = "const" + std::to_string( idx );
-      }
-      else
-      {
-        node_names[idx] = "n" + std::to_string( idx );
-      }
+      export_cuts( sink );
+      return;
     }
-  } );
+    cpsat::pruning_cut_sink<std::decay_t<decltype( sink )>> pruned( sink, pruning );
+    export_cuts( pruned );
+    log << "[info] Pruned " << pruned.num_pruned() << " cuts\n";
+    if ( stats )
+    {
+      stats->set( "pruned_cuts", pruned.num_pruned() );
+    }
+  };
+  auto const reachable = exporter.reachable_nodes();
+  auto export_reduced = [&]( auto& sink ) {
+    cpsat::reducing_cut_sink<std::decay_t<decltype( sink )>> reduced( sink, reachable, exporter.outputs() );
+    export_nodes( reduced );
+    auto reduction = reduced.finish();
+    log << "[info] Dropped " << reduction.dropped_nodes << " unreachable nodes; forced "
+        << reduction.forced_nodes.size() << " nodes and " << reduction.forced_cuts.size() << " cuts, "
+        << reduction.infeasible_cuts.size() << " cuts infeasible\n";
+    if ( stats )
+    {
+      stats->set( "dropped_nodes", reduction.dropped_nodes );
+      stats->set( "forced_nodes", static_cast<uint64_t>( reduction.forced_nodes.size() ) );
+      stats->set( "forced_cuts", static_cast<uint64_t>( reduction.forced_cuts.size() ) );
+      stats->set( "infeasible_cuts", static_cast<uint64_t>( reduction.infeasible_cuts.size() ) );
+    }
+    return reduction;
+  };
+  auto export_counted = [&]( auto& sink ) {
+    if ( !stats )
+    {
+      return export_reduced( sink );
+    }
+    cpsat::stats_cut_sink<std::decay_t<decltype( sink )>> counted( sink );
+    auto reduction = export_reduced( counted );
+    counted.report( *stats );
+    return reduction;
+  };
+  auto export_marked = [&]( cpsat::cut_database& db ) {
+    if ( db.mark_reduction( export_counted( db ) ) )
+    {
+      return true;
+    }
+    log << "Error: the model reduction of '" << blif_file << "' names a node or cut that was not exported\n";
+    return false;
+  };
 
-  // 4. Try to use real POs
-  uint32_t po_count = ntk.num_pos();
-  if ( po_count > 0 )
+  // 4. Export internal nodes and their cuts
+  bool const eco_hint = eco && !es.eco_chosen.empty();
+  auto write_hints = [&]( cpsat::cut_database_view const& v ) {
+    if ( es.hint_cover && !write_hint( v, hint_file, *es.hint_cover, log, stats ) )
+    {
+      return false;
+    }
+    return !eco_hint || write_eco_hint( *eco, es.eco_chosen, v, eco_hint_file, log, stats );
+  };
+  if ( es.window_size > 0u )
   {
-    ntk.foreach_po( [&]( auto const& s, auto index ){
-      auto n   = ntk.get_node( s );
-      auto idx = ntk.node_to_index( n );
-      auto name = node_names[idx];
-      j["outputs"].push_back( name );
-    } );
+    if ( es.hint_cover || eco_hint )
+    {
+      log << "[warn] Hints cover the whole network; not written with --window-size\n";
+    }
+    auto db = exporter.empty_database( ps.cut_size, es.cut_limit, es.priority, pruning.top_n, enumeration );
+    if ( !export_marked( db ) )
+    {
+      return false;
+    }
+    db.set_signatures( signatures );
+    begin_phase( "write" );
+    return write_windows( ntk, db, out_file, binary_output, es.window_size, log, stats );
   }
-  else
+  if ( binary_output )
+  {
+    auto db = exporter.empty_database( ps.cut_size, es.cut_limit, es.priority, pruning.top_n, enumeration );
+    if ( !export_marked( db ) )
+    {
+      return false;
+    }
+    db.set_signatures( signatures );
+    begin_phase( "write" );
+    if ( !cpsat::write_cut_database( db, out_file ) )
+    {
+      log << "Error writing cut database '" << out_file << "'\n";
+      return false;
+    }
+    log << "[info] Wrote " << db.cuts.size() << " cuts of " << db.nodes.size()
+        << " nodes to " << out_file << "\n";
+    report_output();
+    store_in_cache();
+    bool const ok = write_hints( db.view() );
+    if ( keep )
+      *keep = std::move( db );
+    return ok;
+  }
+  if ( es.hint_cover || eco_hint || keep )
   {
-    // 5. Fallback: no POs in network → treat fanout-0 nodes (incl. PIs) as outputs
-    std::cerr << "[warn] Network has 0 POs. Using fanout-0 nodes as outputs.\n";
+    // hints need the cuts in memory; write the JSON from the database instead of streaming it
+    auto db = exporter.empty_database( ps.cut_size, es.cut_limit, es.priority, pruning.top_n, enumeration );
+    if ( !export_marked( db ) )
+    {
+      return false;
+    }
+    db.set_signatures( signatures );
+    if ( !cpsat::write_cut_database_json( db, out_file ) )
+    {
+      log << "Error writing cuts JSON '" << out_file << "'\n";
+      return false;
+    }
+    report_output();
+    store_in_cache();
+    bool const ok = write_hints( db.view() );
+    if ( keep )
+      *keep = std::move( db );
+    return ok;
+  }
 
-    fntk.foreach_node( [&]( auto n ){
-      if ( fntk.is_constant( n ) ) return;
+  std::ofstream ofs( out_file );
+  if ( !ofs )
+  {
+    log << "Error writing cuts JSON '" << out_file << "'\n";
+    return false;
+  }
+  cpsat::json_cut_writer writer( ofs, exporter.node_names() );
+  writer.set_signatures( signatures );
+  writer.write_header( ps.cut_size, es.cut_limit, es.priority, pruning.top_n, enumeration, exporter.inputs(), exporter.outputs() );
+  writer.write_footer( export_counted( writer ) );
 
-      auto idx = fntk.node_to_index( n );
+  if ( !ofs )
+  {
+    log << "Error writing cuts JSON '" << out_file << "'\n";
+    return false;
+  }
+  ofs.close();
+  report_output();
+  store_in_cache();
+  return true;
+}
 
-      // We *include* PIs now as possible outputs, so no is_pi[idx] check here.
-      if ( fntk.fanout_size( n ) == 0 )
+/*! \brief BLIF files of a batch: the `.blif` files of a directory, or the lines of a list file.
+ *
+ * Blank lines and lines starting with `#` are skipped; relative paths in a
+ * list are taken relative to the list file.
+ */
+bool collect_batch_files( std::filesystem::path const& input, std::vector<std::filesystem::path>& files )
+{
+  if ( std::filesystem::is_directory( input ) )
+  {
+    for ( auto const& entry : std::filesystem::directory_iterator( input ) )
+    {
+      if ( entry.is_regular_file() && entry.path().extension() == ".blif" )
       {
-        auto const& name = node_names[idx];
-        j["outputs"].push_back( name );
-        std::cerr << "[OUT] fanout-0 idx=" << idx
-                  << " name=" << name << "\n";
+        files.push_back( entry.path() );
       }
-    } );
+    }
+    std::sort( files.begin(), files.end() );
+    return true;
+  }
 
+  std::ifstream is( input );
+  if ( !is )
+  {
+    std::cerr << "Error reading batch list '" << input.string() << "'\n";
+    return false;
   }
+  std::string line;
+  while ( std::getline( is, line ) )
+  {
+    auto const b = line.find_first_not_of( " \t\r" );
+    if ( b == std::string::npos || line[b] == '#' )
+    {
+      continue;
+    }
+    auto const e = line.find_last_not_of( " \t\r" );
+    std::filesystem::path file = line.substr( b, e - b + 1 );
+    files.push_back( file.is_absolute() ? file : input.parent_path() / file );
+  }
+  return true;
+}
 
-  std::cerr << "[info] Exporting " << j["outputs"].size() << " outputs\n";
+/*! \brief Enumerates every file of a batch into `out_dir` on `jobs` worker threads.
+ *
+ * Each worker owns one network at a time, so at most `jobs` networks and cut
+ * sets are in memory. A file's log is printed in one piece when it finishes.
+ * The stats file holds one stats object per file; their peak RSS is the
+ * process-wide value at the end of that file.
+ */
+int run_batch( std::filesystem::path const& input, std::filesystem::path const& out_dir, uint32_t jobs,
+               std::string const& report_file, std::string const& stats_file, enumeration_settings const& es )
+{
+  std::vector<std::filesystem::path> files;
+  if ( !collect_batch_files( input, files ) )
+  {
+    return 1;
+  }
 
-  // 6. Export internal nodes and their cuts
-  ntk.foreach_node( [&]( auto n ){
-    if ( ntk.is_constant( n ) )
-      return;
+  std::set<std::string> stems;
+  for ( auto const& file : files )
+  {
+    if ( !stems.insert( file.stem().string() ).second )
+    {
+      std::cerr << "Error: batch has two files named '" << file.stem().string() << "'\n";
+      return 1;
+    }
+  }
+
+  std::error_code ec;
+  std::filesystem::create_directories( out_dir, ec );
+  if ( ec )
+  {
+    std::cerr << "Error creating output directory '" << out_dir.string() << "'\n";
+    return 1;
+  }
 
-    auto idx = ntk.node_to_index( n );
-    if ( is_pi[idx] )
-      return; // PIs are only leaves
+  std::string const extension = es.format == "binary" ? ".cdb" : ".json";
+  jobs = std::min( cpsat::resolve_num_threads( jobs ), std::max<uint32_t>( static_cast<uint32_t>( files.size() ), 1u ) );
+  std::cerr << "[info] Batch of " << files.size() << " BLIF files on " << jobs << " jobs\n";
 
-    nlohmann::json nd;
-    nd["index"] = idx;
-    nd["name"]  = node_names[idx];
+  std::vector<double> seconds( files.size(), 0.0 );
+  std::vector<char> ok( files.size(), 0 );
+  std::vector<cpsat::tool_stats> file_stats( files.size(), cpsat::tool_stats( "cut_enumeration" ) );
+  std::vector<nlohmann::ordered_json> stats_json( files.size() );
+  std::mutex log_mutex;
+  cpsat::thread_pool pool( jobs );
+  pool.parallel_for(
+      static_cast<uint32_t>( files.size() ),
+      [&]( uint32_t, uint32_t i ) {
+        auto const out_file = out_dir / ( files[i].stem().string() + "_cuts" + extension );
+        std::ostringstream log;
+        auto const start = std::chrono::steady_clock::now();
+        auto const hint_file = out_dir / ( files[i].stem().string() + "_hint.json" );
+        ok[i] = enumerate_file( files[i].string(), out_file.string(), es, log, stats_file.empty() ? nullptr : &file_stats[i],
+                                hint_file.string() );
+        if ( !stats_file.empty() )
+        {
+          file_stats[i].set( "ok", static_cast<bool>( ok[i] ) );
+          stats_json[i] = file_stats[i].to_json();
+          stats_json[i]["file"] = files[i].string();
+        }
+        seconds[i] = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
 
-    nlohmann::json cuts_json = nlohmann::json::array();
-    auto const& cuts_for_node = cut_res.cuts( n );
+        std::lock_guard<std::mutex> lock( log_mutex );
+        std::cerr << "[" << files[i].stem().string() << "] " << ( ok[i] ? "done" : "FAILED" ) << " in "
+                  << seconds[i] << "s\n"
+                  << log.str();
+      },
+      1u );
 
-    for ( auto it_cut = cuts_for_node.begin(); it_cut != cuts_for_node.end(); ++it_cut )
+  uint32_t failures = 0u;
+  for ( auto const o : ok )
+  {
+    failures += o ? 0u : 1u;
+  }
+  if ( !report_file.empty() )
+  {
+    std::ofstream os( report_file );
+    os << "file,seconds,status\n";
+    for ( auto i = 0u; i < files.size(); ++i )
+    {
+      os << files[i].string() << "," << seconds[i] << "," << ( ok[i] ? "ok" : "failed" ) << "\n";
+    }
+    if ( !os )
+    {
+      std::cerr << "[warn] Could not write batch report '" << report_file << "'\n";
+    }
+  }
+  if ( !stats_file.empty() )
+  {
+    std::ofstream os( stats_file );
+    os << nlohmann::ordered_json{ { "tool", "cut_enumeration" }, { "files", stats_json } }.dump( 2 ) << "\n";
+    if ( !os )
     {
-      auto const& cut = **it_cut;
+      std::cerr << "[warn] Could not write stats '" << stats_file << "'\n";
+    }
+  }
+  std::cerr << "[info] Batch finished: " << ( files.size() - failures ) << " ok, " << failures << " failed\n";
+  return failures == 0u ? 0 : 2;
+}
+
+/*! \brief Parsed network or exported cut database held by the server's cache. */
+struct served_entry
+{
+  mockturtle::names_view<mockturtle::klut_network> network;
+  cpsat::cut_database db;
+};
 
-      nlohmann::json leaves = nlohmann::json::array();
-      for ( auto const& leaf_node : cut )
+/*! \brief Rough heap bytes of a parsed network: its nodes, fanins and truth tables, and the names (bounded by the BLIF size). */
+uint64_t network_bytes( mockturtle::names_view<mockturtle::klut_network> const& ntk, uint64_t blif_bytes )
+{
+  uint64_t bytes = blif_bytes + 64u * ntk.size();
+  ntk.foreach_gate( [&]( auto const& n ) {
+    bytes += 8u * ntk.fanin_size( n ) + 8u * cpsat::tt_num_words( ntk.fanin_size( n ) );
+  } );
+  return bytes;
+}
+
+/*! \brief Settings of one server request: the server's defaults overridden by the request fields. */
+bool parse_request( nlohmann::json const& req, enumeration_settings& es, std::string& design, std::string& output,
+                    std::string& hint_out, std::string& error )
+{
+  try
+  {
+    design = req.value( "design", std::string() );
+    output = req.value( "output", std::string() );
+    hint_out = req.value( "hint_out", std::string() );
+    es.cut_size = req.value( "k", es.cut_size );
+    es.cut_limit = std::max( 2u, req.value( "cut_limit", es.cut_limit ) );
+    es.threads = req.value( "threads", es.threads );
+    es.format = req.value( "format", es.format );
+    es.pruning.prune_dominated = req.value( "prune_dominated", es.pruning.prune_dominated );
+    es.pruning.top_n = req.value( "top_n", es.pruning.top_n );
+    es.pruning.top_n_objective = req.value( "top_n_objective", es.pruning.top_n_objective );
+    if ( req.contains( "priority" ) && !cpsat::parse_cut_priority( req["priority"].get<std::string>(), es.priority ) )
+    {
+      error = "unknown priority";
+      return false;
+    }
+    if ( req.contains( "hint_cover" ) )
+    {
+      cpsat::cover_objective objective;
+      if ( !cpsat::parse_cover_objective( req["hint_cover"].get<std::string>(), objective ) )
       {
-        auto leaf_idx = ntk.node_to_index( leaf_node );
-        leaves.push_back( node_names[leaf_idx] );
+        error = "unknown hint_cover";
+        return false;
       }
+      es.hint_cover = objective;
+    }
+  }
+  catch ( nlohmann::json::exception const& e )
+  {
+    error = e.what();
+    return false;
+  }
+  if ( es.cut_size <= 0 || ( !es.format.empty() && es.format != "json" && es.format != "binary" ) ||
+       !cpsat::is_known_pruning_objective( es.pruning.top_n_objective ) )
+  {
+    error = "invalid k, format or top_n_objective";
+    return false;
+  }
+  if ( design.empty() || output.empty() )
+  {
+    error = "'design' and 'output' are required";
+    return false;
+  }
+  if ( es.hint_cover && hint_out.empty() )
+  {
+    error = "'hint_cover' needs 'hint_out'";
+    return false;
+  }
+  if ( req.contains( "window_size" ) || req.contains( "eco_base" ) )
+  {
+    error = "windows and ECO runs are not served; run cut_enumeration directly";
+    return false;
+  }
+  return true;
+}
 
-      auto tt = cut_res.truth_table( cut );
-      auto inv_cost = compute_inv_cost( tt );
+/*! \brief Long-running cut enumeration (`--serve`): answers JSON request lines until `shutdown` or end of input.
+ *
+ * A request names a `design` and an `output` file and may override K, the
+ * cut limit, priority, pruning, format, threads and the hint cover; see the
+ * README for the fields. Parsed networks (keyed by path, size and mtime) and
+ * exported databases (keyed by network and `cut_settings`) share one LRU
+ * cache of `budget_bytes`. A cached database is only written to `output`; a
+ * tmpfs path such as /dev/shm keeps that in memory, and both readers map
+ * binary files. Requests come from stdin, answers go to
+ * stdout, or both go over the Unix socket `socket_path`; logs go to stderr.
+ */
+int run_server( std::string const& socket_path, uint64_t budget_bytes, enumeration_settings const& defaults )
+{
+  using namespace mockturtle;
 
-      nlohmann::json cut_obj;
-      cut_obj["leaves"] = leaves;
-      cut_obj["inv_cost"] = inv_cost;
-      cut_obj["depth_cost"] = 1;
-      cut_obj["area_cost"] = static_cast<uint32_t>( leaves.size() );
-      cuts_json.push_back( std::move( cut_obj ) );
+  cpsat::lru_cache<served_entry> cache( budget_bytes );
+  cpsat::unix_socket_server server;
+  if ( !socket_path.empty() )
+  {
+    std::string error;
+    if ( !server.listen( socket_path, error ) )
+    {
+      std::cerr << "Error listening on '" << socket_path << "': " << error << "\n";
+      return 1;
     }
+  }
+  std::cerr << "[info] Serving on " << ( socket_path.empty() ? "stdin" : socket_path ) << " with a cache of "
+            << ( budget_bytes >> 20u ) << " MB\n";
 
-    nd["cuts"] = cuts_json;
-    j["nodes"].push_back( nd );
-  } );
+  auto read_line = [&]( std::string& line ) {
+    return socket_path.empty() ? static_cast<bool>( std::getline( std::cin, line ) ) : server.read_line( line );
+  };
+  auto write_line = [&]( nlohmann::json const& response ) {
+    if ( socket_path.empty() )
+      std::cout << response.dump() << std::endl;
+    else
+      server.write_line( response.dump() );
+  };
 
-  std::ofstream ofs( json_file );
-  ofs << j.dump( 2 ) << std::endl;
+  uint64_t num_requests = 0u, network_hits = 0u, cut_hits = 0u;
+  std::string line;
+  while ( read_line( line ) )
+  {
+    if ( line.find_first_not_of( " \t\r" ) == std::string::npos )
+    {
+      continue;
+    }
+    ++num_requests;
+    auto const start = std::chrono::steady_clock::now();
+    nlohmann::json response;
+    auto fail = [&]( std::string const& error ) {
+      response["ok"] = false;
+      response["error"] = error;
+    };
 
+    auto const req = nlohmann::json::parse( line, nullptr, false );
+    bool const valid = req.is_object() && ( !req.contains( "cmd" ) || req["cmd"].is_string() );
+    auto const cmd = !valid ? std::string() : req.contains( "cmd" ) ? req["cmd"].get<std::string>() : std::string( "enumerate" );
+    if ( !valid )
+    {
+      fail( "request is not a JSON object with a string 'cmd'" );
+    }
+    else if ( cmd == "shutdown" )
+    {
+      response["ok"] = true;
+      write_line( response );
+      break;
+    }
+    else if ( cmd == "clear" )
+    {
+      cache.clear();
+      response["ok"] = true;
+    }
+    else if ( cmd == "stats" )
+    {
+      response["ok"] = true;
+    }
+    else if ( cmd != "enumerate" )
+    {
+      fail( "unknown cmd '" + cmd + "'" );
+    }
+    else
+    {
+      auto es = defaults;
+      std::string design, output, hint_out, error;
+      std::optional<std::string> key;
+      if ( !parse_request( req, es, design, output, hint_out, error ) )
+      {
+        fail( error );
+      }
+      else if ( !( key = cpsat::network_key( design ) ) )
+      {
+        fail( "cannot read design '" + design + "'" );
+      }
+      else
+      {
+        auto format = es.format;
+        if ( format.empty() )
+        {
+          format = std::filesystem::path( output ).extension() == ".cdb" ? "binary" : "json";
+        }
+        std::ostringstream log;
+        std::string const cuts_key = "cuts|" + *key + "|" + cut_settings( es );
+        auto cuts = cache.find( cuts_key );
+        bool ok = true;
+        if ( cuts )
+        {
+          ++cut_hits;
+          response["cuts_cache"] = "hit";
+          auto const& db = cuts->db;
+          ok = format == "binary" ? cpsat::write_cut_database( db, output ) : cpsat::write_cut_database_json( db, output );
+          if ( !ok )
+            log << "Error writing '" << output << "'\n";
+          else if ( es.hint_cover )
+            ok = write_hint( db.view(), hint_out, *es.hint_cover, log, nullptr );
+        }
+        else
+        {
+          response["cuts_cache"] = "miss";
+          auto network = cache.find( "network|" + *key );
+          if ( network )
+          {
+            ++network_hits;
+            response["network_cache"] = "hit";
+          }
+          else
+          {
+            response["network_cache"] = "miss";
+            auto entry = std::make_shared<served_entry>();
+            ok = cpsat::read_blif_file( design, entry->network, es.threads < 0 ? 0u : static_cast<uint32_t>( es.threads ) );
+            if ( ok )
+            {
+              auto const bytes = network_bytes( entry->network, cpsat::file_bytes( design ) );
+              network = cache.insert( "network|" + *key, std::move( entry ), bytes );
+            }
+          }
+          if ( ok )
+          {
+            auto entry = std::make_shared<served_entry>();
+            es.format = format;
+            ok = enumerate_file( design, output, es, log, nullptr, hint_out, {}, &network->network, &entry->db );
+            if ( ok && entry->db.cut_size != 0u )
+            {
+              entry->db.tt_index.clear(); // only needed while interning
+              auto const bytes = cpsat::cut_database_bytes( entry->db );
+              cuts = cache.insert( cuts_key, std::move( entry ), bytes );
+            }
+          }
+        }
+        std::cerr << log.str();
+        if ( ok )
+        {
+          response["ok"] = true;
+          response["output"] = output;
+          if ( cuts )
+          {
+            response["nodes"] = cuts->db.nodes.size();
+            response["cuts"] = cuts->db.cuts.size();
+          }
+        }
+        else
+        {
+          fail( "enumeration of '" + design + "' failed, see the server log" );
+        }
+      }
+    }
+
+    response["seconds"] = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+    response["cache"] = { { "bytes", cache.bytes() },
+                          { "entries", cache.size() },
+                          { "evictions", cache.evictions() },
+                          { "requests", num_requests },
+                          { "network_hits", network_hits },
+                          { "cuts_hits", cut_hits } };
+    write_line( response );
+  }
   return 0;
 }
+
+} // namespace
+
+int main( int argc, char** argv )
+{
+  std::vector<std::string> positional;
+  enumeration_settings es;
+  bool known_priority = true;
+  std::string batch_input; /* empty: single file */
+  uint32_t jobs = 0u;
+  std::string report_file;
+  std::string stats_file; /* empty: no --stats-json */
+  std::string hint_file;  /* empty: <output stem>_hint.json */
+  std::string eco_hint_file; /* empty: <output stem>_eco_hint.json */
+  bool known_cover = true;
+  bool serve = false;
+  std::string socket_path;      /* empty: requests on stdin */
+  uint64_t cache_memory_mb = 4096u;
+  for ( int i = 1; i < argc; ++i )
+  {
+    std::string const arg = argv[i];
+    if ( arg == "--format" && i + 1 < argc )
+    {
+      es.format = argv[++i];
+    }
+    else if ( arg == "--threads" && i + 1 < argc )
+    {
+      es.threads = std::max( 0, std::atoi( argv[++i] ) );
+    }
+    else if ( arg == "--cut-limit" && i + 1 < argc )
+    {
+      es.cut_limit = static_cast<uint32_t>( std::max( 2, std::atoi( argv[++i] ) ) );
+    }
+    else if ( arg == "--cut-priority" && i + 1 < argc )
+    {
+      known_priority = cpsat::parse_cut_priority( argv[++i], es.priority );
+    }
+    else if ( arg == "--prune-dominated" )
+    {
+      es.pruning.prune_dominated = true;
+    }
+    else if ( arg == "--top-n" && i + 1 < argc )
+    {
+      es.pruning.top_n = static_cast<uint32_t>( std::max( 0, std::atoi( argv[++i] ) ) );
+    }
+    else if ( arg == "--top-n-objective" && i + 1 < argc )
+    {
+      es.pruning.top_n_objective = argv[++i];
+    }
+    else if ( arg == "--window-size" && i + 1 < argc )
+    {
+      es.window_size = static_cast<uint32_t>( std::max( 0, std::atoi( argv[++i] ) ) );
+    }
+    else if ( arg == "--hint-cover" && i + 1 < argc )
+    {
+      cpsat::cover_objective objective;
+      known_cover = cpsat::parse_cover_objective( argv[++i], objective );
+      es.hint_cover = objective;
+    }
+    else if ( arg == "--hint-out" && i + 1 < argc )
+    {
+      hint_file = argv[++i];
+      if ( !es.hint_cover )
+      {
+        es.hint_cover = cpsat::cover_objective::area;
+      }
+    }
+    else if ( arg == "--eco-base" && i + 1 < argc )
+    {
+      es.eco_base = argv[++i];
+    }
+    else if ( arg == "--eco-chosen" && i + 1 < argc )
+    {
+      es.eco_chosen = argv[++i];
+    }
+    else if ( arg == "--eco-hint-out" && i + 1 < argc )
+    {
+      eco_hint_file = argv[++i];
+    }
+    else if ( arg == "--cache-dir" && i + 1 < argc )
+    {
+      es.cache_dir = argv[++i];
+    }
+    else if ( arg == "--batch" && i + 1 < argc )
+    {
+      batch_input = argv[++i];
+    }
+    else if ( arg == "--jobs" && i + 1 < argc )
+    {
+      jobs = static_cast<uint32_t>( std::max( 0, std::atoi( argv[++i] ) ) );
+    }
+    else if ( arg == "--batch-report" && i + 1 < argc )
+    {
+      report_file = argv[++i];
+    }
+    else if ( arg == "--stats-json" && i + 1 < argc )
+    {
+      stats_file = argv[++i];
+    }
+    else if ( arg == "--serve" )
+    {
+      serve = true;
+    }
+    else if ( arg == "--socket" && i + 1 < argc )
+    {
+      serve = true;
+      socket_path = argv[++i];
+    }
+    else if ( arg == "--cache-memory" && i + 1 < argc )
+    {
+      cache_memory_mb = static_cast<uint64_t>( std::max( 0, std::atoi( argv[++i] ) ) );
+    }
+    else
+    {
+      positional.push_back( arg );
+    }
+  }
+
+  bool const known_format = es.format.empty() || es.format == "json" || es.format == "binary";
+  std::size_t const num_required = serve ? 0u : batch_input.empty() ? 2u : 1u;
+  if ( positional.size() < num_required || !known_format || !known_priority || !known_cover || !cpsat::is_known_pruning_objective( es.pruning.top_n_objective ) )
+  {
+    std::cerr << "Usage: cut_enumeration <input.blif> <output.json|output.cdb> [K] [--format json|binary]\n"
+                 "       cut_enumeration --batch <blif_dir|list.txt> <output_dir> [K] [--format json|binary]\n"
+                 "                       [--jobs N] [--batch-report FILE]\n"
+                 "                       [--threads N] [--cut-limit C] [--cut-priority none|area|inv|depth]\n"
+                 "                       [--prune-dominated]\n"
+                 "                       [--top-n N] [--top-n-objective inv|area|depth|overall]\n"
+                 "                       [--cache-dir DIR] [--stats-json FILE] [--window-size S]\n"
+                 "                       [--hint-cover area|depth] [--hint-out FILE]\n"
+                 "                       [--eco-base OLD_CUTS [--eco-chosen OLD_CHOSEN.json] [--eco-hint-out FILE]]\n"
+                 "       cut_enumeration --serve [--socket PATH] [--cache-memory MB] [K] [options as above]\n";
+    return 1;
+  }
+
+  if ( positional.size() > num_required )
+  {
+    es.cut_size = std::atoi( positional[num_required].c_str() );
+    if ( es.cut_size <= 0 ) es.cut_size = 4;
+  }
+
+  if ( serve )
+  {
+    if ( !batch_input.empty() || !es.eco_base.empty() || es.window_size > 0u )
+    {
+      std::cerr << "Error: --serve takes its designs from the requests; --batch, --eco-base and --window-size are not served\n";
+      return 1;
+    }
+    return run_server( socket_path, cache_memory_mb << 20u, es );
+  }
+
+  if ( !batch_input.empty() && !es.eco_base.empty() )
+  {
+    std::cerr << "Error: --eco-base takes the cut file of one design; not supported with --batch\n";
+    return 1;
+  }
+  if ( !es.eco_chosen.empty() && es.eco_base.empty() )
+  {
+    std::cerr << "Error: --eco-chosen needs --eco-base\n";
+    return 1;
+  }
+  if ( !es.eco_base.empty() && es.threads < 0 )
+  {
+    es.threads = 1; // only the level-parallel enumerator can take cuts over
+  }
+
+  if ( !batch_input.empty() )
+  {
+    return run_batch( batch_input, positional[0], jobs, report_file, stats_file, es );
+  }
+
+  if ( hint_file.empty() )
+  {
+    auto hint_path = std::filesystem::path( positional[1] );
+    hint_file = ( hint_path.parent_path() / ( hint_path.stem().string() + "_hint.json" ) ).string();
+  }
+  if ( eco_hint_file.empty() )
+  {
+    auto hint_path = std::filesystem::path( positional[1] );
+    eco_hint_file = ( hint_path.parent_path() / ( hint_path.stem().string() + "_eco_hint.json" ) ).string();
+  }
+  cpsat::tool_stats stats( "cut_enumeration" );
+  bool const ok = enumerate_file( positional[0], positional[1], es, std::cerr, stats_file.empty() ? nullptr : &stats, hint_file,
+                                  eco_hint_file );
+  if ( !stats_file.empty() )
+  {
+    stats.set( "ok", ok );
+    if ( !stats.write( stats_file ) )
+    {
+      std::cerr << "[warn] Could not write stats '" << stats_file << "'\n";
+    }
+  }
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,766 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <iterator>
+#include <limits>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+#include <kitty/dynamic_truth_table.hpp>
+#include <kitty/operations.hpp>
+
+#include <mockturtle/views/fanout_view.hpp>
+
+#include "cut_database.hpp"
+
+/* Cut export shared by cut_enumeration and cpsat_pipeline: node naming,
+ * output selection and per-cut costs, written to any cut sink
+ * (`cut_database`, `json_cut_writer`).
+ */
+namespace cpsat
+{
+
+/*! \brief Cuts kept per node by the exporter. */
+constexpr uint32_t default_cut_limit = 32u;
+
+namespace detail
+{
+
+/*! \brief Minterms with variable `i` at 0, as kitty's negative projections. */
+constexpr uint64_t var_neg_masks[] = {
+    0x5555555555555555u, 0x3333333333333333u, 0x0f0f0f0f0f0f0f0fu,
+    0x00ff00ff00ff00ffu, 0x0000ffff0000ffffu, 0x00000000ffffffffu };
+
+} // namespace detail
+
+/*! \brief `compute_inv_cost` for a function of up to 6 variables stored in one word.
+ *
+ * Both cofactors of a variable are compared in place: the positive cofactor
+ * is shifted onto the negative one, no truth tables are built.
+ */
+inline uint32_t compute_inv_cost( uint64_t word, uint32_t num_vars )
+{
+  uint64_t const used = num_vars >= 6u ? ~uint64_t( 0 ) : ( uint64_t( 1 ) << ( 1u << num_vars ) ) - 1u;
+  word &= used;
+  uint32_t cost = 0;
+  for ( auto var = 0u; var < num_vars; ++var )
+  {
+    auto const mask = detail::var_neg_masks[var] & used;
+    auto const tt0 = word & mask;
+    auto const tt1 = ( word >> ( 1u << var ) ) & mask;
+    if ( ( tt0 & ~tt1 ) != 0u && ( tt1 & ~tt0 ) != 0u )
+    {
+      ++cost;
+    }
+  }
+  return cost;
+}
+
+/*! \brief Number of binate variables, i.e. inverters needed to realize `tt` with monotone gates. */
+inline uint32_t compute_inv_cost( kitty::dynamic_truth_table const& tt )
+{
+  if ( tt.num_vars() <= 6u )
+  {
+    return compute_inv_cost( *tt.cbegin(), tt.num_vars() );
+  }
+
+  uint32_t cost = 0;
+  const auto num_vars = tt.num_vars();
+  for ( unsigned var = 0; var < num_vars; ++var )
+  {
+    auto tt0 = kitty::cofactor0( tt, var );
+    auto tt1 = kitty::cofactor1( tt, var );
+    auto bad_pos = tt0 & ~tt1;
+    auto bad_neg = tt1 & ~tt0;
+    if ( !kitty::is_const0( bad_pos ) && !kitty::is_const0( bad_neg ) )
+    {
+      ++cost;
+    }
+  }
+  return cost;
+}
+
+/*! \brief `compute_inv_cost` memoized per function.
+ *
+ * Only tables of more than 6 variables are looked up: a single word is
+ * cheaper to evaluate than to hash.
+ */
+class inv_cost_cache
+{
+public:
+  uint32_t operator()( kitty::dynamic_truth_table const& tt )
+  {
+    if ( tt.num_vars() <= 6u )
+    {
+      return compute_inv_cost( *tt.cbegin(), tt.num_vars() );
+    }
+    _key.assign( tt.cbegin(), tt.cend() );
+    auto const it = _costs.find( _key );
+    if ( it != _costs.end() )
+    {
+      return it->second;
+    }
+    auto const cost = compute_inv_cost( tt );
+    _costs.emplace( _key, cost );
+    return cost;
+  }
+
+private:
+  std::vector<uint64_t> _key;
+  std::unordered_map<std::vector<uint64_t>, uint32_t, detail::word_vector_hash> _costs;
+};
+
+/*! \brief Structural costs of a cut, measured on the cone between its leaves and its root. */
+struct cone_costs
+{
+  /*! \brief Nodes covered by the cut, root included. */
+  uint32_t area;
+
+  /*! \brief Nodes on the longest path from a leaf to the root. */
+  uint32_t depth;
+
+  /*! \brief Covered nodes other than the root that also fan out of the cone, i.e. logic duplicated when the cut is chosen. */
+  uint32_t shared;
+};
+
+/*! \brief Computes `cone_costs` of cuts of `ntk`.
+ *
+ * The cone is collected backwards from the root up to the leaves and then
+ * visited in index order, which is topological for mockturtle networks.
+ * Fanout-sharing compares each node's fanout count (POs included) with its
+ * references from inside the cone. Node marks are generation stamps, so a
+ * call touches only the cone; not thread-safe.
+ */
+template<class Ntk>
+class cut_cone_costs
+{
+public:
+  explicit cut_cone_costs( Ntk const& ntk )
+      : _ntk( ntk ), _mark( ntk.size(), 0u ), _depth( ntk.size(), 0u ), _refs( ntk.size(), 0u )
+  {
+  }
+
+  template<typename LeafIt>
+  cone_costs operator()( uint32_t root, LeafIt leaves_begin, LeafIt leaves_end )
+  {
+    if ( std::distance( leaves_begin, leaves_end ) == 1 && *leaves_begin == root )
+    {
+      return { 1u, 1u, 0u }; /* trivial cut */
+    }
+
+    if ( _stamp >= std::numeric_limits<uint32_t>::max() - 2u )
+    {
+      std::fill( _mark.begin(), _mark.end(), 0u );
+      _stamp = 0u;
+    }
+    _stamp += 2u;
+    auto const leaf = _stamp;
+    auto const inner = _stamp + 1u;
+
+    for ( auto it = leaves_begin; it != leaves_end; ++it )
+    {
+      _mark[*it] = leaf;
+    }
+    _cone.clear();
+    _stack.assign( 1u, root );
+    _mark[root] = inner;
+    _refs[root] = 0u;
+    while ( !_stack.empty() )
+    {
+      auto const idx = _stack.back();
+      _stack.pop_back();
+      _cone.push_back( idx );
+      _ntk.foreach_fanin( _ntk.index_to_node( idx ), [&]( auto const& f ) {
+        auto const n = _ntk.get_node( f );
+        auto const c = _ntk.node_to_index( n );
+        if ( _mark[c] == leaf || _mark[c] == inner || _ntk.is_constant( n ) || _ntk.is_pi( n ) )
+        {
+          return;
+        }
+        _mark[c] = inner;
+        _refs[c] = 0u;
+        _stack.push_back( c );
+      } );
+    }
+    std::sort( _cone.begin(), _cone.end() );
+
+    for ( auto const idx : _cone )
+    {
+      uint32_t depth = 0u;
+      _ntk.foreach_fanin( _ntk.index_to_node( idx ), [&]( auto const& f ) {
+        auto const c = _ntk.node_to_index( _ntk.get_node( f ) );
+        if ( _mark[c] == inner )
+        {
+          depth = std::max( depth, _depth[c] );
+          ++_refs[c];
+        }
+      } );
+      _depth[idx] = depth + 1u;
+    }
+
+    uint32_t shared = 0u;
+    for ( auto const idx : _cone )
+    {
+      if ( idx != root && _ntk.fanout_size( _ntk.index_to_node( idx ) ) > _refs[idx] )
+      {
+        ++shared;
+      }
+    }
+    return { static_cast<uint32_t>( _cone.size() ), _depth[root], shared };
+  }
+
+private:
+  Ntk const& _ntk;
+  uint32_t _stamp{ 0u };
+  std::vector<uint32_t> _mark;
+  std::vector<uint32_t> _depth;
+  std::vector<uint32_t> _refs;
+  std::vector<uint32_t> _cone;
+  std::vector<uint32_t> _stack;
+};
+
+/*! \brief Per-node cut pruning applied before the cuts reach the cut file.
+ *
+ * Both filters drop cuts on their costs alone, so they shrink the CP-SAT
+ * model at the price of optimality guarantees; the trivial cut is always kept.
+ */
+struct cut_pruning_params
+{
+  /*! \brief Drop cuts that another cut of the node beats on inv, area and depth cost. */
+  bool prune_dominated{ false };
+
+  /*! \brief Keep at most this many non-trivial cuts per node (0: all). */
+  uint32_t top_n{ 0u };
+
+  /*! \brief Ranking for `top_n`: inv, area, depth or overall (sum of the three costs). */
+  std::string top_n_objective{ "inv" };
+
+  bool enabled() const { return prune_dominated || top_n > 0u; }
+};
+
+inline bool is_known_pruning_objective( std::string const& objective )
+{
+  return objective == "inv" || objective == "area" || objective == "depth" || objective == "overall";
+}
+
+/*! \brief Cuts per node to enumerate for an export of `cut_limit` cuts.
+ *
+ * The priority-cut mode enumerates a pool of at least `default_cut_limit`
+ * cuts, so that the metric, not the enumerator's order, picks the exported ones.
+ */
+inline uint32_t enumeration_cut_limit( uint32_t cut_limit, cut_priority priority )
+{
+  return priority == cut_priority::none ? cut_limit : std::max( cut_limit, default_cut_limit );
+}
+
+/*! \brief Turns `ps` into the priority-cut filter: the best `cut_limit - 1` non-trivial cuts by `priority` (replaces `top_n`). */
+inline void apply_cut_priority( cut_pruning_params& ps, uint32_t cut_limit, cut_priority priority )
+{
+  if ( priority == cut_priority::none )
+  {
+    return;
+  }
+  ps.top_n = std::max( cut_limit, 2u ) - 1u;
+  ps.top_n_objective = cut_priority_name( priority );
+}
+
+/*! \brief `cut_database::enumeration` of cuts from the native enumerator (`native`) or mockturtle's, exported through `ps`. */
+inline uint32_t enumeration_of( bool native, cut_pruning_params const& ps )
+{
+  return ( native ? enumeration_native : 0u ) | ( ps.prune_dominated ? enumeration_pruned_dominated : 0u );
+}
+
+/*! \brief Cut sink that buffers the cuts of a node and forwards the survivors of `cut_pruning_params`.
+ *
+ * Survivors keep their enumeration order, so the exported cut indices stay
+ * deterministic.
+ */
+template<class Sink>
+class pruning_cut_sink
+{
+public:
+  pruning_cut_sink( Sink& sink, cut_pruning_params const& ps )
+      : _sink( sink ), _ps( ps )
+  {
+  }
+
+  void begin_node( uint32_t index )
+  {
+    _index = index;
+    _cuts.clear();
+    _leaves.clear();
+    _words.clear();
+  }
+
+  template<typename LeafIt, typename WordIt>
+  void add_cut( LeafIt leaves_begin, LeafIt leaves_end, WordIt tt_begin, uint32_t inv_cost, uint32_t area_cost, uint32_t depth_cost,
+                uint32_t shared_cost, uint32_t cone_area, uint32_t cone_depth )
+  {
+    buffered_cut cut;
+    cut.leaf_begin = static_cast<uint32_t>( _leaves.size() );
+    _leaves.insert( _leaves.end(), leaves_begin, leaves_end );
+    cut.num_leaves = static_cast<uint32_t>( _leaves.size() ) - cut.leaf_begin;
+    cut.tt_begin = static_cast<uint32_t>( _words.size() );
+    _words.insert( _words.end(), tt_begin, tt_begin + tt_num_words( cut.num_leaves ) );
+    cut.inv_cost = inv_cost;
+    cut.area_cost = area_cost;
+    cut.depth_cost = depth_cost;
+    cut.shared_cost = shared_cost;
+    cut.cone_area = cone_area;
+    cut.cone_depth = cone_depth;
+    cut.trivial = cut.num_leaves == 1u && _leaves[cut.leaf_begin] == _index;
+    _cuts.push_back( cut );
+  }
+
+  void end_node()
+  {
+    if ( _ps.prune_dominated )
+    {
+      for ( auto& cut : _cuts )
+      {
+        cut.keep = cut.trivial || std::none_of( _cuts.begin(), _cuts.end(), [&]( auto const& other ) {
+                     return !other.trivial && dominates( other, cut );
+                   } );
+      }
+    }
+    if ( _ps.top_n > 0u )
+    {
+      keep_top_n();
+    }
+
+    _sink.begin_node( _index );
+    for ( auto const& cut : _cuts )
+    {
+      if ( !cut.keep )
+      {
+        ++_num_pruned;
+        continue;
+      }
+      auto const leaves = _leaves.begin() + cut.leaf_begin;
+      _sink.add_cut( leaves, leaves + cut.num_leaves, _words.begin() + cut.tt_begin,
+                     cut.inv_cost, cut.area_cost, cut.depth_cost, cut.shared_cost, cut.cone_area, cut.cone_depth );
+    }
+    _sink.end_node();
+  }
+
+  /*! \brief Cuts dropped so far over all nodes. */
+  uint64_t num_pruned() const { return _num_pruned; }
+
+private:
+  struct buffered_cut
+  {
+    uint32_t leaf_begin;
+    uint32_t num_leaves;
+    uint32_t tt_begin;
+    uint32_t inv_cost;
+    uint32_t area_cost;
+    uint32_t depth_cost;
+    uint32_t shared_cost;
+    uint32_t cone_area;
+    uint32_t cone_depth;
+    bool trivial;
+    bool keep{ true };
+  };
+
+  static bool dominates( buffered_cut const& a, buffered_cut const& b )
+  {
+    return a.inv_cost <= b.inv_cost && a.area_cost <= b.area_cost && a.depth_cost <= b.depth_cost &&
+           ( a.inv_cost < b.inv_cost || a.area_cost < b.area_cost || a.depth_cost < b.depth_cost );
+  }
+
+  std::tuple<uint32_t, uint32_t, uint32_t> rank( buffered_cut const& cut ) const
+  {
+    if ( _ps.top_n_objective == "area" )
+      return { cut.area_cost, cut.inv_cost, cut.depth_cost };
+    if ( _ps.top_n_objective == "depth" )
+      return { cut.depth_cost, cut.area_cost, cut.inv_cost };
+    if ( _ps.top_n_objective == "overall" )
+      return { cut.inv_cost + cut.area_cost + cut.depth_cost, cut.inv_cost, cut.area_cost };
+    return { cut.inv_cost, cut.area_cost, cut.depth_cost };
+  }
+
+  void keep_top_n()
+  {
+    _order.clear();
+    for ( auto i = 0u; i < _cuts.size(); ++i )
+    {
+      if ( _cuts[i].keep && !_cuts[i].trivial )
+      {
+        _order.push_back( i );
+      }
+    }
+    if ( _order.size() <= _ps.top_n )
+    {
+      return;
+    }
+    std::stable_sort( _order.begin(), _order.end(), [&]( auto a, auto b ) {
+      return rank( _cuts[a] ) < rank( _cuts[b] );
+    } );
+    for ( auto i = _ps.top_n; i < _order.size(); ++i )
+    {
+      _cuts[_order[i]].keep = false;
+    }
+  }
+
+  Sink& _sink;
+  cut_pruning_params _ps;
+  uint32_t _index{ 0u };
+  std::vector<buffered_cut> _cuts;
+  std::vector<uint32_t> _leaves;
+  std::vector<uint64_t> _words;
+  std::vector<uint32_t> _order;
+  uint64_t _num_pruned{ 0u };
+};
+
+/*! \brief Cut sink that drops nodes outside the outputs' fanin and computes the `model_reduction`.
+ *
+ * Forward, while streaming: a non-trivial cut is infeasible if a leaf is an
+ * exported node without feasible cuts; such a node is never used, so the
+ * marking propagates to its fanout. Backward, in `finish`: outputs are
+ * forced, and so are the leaves common to all feasible cuts of a forced
+ * node; a forced node with a single feasible cut forces that cut. Cuts are
+ * forwarded unchanged, so cut positions match the sink's.
+ *
+ * The same two passes give the level bounds of the depth model: `min_level`
+ * is the minimum depth over feasible cuts (forward), `height` the minimum
+ * number of levels between the node and an output through feasible cuts
+ * (backward). A cut adds `max( depth_cost, 1 )` levels, as in the model.
+ */
+template<class Sink>
+class reducing_cut_sink
+{
+public:
+  reducing_cut_sink( Sink& sink, std::vector<bool> const& reachable, std::vector<uint32_t> const& outputs )
+      : _sink( sink ), _reachable( reachable ), _outputs( outputs ), _state( reachable.size(), node_state::none ),
+        _min_level( reachable.size(), 0u )
+  {
+  }
+
+  void begin_node( uint32_t index )
+  {
+    _skip = !_reachable[index];
+    if ( _skip )
+    {
+      ++_reduction.dropped_nodes;
+      return;
+    }
+    _summaries.push_back( { index, 0u, 0u, static_cast<uint32_t>( _common.size() ), static_cast<uint32_t>( _feasible.size() ), no_level } );
+    _num_cuts = 0u;
+    _sink.begin_node( index );
+  }
+
+  template<typename LeafIt, typename WordIt>
+  void add_cut( LeafIt leaves_begin, LeafIt leaves_end, WordIt tt_begin, uint32_t inv_cost, uint32_t area_cost, uint32_t depth_cost,
+                uint32_t shared_cost, uint32_t cone_area, uint32_t cone_depth )
+  {
+    if ( _skip )
+    {
+      return;
+    }
+    auto& node = _summaries.back();
+    bool const trivial = std::distance( leaves_begin, leaves_end ) == 1 && *leaves_begin == node.index;
+    if ( !trivial )
+    {
+      if ( std::any_of( leaves_begin, leaves_end, [&]( auto leaf ) { return _state[leaf] == node_state::dead; } ) )
+      {
+        _reduction.infeasible_cuts.emplace_back( node.index, _num_cuts );
+      }
+      else
+      {
+        if ( node.num_feasible++ == 0u )
+        {
+          node.first_feasible = _num_cuts;
+          _common.insert( _common.end(), leaves_begin, leaves_end );
+        }
+        else
+        {
+          /* keep the common leaves that are also leaves of this cut */
+          auto const end = std::remove_if( _common.begin() + node.common_begin, _common.end(), [&]( auto leaf ) {
+            return std::find( leaves_begin, leaves_end, leaf ) == leaves_end;
+          } );
+          _common.erase( end, _common.end() );
+        }
+
+        uint32_t const step = std::max( depth_cost, 1u );
+        uint32_t leaf_level = 0u;
+        for ( auto it = leaves_begin; it != leaves_end; ++it )
+        {
+          leaf_level = std::max( leaf_level, _min_level[*it] );
+        }
+        node.min_level = std::min( node.min_level, leaf_level + step );
+        _feasible.push_back( { static_cast<uint32_t>( _feasible_leaves.size() ), static_cast<uint32_t>( std::distance( leaves_begin, leaves_end ) ), step } );
+        _feasible_leaves.insert( _feasible_leaves.end(), leaves_begin, leaves_end );
+      }
+    }
+    ++_num_cuts;
+    _sink.add_cut( leaves_begin, leaves_end, tt_begin, inv_cost, area_cost, depth_cost, shared_cost, cone_area, cone_depth );
+  }
+
+  void end_node()
+  {
+    if ( _skip )
+    {
+      return;
+    }
+    auto const& node = _summaries.back();
+    _state[node.index] = node.num_feasible > 0u ? node_state::live : node_state::dead;
+    _min_level[node.index] = node.min_level;
+    _sink.end_node();
+  }
+
+  /*! \brief Runs the backward pass; call once after the last node. */
+  model_reduction finish()
+  {
+    std::vector<bool> forced( _state.size(), false );
+    std::vector<uint32_t> height( _state.size(), no_level );
+    for ( auto o : _outputs )
+    {
+      forced[o] = true;
+      height[o] = 0u;
+    }
+    for ( auto i = _summaries.size(); i-- > 0u; )
+    {
+      auto const& node = _summaries[i];
+      auto const cut_end = i + 1u < _summaries.size() ? _summaries[i + 1u].cut_begin : static_cast<uint32_t>( _feasible.size() );
+      if ( height[node.index] != no_level )
+      {
+        for ( auto c = node.cut_begin; c < cut_end; ++c )
+        {
+          auto const& cut = _feasible[c];
+          for ( auto l = cut.leaf_begin; l < cut.leaf_begin + cut.num_leaves; ++l )
+          {
+            height[_feasible_leaves[l]] = std::min( height[_feasible_leaves[l]], height[node.index] + cut.step );
+          }
+        }
+      }
+      if ( !forced[node.index] )
+      {
+        continue;
+      }
+      _reduction.forced_nodes.push_back( node.index );
+      if ( node.num_feasible == 1u )
+      {
+        _reduction.forced_cuts.emplace_back( node.index, node.first_feasible );
+      }
+      auto const common_end = i + 1u < _summaries.size() ? _summaries[i + 1u].common_begin : static_cast<uint32_t>( _common.size() );
+      for ( auto c = node.common_begin; c < common_end; ++c )
+      {
+        forced[_common[c]] = true;
+      }
+    }
+    for ( auto const& node : _summaries )
+    {
+      _reduction.level_bounds.emplace_back( node.index, node.min_level == no_level ? 0u : node.min_level, height[node.index] );
+    }
+    std::reverse( _reduction.forced_nodes.begin(), _reduction.forced_nodes.end() );
+    std::reverse( _reduction.forced_cuts.begin(), _reduction.forced_cuts.end() );
+    return _reduction;
+  }
+
+private:
+  enum class node_state : uint8_t
+  {
+    none, /* PI, constant or not exported yet */
+    live,
+    dead  /* exported without feasible cuts */
+  };
+
+  struct node_summary
+  {
+    uint32_t index;
+    uint32_t num_feasible;
+    uint32_t first_feasible;
+    uint32_t common_begin; /* leaves common to all feasible cuts, up to the next node's `common_begin` */
+    uint32_t cut_begin;    /* feasible cuts in `_feasible`, up to the next node's `cut_begin` */
+    uint32_t min_level;
+  };
+
+  struct feasible_cut
+  {
+    uint32_t leaf_begin;
+    uint32_t num_leaves;
+    uint32_t step;
+  };
+
+  Sink& _sink;
+  std::vector<bool> const& _reachable;
+  std::vector<uint32_t> const& _outputs;
+  std::vector<node_state> _state;
+  std::vector<node_summary> _summaries;
+  std::vector<uint32_t> _common;
+  std::vector<uint32_t> _min_level;
+  std::vector<feasible_cut> _feasible;
+  std::vector<uint32_t> _feasible_leaves;
+  model_reduction _reduction;
+  uint32_t _num_cuts{ 0u };
+  bool _skip{ false };
+};
+
+/*! \brief Names, inputs and outputs of a network as seen by the cut file. */
+template<class Ntk>
+class cut_exporter
+{
+public:
+  explicit cut_exporter( Ntk const& ntk )
+      : _ntk( ntk ), _node_names( ntk.size() ), _is_pi( ntk.size(), false )
+  {
+    // Name each node; mark PIs
+    _ntk.foreach_pi( [&]( auto const& s, auto /*index*/ ){
+      auto n   = _ntk.get_node( s );
+      auto idx = _ntk.node_to_index( n );
+      _node_names[idx] = _ntk.get_name( s );  // e.g. opcode[0]
+      _is_pi[idx] = true;
+      _inputs.push_back( idx );
+    } );
+
+    _ntk.foreach_node( [&]( auto n ){
+      auto idx = _ntk.node_to_index( n );
+      if ( _node_names[idx].empty() )
+      {
+        if ( _ntk.is_constant( n ) )
+        {
+          _node_names[idx] = "const" + std::to_string( idx );
+        }
+        else
+        {
+          _node_names[idx] = "n" + std::to_string( idx );
+        }
+      }
+    } );
+
+    // Try to use real POs
+    if ( _ntk.num_pos() > 0 )
+    {
+      _ntk.foreach_po( [&]( auto const& s ){
+        _outputs.push_back( _ntk.node_to_index( _ntk.get_node( s ) ) );
+      } );
+    }
+    else
+    {
+      // Fallback: no POs in network → treat fanout-0 nodes (incl. PIs) as outputs
+      std::cerr << "[warn] Network has 0 POs. Using fanout-0 nodes as outputs.\n";
+
+      mockturtle::fanout_view<Ntk> fntk{ _ntk };
+      fntk.foreach_node( [&]( auto n ){
+        if ( fntk.is_constant( n ) ) return;
+
+        auto idx = fntk.node_to_index( n );
+
+        // We *include* PIs now as possible outputs, so no is_pi check here.
+        if ( fntk.fanout_size( n ) == 0 )
+        {
+          _outputs.push_back( idx );
+          std::cerr << "[OUT] fanout-0 idx=" << idx
+                    << " name=" << _node_names[idx] << "\n";
+        }
+      } );
+    }
+  }
+
+  std::vector<std::string> const& node_names() const { return _node_names; }
+  std::vector<uint32_t> const& inputs() const { return _inputs; }
+  std::vector<uint32_t> const& outputs() const { return _outputs; }
+
+  /*! \brief Marks the transitive fanin of the outputs, indexed by node index. */
+  std::vector<bool> reachable_nodes() const
+  {
+    std::vector<bool> reachable( _ntk.size(), false );
+    std::vector<uint32_t> stack( _outputs.begin(), _outputs.end() );
+    while ( !stack.empty() )
+    {
+      auto const idx = stack.back();
+      stack.pop_back();
+      if ( reachable[idx] )
+      {
+        continue;
+      }
+      reachable[idx] = true;
+      _ntk.foreach_fanin( _ntk.index_to_node( idx ), [&]( auto const& f ) {
+        auto const leaf = _ntk.node_to_index( _ntk.get_node( f ) );
+        if ( !reachable[leaf] )
+        {
+          stack.push_back( leaf );
+        }
+      } );
+    }
+    return reachable;
+  }
+
+  /*! \brief Exports internal nodes and their cuts; each node goes to the sink as soon as it is visited. */
+  template<class NetworkCuts, class Sink>
+  void export_nodes( NetworkCuts const& cut_res, Sink& sink ) const
+  {
+    std::vector<uint32_t> leaf_indices;
+    inv_cost_cache inv_costs;
+    cut_cone_costs<Ntk> cone( _ntk );
+    _ntk.foreach_node( [&]( auto n ){
+      if ( _ntk.is_constant( n ) )
+        return;
+
+      auto idx = _ntk.node_to_index( n );
+      if ( _is_pi[idx] )
+        return; // PIs are only leaves
+
+      sink.begin_node( idx );
+      auto const& cuts_for_node = cut_res.cuts( idx );
+      for ( auto it_cut = cuts_for_node.begin(); it_cut != cuts_for_node.end(); ++it_cut )
+      {
+        auto const& cut = **it_cut;
+
+        leaf_indices.clear();
+        for ( auto const& leaf_node : cut )
+        {
+          leaf_indices.push_back( _ntk.node_to_index( leaf_node ) );
+        }
+
+        auto tt = cut_res.truth_table( cut );
+        auto inv_cost = inv_costs( tt );
+        auto const costs = cone( idx, leaf_indices.begin(), leaf_indices.end() );
+        sink.add_cut( leaf_indices.begin(), leaf_indices.end(), tt.cbegin(),
+                      inv_cost, static_cast<uint32_t>( leaf_indices.size() ), 1u, costs.shared, costs.area, costs.depth );
+      }
+      sink.end_node();
+    } );
+  }
+
+  /*! \brief Cut database with names and terminals but no nodes yet. */
+  cut_database empty_database( uint32_t cut_size, uint32_t cut_limit, cut_priority priority = cut_priority::none,
+                               uint32_t top_n = 0u, uint32_t enumeration = 0u ) const
+  {
+    cut_database db;
+    db.cut_size = cut_size;
+    db.cut_limit = cut_limit;
+    db.priority = priority;
+    db.top_n = top_n;
+    db.enumeration = enumeration;
+    for ( auto const& name : _node_names )
+    {
+      db.add_name( name );
+    }
+    db.inputs = _inputs;
+    db.outputs = _outputs;
+    return db;
+  }
+
+  /*! \brief Collects names, terminals and all cuts into an in-memory cut database. */
+  template<class NetworkCuts>
+  cut_database make_database( NetworkCuts const& cut_res, uint32_t cut_size, uint32_t cut_limit ) const
+  {
+    auto db = empty_database( cut_size, cut_limit );
+    export_nodes( cut_res, db );
+    return db;
+  }
+
+private:
+  Ntk const& _ntk;
+  std::vector<std::string> _node_names;
+  std::vector<bool> _is_pi;
+  std::vector<uint32_t> _inputs;
+  std::vector<uint32_t> _outputs;
+};
+
+} // namespace cpsat
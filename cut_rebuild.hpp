@@ -0,0 +1,384 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <kitty/constructors.hpp>
+#include <kitty/dynamic_truth_table.hpp>
+#include <kitty/operations.hpp>
+
+#include <mockturtle/networks/klut.hpp>
+#include <mockturtle/views/names_view.hpp>
+
+#include "cut_database.hpp"
+#include "lut_arena.hpp"
+
+/* Rebuild of a k-LUT network from chosen cuts, shared by rebuild_from_cpsat and cpsat_pipeline. */
+namespace cpsat
+{
+
+/*! \brief Marks a node without a chosen cut in a chosen-cut vector. */
+constexpr uint32_t no_chosen_cut = std::numeric_limits<uint32_t>::max();
+
+struct rebuild_params
+{
+  /*! \brief Merge LUTs with the same function on the same leaf signals (in any order). */
+  bool strash{ false };
+};
+
+struct rebuild_stats
+{
+  uint32_t selected_nodes{ 0 };
+  uint32_t missing_outputs{ 0 };
+
+  /*! \brief Selected nodes that reused an existing signal instead of a new LUT (with `strash`). */
+  uint32_t strashed_nodes{ 0 };
+};
+
+namespace detail
+{
+
+/*! \brief Structural hash of a k-LUT network under construction.
+ *
+ * A LUT is put in canonical form before the lookup: constant leaves are
+ * propagated, repeated leaves merged, leaves outside the support dropped
+ * and the remaining leaves sorted with the truth table permuted to match.
+ * Functions that end up constant or equal to one leaf need no LUT at all.
+ */
+template<class Ntk>
+class lut_strash
+{
+public:
+  using signal = typename Ntk::signal;
+
+  explicit lut_strash( Ntk& ntk )
+      : _ntk( ntk )
+  {
+  }
+
+  /*! \brief Signal realizing `tt` over `leaves`; `reused` is set if no LUT was created. */
+  signal create_node( std::vector<signal> leaves, kitty::dynamic_truth_table tt, bool& reused )
+  {
+    canonicalize( leaves, tt );
+    reused = true;
+    if ( leaves.empty() )
+    {
+      return _ntk.get_constant( kitty::get_bit( tt, 0u ) );
+    }
+    if ( leaves.size() == 1u && kitty::get_bit( tt, 1u ) && !kitty::get_bit( tt, 0u ) )
+    {
+      return leaves[0];
+    }
+
+    _key.assign( leaves.begin(), leaves.end() );
+    _key.insert( _key.end(), tt.cbegin(), tt.cend() );
+    _key.push_back( leaves.size() );
+    auto const it = _nodes.find( _key );
+    if ( it != _nodes.end() )
+    {
+      return it->second;
+    }
+    reused = false;
+    auto const f = _ntk.create_node( leaves, tt );
+    _nodes.emplace( _key, f );
+    return f;
+  }
+
+private:
+  void canonicalize( std::vector<signal>& leaves, kitty::dynamic_truth_table& tt ) const
+  {
+    auto const n = static_cast<uint32_t>( leaves.size() );
+
+    // constant leaves and leaves equal to an earlier one become vacuous variables
+    for ( auto i = 0u; i < n; ++i )
+    {
+      auto const node = _ntk.get_node( leaves[i] );
+      if ( _ntk.is_constant( node ) )
+      {
+        auto const value = _ntk.constant_value( node );
+        tt = value ? kitty::cofactor1( tt, i ) : kitty::cofactor0( tt, i );
+        continue;
+      }
+      for ( auto j = 0u; j < i; ++j )
+      {
+        if ( leaves[j] == leaves[i] )
+        {
+          auto var = tt.construct();
+          kitty::create_nth_var( var, j );
+          auto const both1 = kitty::cofactor1( kitty::cofactor1( tt, j ), i );
+          auto const both0 = kitty::cofactor0( kitty::cofactor0( tt, j ), i );
+          tt = ( var & both1 ) | ( ~var & both0 );
+          break;
+        }
+      }
+    }
+
+    // drop vacuous variables, keeping the order of the others
+    uint32_t k = 0u;
+    for ( auto i = 0u; i < n; ++i )
+    {
+      if ( !kitty::has_var( tt, i ) )
+      {
+        continue;
+      }
+      if ( k != i )
+      {
+        kitty::swap_inplace( tt, k, i );
+        leaves[k] = leaves[i];
+      }
+      ++k;
+    }
+    leaves.resize( k );
+    tt = kitty::shrink_to( tt, k );
+
+    // sort the leaves, permuting the variables with them
+    for ( auto i = 1u; i < k; ++i )
+    {
+      for ( auto j = i; j > 0u && leaves[j] < leaves[j - 1u]; --j )
+      {
+        std::swap( leaves[j], leaves[j - 1u] );
+        kitty::swap_inplace( tt, j - 1u, j );
+      }
+    }
+  }
+
+  Ntk& _ntk;
+  std::vector<uint64_t> _key;
+  std::unordered_map<std::vector<uint64_t>, signal, word_vector_hash> _nodes;
+};
+
+} // namespace detail
+
+/*! \brief Builds a k-LUT network with one LUT per node that has a chosen cut.
+ *
+ * `chosen_cut[i]` is the position of the chosen cut among the cuts of node
+ * index `i` in `db`, or `no_chosen_cut`. PIs and constants are taken from
+ * `ntk`, the network the cut file was exported from; POs are the outputs
+ * recorded in the cut file. With `ps.strash`, LUTs are merged by
+ * `detail::lut_strash`.
+ */
+template<class Ntk>
+mockturtle::names_view<mockturtle::klut_network> rebuild_network( Ntk const& ntk, cut_database_view const& db,
+                                                                  std::vector<uint32_t> const& chosen_cut,
+                                                                  rebuild_stats& st, rebuild_params const& ps = {} )
+{
+  using namespace mockturtle;
+
+  names_view<klut_network> new_ntk;
+  using new_signal = decltype( new_ntk )::signal;
+  detail::lut_strash<names_view<klut_network>> strash( new_ntk );
+
+  std::vector<new_signal> index_to_new_signal( ntk.size() );
+  std::vector<bool> has_new_signal( ntk.size(), false );
+
+  auto map_constant = [&]( bool value ) {
+    const auto idx = ntk.node_to_index( ntk.get_node( ntk.get_constant( value ) ) );
+    index_to_new_signal[idx] = new_ntk.get_constant( value );
+    has_new_signal[idx] = true;
+  };
+  map_constant( false );
+  map_constant( true );
+
+  uint32_t pi_index = 0u;
+  ntk.foreach_pi( [&]( auto const& signal ) {
+    const auto idx = ntk.node_to_index( ntk.get_node( signal ) );
+    std::string name = ntk.has_name( signal ) ? ntk.get_name( signal ) : "";
+    if ( name.empty() )
+    {
+      name = "pi" + std::to_string( pi_index );
+    }
+    index_to_new_signal[idx] = new_ntk.create_pi( name );
+    has_new_signal[idx] = true;
+    ++pi_index;
+  } );
+
+  // cut file nodes are in topological order, so leaves are mapped before their roots
+  std::vector<new_signal> leaf_signals;
+  for ( auto i = 0u; i < db.num_nodes; ++i )
+  {
+    auto const& record = db.nodes[i];
+    const auto idx = record.index;
+    if ( idx >= chosen_cut.size() || chosen_cut[idx] == no_chosen_cut )
+    {
+      continue;
+    }
+    if ( chosen_cut[idx] >= record.num_cuts )
+    {
+      std::cerr << "Warning: chosen cut index " << chosen_cut[idx] << " out of range for node " << db.name( idx ) << "\n";
+      continue;
+    }
+    auto const& cut = db.cuts[record.cut_begin + chosen_cut[idx]];
+
+    leaf_signals.clear();
+    bool missing_leaf = false;
+    for ( auto leaf_it = db.leaves_begin( cut ); leaf_it != db.leaves_end( cut ); ++leaf_it )
+    {
+      if ( !has_new_signal[*leaf_it] )
+      {
+        std::cerr << "Warning: missing mapped leaf for node " << db.name( idx ) << "\n";
+        missing_leaf = true;
+        break;
+      }
+      leaf_signals.push_back( index_to_new_signal[*leaf_it] );
+    }
+    if ( missing_leaf )
+    {
+      continue;
+    }
+
+    kitty::dynamic_truth_table tt( cut.num_leaves );
+    std::copy( db.tt_begin( cut ), db.tt_end( cut ), tt.begin() );
+    if ( ps.strash )
+    {
+      bool reused = false;
+      index_to_new_signal[idx] = strash.create_node( leaf_signals, std::move( tt ), reused );
+      st.strashed_nodes += reused ? 1u : 0u;
+    }
+    else
+    {
+      index_to_new_signal[idx] = new_ntk.create_node( leaf_signals, tt );
+    }
+    has_new_signal[idx] = true;
+    ++st.selected_nodes;
+  }
+
+  for ( auto i = 0u; i < db.num_outputs; ++i )
+  {
+    const auto idx = db.outputs[i];
+    std::string const out_name( db.name( idx ) );
+    if ( !has_new_signal[idx] )
+    {
+      std::cerr << "[warn] could not create PO for " << out_name << "\n";
+      ++st.missing_outputs;
+      continue;
+    }
+    new_ntk.create_po( index_to_new_signal[idx], out_name );
+  }
+
+  return new_ntk;
+}
+
+/*! \brief `rebuild_network` into a `lut_arena`, sized from the chosen cuts before the first LUT.
+ *
+ * Leaves are mapped through one reused buffer and the truth tables are
+ * copied from `db` word by word, so nothing is allocated per LUT unless
+ * `ps.strash` is set (the structural hash keeps its own keys).
+ */
+template<class Ntk>
+lut_arena rebuild_arena( Ntk const& ntk, cut_database_view const& db, std::vector<uint32_t> const& chosen_cut, rebuild_stats& st,
+                         rebuild_params const& ps = {} )
+{
+  constexpr auto no_signal = std::numeric_limits<uint32_t>::max();
+
+  auto chosen_record = [&]( node_record const& record ) -> cut_record const* {
+    auto const idx = record.index;
+    if ( idx >= chosen_cut.size() || chosen_cut[idx] == no_chosen_cut || chosen_cut[idx] >= record.num_cuts )
+    {
+      return nullptr;
+    }
+    return &db.cuts[record.cut_begin + chosen_cut[idx]];
+  };
+
+  uint64_t num_luts = 0u, num_fanins = 0u, num_tt_words = 0u, name_bytes = 0u;
+  for ( auto i = 0u; i < db.num_nodes; ++i )
+  {
+    if ( auto const cut = chosen_record( db.nodes[i] ) )
+    {
+      ++num_luts;
+      num_fanins += cut->num_leaves;
+      num_tt_words += tt_num_words( cut->num_leaves );
+    }
+  }
+  std::vector<std::string> pi_names;
+  pi_names.reserve( ntk.num_pis() );
+  ntk.foreach_pi( [&]( auto const& signal, auto index ) {
+    pi_names.push_back( ntk.has_name( signal ) ? ntk.get_name( signal ) : "" );
+    if ( pi_names.back().empty() )
+    {
+      pi_names.back() = "pi" + std::to_string( index );
+    }
+    name_bytes += pi_names.back().size();
+  } );
+  for ( auto i = 0u; i < db.num_outputs; ++i )
+  {
+    name_bytes += db.name( db.outputs[i] ).size();
+  }
+
+  lut_arena net;
+  net.reserve( ntk.num_pis(), db.num_outputs, num_luts, num_fanins, num_tt_words, name_bytes );
+  detail::lut_strash<lut_arena> strash( net );
+
+  std::vector<uint32_t> index_to_signal( ntk.size(), no_signal );
+  index_to_signal[ntk.node_to_index( ntk.get_node( ntk.get_constant( false ) ) )] = net.get_constant( false );
+  index_to_signal[ntk.node_to_index( ntk.get_node( ntk.get_constant( true ) ) )] = net.get_constant( true );
+  ntk.foreach_pi( [&]( auto const& signal, auto index ) {
+    index_to_signal[ntk.node_to_index( ntk.get_node( signal ) )] = net.create_pi( pi_names[index] );
+  } );
+
+  std::vector<uint32_t> leaf_signals;
+  leaf_signals.reserve( db.cut_size );
+  for ( auto i = 0u; i < db.num_nodes; ++i )
+  {
+    auto const& record = db.nodes[i];
+    auto const idx = record.index;
+    auto const cut = chosen_record( record );
+    if ( cut == nullptr )
+    {
+      if ( idx < chosen_cut.size() && chosen_cut[idx] != no_chosen_cut )
+      {
+        std::cerr << "Warning: chosen cut index " << chosen_cut[idx] << " out of range for node " << db.name( idx ) << "\n";
+      }
+      continue;
+    }
+
+    leaf_signals.clear();
+    for ( auto leaf_it = db.leaves_begin( *cut ); leaf_it != db.leaves_end( *cut ); ++leaf_it )
+    {
+      if ( index_to_signal[*leaf_it] == no_signal )
+      {
+        break;
+      }
+      leaf_signals.push_back( index_to_signal[*leaf_it] );
+    }
+    if ( leaf_signals.size() != cut->num_leaves )
+    {
+      std::cerr << "Warning: missing mapped leaf for node " << db.name( idx ) << "\n";
+      continue;
+    }
+
+    if ( ps.strash )
+    {
+      kitty::dynamic_truth_table tt( cut->num_leaves );
+      std::copy( db.tt_begin( *cut ), db.tt_end( *cut ), tt.begin() );
+      bool reused = false;
+      index_to_signal[idx] = strash.create_node( leaf_signals, std::move( tt ), reused );
+      st.strashed_nodes += reused ? 1u : 0u;
+    }
+    else
+    {
+      index_to_signal[idx] = net.create_lut( leaf_signals.begin(), leaf_signals.end(), db.tt_begin( *cut ) );
+    }
+    ++st.selected_nodes;
+  }
+
+  for ( auto i = 0u; i < db.num_outputs; ++i )
+  {
+    auto const idx = db.outputs[i];
+    if ( index_to_signal[idx] == no_signal )
+    {
+      std::cerr << "[warn] could not create PO for " << db.name( idx ) << "\n";
+      ++st.missing_outputs;
+      continue;
+    }
+    net.create_po( index_to_signal[idx], db.name( idx ) );
+  }
+  return net;
+}
+
+} // namespace cpsat
@@ -0,0 +1,286 @@
+#pragma once
+
+#include <cerrno>
+#include <csignal>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <list>
+#include <memory>
+#include <optional>
+#include <string>
+#include <system_error>
+#include <unordered_map>
+#include <utility>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "cut_database.hpp"
+
+/* Building blocks of the cut_enumeration server (`cut_enumeration --serve`).
+ *
+ * The server keeps parsed networks and exported cut databases in one LRU
+ * cache with a memory budget, so a request for another K, cut limit
+ * or pruning setting on a loaded design skips the BLIF parsing, and a
+ * repeated request skips the enumeration as well and only writes the file.
+ * Requests are JSON lines read from stdin or from the clients of a Unix
+ * domain socket; see cut_service.py for a client.
+ */
+namespace cpsat
+{
+
+/*! \brief Least recently used map with a byte budget; values are shared so an evicted entry stays valid for its users. */
+template<class Value>
+class lru_cache
+{
+public:
+  explicit lru_cache( uint64_t budget_bytes = 0u ) : _budget( budget_bytes ) {}
+
+  void set_budget( uint64_t budget_bytes )
+  {
+    _budget = budget_bytes;
+    evict();
+  }
+
+  /*! \brief The entry `key`, which becomes the most recently used one, or null. */
+  std::shared_ptr<Value const> find( std::string const& key )
+  {
+    auto const it = _index.find( key );
+    if ( it == _index.end() )
+    {
+      return nullptr;
+    }
+    _entries.splice( _entries.begin(), _entries, it->second );
+    return it->second->value;
+  }
+
+  /*! \brief Adds or replaces `key`, then evicts from the least recently used end; an entry over the whole budget is not kept. */
+  std::shared_ptr<Value const> insert( std::string const& key, std::shared_ptr<Value const> value, uint64_t bytes )
+  {
+    erase( key );
+    if ( bytes > _budget )
+    {
+      return value;
+    }
+    _entries.push_front( entry{ key, value, bytes } );
+    _index[key] = _entries.begin();
+    _bytes += bytes;
+    evict();
+    return value;
+  }
+
+  void erase( std::string const& key )
+  {
+    auto const it = _index.find( key );
+    if ( it != _index.end() )
+    {
+      _bytes -= it->second->bytes;
+      _entries.erase( it->second );
+      _index.erase( it );
+    }
+  }
+
+  void clear()
+  {
+    _entries.clear();
+    _index.clear();
+    _bytes = 0u;
+  }
+
+  uint64_t bytes() const
+  {
+    return _bytes;
+  }
+
+  uint64_t size() const
+  {
+    return _entries.size();
+  }
+
+  uint64_t evictions() const
+  {
+    return _evictions;
+  }
+
+private:
+  struct entry
+  {
+    std::string key;
+    std::shared_ptr<Value const> value;
+    uint64_t bytes;
+  };
+
+  void evict()
+  {
+    while ( _bytes > _budget && !_entries.empty() )
+    {
+      _bytes -= _entries.back().bytes;
+      _index.erase( _entries.back().key );
+      _entries.pop_back();
+      ++_evictions;
+    }
+  }
+
+  uint64_t _budget;
+  uint64_t _bytes{ 0u };
+  uint64_t _evictions{ 0u };
+  std::list<entry> _entries;
+  std::unordered_map<std::string, typename std::list<entry>::iterator> _index;
+};
+
+/*! \brief Cache key of a design file: its canonical path, size and modification time, or nothing if it does not exist.
+ *
+ * Unlike `cut_cache_key` the file is not read, so every request for a loaded
+ * design costs one `stat`; an edited file gets a new key.
+ */
+inline std::optional<std::string> network_key( std::string const& filename )
+{
+  std::error_code ec;
+  auto const path = std::filesystem::canonical( filename, ec );
+  if ( ec )
+  {
+    return std::nullopt;
+  }
+  auto const size = std::filesystem::file_size( path, ec );
+  if ( ec )
+  {
+    return std::nullopt;
+  }
+  auto const time = std::filesystem::last_write_time( path, ec );
+  if ( ec )
+  {
+    return std::nullopt;
+  }
+  return path.string() + "|" + std::to_string( size ) + "|" + std::to_string( time.time_since_epoch().count() );
+}
+
+/*! \brief Heap bytes held by `db`, for the cache budget. */
+inline uint64_t cut_database_bytes( cut_database const& db )
+{
+  return sizeof( db ) + db.name_offsets.capacity() * sizeof( uint32_t ) + db.name_chars.capacity() +
+         db.nodes.capacity() * sizeof( node_record ) + db.cuts.capacity() * sizeof( cut_record ) +
+         ( db.leaves.capacity() + db.inputs.capacity() + db.outputs.capacity() ) * sizeof( uint32_t ) +
+         db.tt_words.capacity() * sizeof( uint64_t ) + db.tt_index.size() * 4u * sizeof( uint64_t );
+}
+
+/*! \brief Line-based listener on a Unix domain socket; one client is served at a time. */
+class unix_socket_server
+{
+public:
+  ~unix_socket_server()
+  {
+    close_client();
+    if ( _fd >= 0 )
+    {
+      ::close( _fd );
+      std::error_code ec;
+      std::filesystem::remove( _path, ec );
+    }
+  }
+
+  /*! \brief Binds and listens on `path`, replacing a stale socket file; false with `error` set on failure. */
+  bool listen( std::string const& path, std::string& error )
+  {
+    sockaddr_un addr{};
+    if ( path.size() >= sizeof( addr.sun_path ) )
+    {
+      error = "socket path is too long";
+      return false;
+    }
+    std::signal( SIGPIPE, SIG_IGN ); // a client that disconnects early must not end the server
+    _fd = ::socket( AF_UNIX, SOCK_STREAM, 0 );
+    if ( _fd < 0 )
+    {
+      error = std::strerror( errno );
+      return false;
+    }
+    addr.sun_family = AF_UNIX;
+    std::memcpy( addr.sun_path, path.c_str(), path.size() + 1u );
+    ::unlink( path.c_str() );
+    if ( ::bind( _fd, reinterpret_cast<sockaddr const*>( &addr ), sizeof( addr ) ) != 0 || ::listen( _fd, 16 ) != 0 )
+    {
+      error = std::strerror( errno );
+      ::close( _fd );
+      _fd = -1;
+      return false;
+    }
+    _path = path;
+    return true;
+  }
+
+  /*! \brief Next request line of the current client, waiting for a new client when it disconnects; false on a listener error. */
+  bool read_line( std::string& line )
+  {
+    while ( true )
+    {
+      if ( _client < 0 )
+      {
+        _client = ::accept( _fd, nullptr, nullptr );
+        if ( _client < 0 )
+        {
+          if ( errno == EINTR )
+            continue;
+          return false;
+        }
+        _buffer.clear();
+      }
+      auto const eol = _buffer.find( '\n' );
+      if ( eol != std::string::npos )
+      {
+        line = _buffer.substr( 0u, eol );
+        _buffer.erase( 0u, eol + 1u );
+        return true;
+      }
+      char chunk[4096];
+      auto const n = ::recv( _client, chunk, sizeof( chunk ), 0 );
+      if ( n > 0 )
+      {
+        _buffer.append( chunk, static_cast<std::size_t>( n ) );
+      }
+      else if ( n < 0 && errno == EINTR )
+      {
+        continue;
+      }
+      else
+      {
+        close_client();
+      }
+    }
+  }
+
+  /*! \brief Sends `line` and a newline to the current client; a client that went away is dropped. */
+  void write_line( std::string const& line )
+  {
+    auto const data = line + "\n";
+    std::size_t sent = 0u;
+    while ( _client >= 0 && sent < data.size() )
+    {
+      auto const n = ::send( _client, data.data() + sent, data.size() - sent, 0 );
+      if ( n < 0 && errno == EINTR )
+        continue;
+      if ( n <= 0 )
+        close_client();
+      else
+        sent += static_cast<std::size_t>( n );
+    }
+  }
+
+private:
+  void close_client()
+  {
+    if ( _client >= 0 )
+    {
+      ::close( _client );
+      _client = -1;
+    }
+  }
+
+  int _fd{ -1 };
+  int _client{ -1 };
+  std::string _path;
+  std::string _buffer;
+};
+
+} // namespace cpsat
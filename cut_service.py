@@ -0,0 +1,153 @@
+"""Client of the cut enumeration server (`cut_enumeration --serve`).
+
+The server keeps parsed BLIFs and exported cut databases in an LRU cache, so
+after the first request for a design, other K / cut limit / pruning settings
+skip the parsing and repeated settings skip the enumeration as well. A
+request and its answer are one JSON line each. `CutService` either starts a
+private server and talks to it over stdin/stdout, or connects to a shared
+one started with `--socket PATH`. Cut databases come back as files; a path
+on a tmpfs such as /dev/shm (see `shm_output`) keeps them in memory.
+
+    with CutService(binary="tools/cut_enumeration") as cuts:
+        for k in (4, 5, 6):
+            cuts.enumerate("design.blif", shm_output(f"design_k{k}.cdb"), k=k)
+"""
+
+import json
+import os
+import socket
+import subprocess
+import tempfile
+from pathlib import Path
+
+
+def _shm_dir():
+    return Path("/dev/shm") if Path("/dev/shm").is_dir() else Path(tempfile.gettempdir())
+
+
+def shm_output(name):
+    """`name` under /dev/shm when it exists (Linux tmpfs), else under the temp directory."""
+    return str(_shm_dir() / name)
+
+
+class CutService:
+    """Requests to one cut_enumeration server; `socket_path` alone connects to a running one."""
+
+    def __init__(self, binary=None, socket_path=None, cache_memory_mb=None, server_args=()):
+        self._proc = None
+        self._sock = None
+        if binary is None and socket_path is None:
+            raise ValueError("CutService needs the cut_enumeration binary or the socket of a running server")
+        if binary is not None:
+            cmd = [str(binary), "--serve"]
+            if socket_path is not None:
+                cmd += ["--socket", str(socket_path)]
+            if cache_memory_mb is not None:
+                cmd += ["--cache-memory", str(cache_memory_mb)]
+            cmd += [str(a) for a in server_args]
+            pipes = subprocess.PIPE if socket_path is None else None
+            self._proc = subprocess.Popen(cmd, stdin=pipes, stdout=pipes, text=True, bufsize=1)
+        if socket_path is not None:
+            self._sock = self._connect(socket_path)
+            self._file = self._sock.makefile("rw", encoding="utf-8", newline="\n")
+        else:
+            self._file = None
+
+    def _connect(self, socket_path, attempts=100):
+        """Connects to `socket_path`, waiting for a server that was just started to listen."""
+        last_error = None
+        for _ in range(attempts):
+            sock = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+            try:
+                sock.connect(str(socket_path))
+                return sock
+            except OSError as exc:
+                sock.close()
+                last_error = exc
+                if self._proc is None or self._proc.poll() is not None:
+                    break
+                self._proc_wait(0.05)
+        raise ConnectionError(f"cannot connect to cut server '{socket_path}': {last_error}")
+
+    def _proc_wait(self, seconds):
+        try:
+            self._proc.wait(timeout=seconds)
+        except subprocess.TimeoutExpired:
+            pass
+
+    def request(self, **fields):
+        """Sends one request and returns the server's answer as a dict."""
+        line = json.dumps(fields) + "\n"
+        if self._file is not None:
+            self._file.write(line)
+            self._file.flush()
+            answer = self._file.readline()
+        else:
+            self._proc.stdin.write(line)
+            self._proc.stdin.flush()
+            answer = self._proc.stdout.readline()
+        if not answer:
+            raise ConnectionError("cut server closed the connection")
+        return json.loads(answer)
+
+    def enumerate(self, design, output, **settings):
+        """Cuts of `design` into `output` (.cdb binary, else JSON).
+
+        `settings` are request fields: k, cut_limit, priority, prune_dominated,
+        top_n, top_n_objective, format, threads, hint_cover and hint_out.
+        Raises RuntimeError if the server reports an error.
+        """
+        answer = self.request(design=str(Path(design).resolve()), output=str(output), **settings)
+        if not answer.get("ok"):
+            raise RuntimeError(f"cut server: {answer.get('error', 'request failed')}")
+        return answer
+
+    def stats(self):
+        return self.request(cmd="stats")
+
+    def clear(self):
+        return self.request(cmd="clear")
+
+    def close(self, shutdown=None):
+        """Disconnects; a server started by this client (or `shutdown=True`) is stopped."""
+        if shutdown is None:
+            shutdown = self._proc is not None
+        try:
+            if shutdown:
+                self.request(cmd="shutdown")
+        except (ConnectionError, OSError, ValueError):
+            pass
+        if self._file is not None:
+            self._file.close()
+            self._sock.close()
+            self._file = None
+        if self._proc is not None:
+            if self._proc.stdin:
+                self._proc.stdin.close()
+            self._proc.wait()
+            self._proc = None
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *exc):
+        self.close()
+        return False
+
+
+def cuts_from_server(socket_path, design, cut_size=None):
+    """Binary cut database of `design` from the server at `socket_path`, in a temporary file the caller removes."""
+    fd, output = tempfile.mkstemp(prefix=f"{Path(design).stem}_cuts_", suffix=".cdb", dir=_shm_dir())
+    os.close(fd)
+    settings = {"k": cut_size} if cut_size is not None else {}
+    try:
+        with CutService(socket_path=socket_path) as service:
+            answer = service.enumerate(design, output, format="binary", **settings)
+    except BaseException:
+        os.unlink(output)
+        raise
+    print(
+        f"Cuts of '{design}' from the cut server in {answer['seconds']:.3f}s "
+        f"(network {answer.get('network_cache', 'cached')}, cuts {answer['cuts_cache']})"
+    )
+    return Path(output)
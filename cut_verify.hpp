@@ -0,0 +1,361 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "cut_database.hpp"
+#include "lut_arena.hpp"
+
+/* Equivalence self-check of a rebuild (`rebuild_from_cpsat --verify`).
+ *
+ * Both netlists are flattened into `sim_network`s and simulated on blocks of
+ * 512 patterns; every operation runs over the 8 words of a block, in plain
+ * loops that the compiler turns into 256- or 512-bit vector code. Inputs are
+ * paired by name and outputs by name in order of occurrence. With few inputs
+ * every input combination is simulated, so equivalence is proven; otherwise
+ * random patterns can only find a difference. A gate is evaluated as a
+ * multiplexer tree over its truth table, or pattern by pattern when it has too
+ * many fanins for the tree.
+ */
+namespace cpsat
+{
+
+/*! \brief 64-bit words of one simulation block. */
+constexpr uint32_t sim_block_words = 8u;
+
+struct alignas( 64 ) sim_block
+{
+  std::array<uint64_t, sim_block_words> words;
+};
+
+/*! \brief Flat netlist for simulation: slots 0 and 1 are the constants, gates are in topological order. */
+struct sim_network
+{
+  struct gate
+  {
+    uint32_t slot;
+    uint32_t fanin_begin;
+    uint32_t num_fanins;
+    uint32_t tt_begin;
+  };
+
+  uint32_t num_slots{ 2u };
+  std::vector<uint32_t> pis; /* slot per PI */
+  std::vector<std::string> pi_names;
+  std::vector<gate> gates;
+  std::vector<uint32_t> fanins;
+  std::vector<uint64_t> tt_words;
+  std::vector<uint32_t> pos; /* slot per PO */
+  std::vector<std::string> po_names;
+};
+
+/*! \brief Flattens a k-LUT network; PIs without a name are `pi<index>` as in the rebuild, PO `i` is named `po_name( i )`. */
+template<class Ntk, class PoNameFn>
+sim_network make_sim_network( Ntk const& ntk, PoNameFn&& po_name )
+{
+  sim_network sim;
+  std::vector<uint32_t> slot( ntk.size(), 0u );
+  ntk.foreach_node( [&]( auto const& n ) {
+    if ( ntk.is_constant( n ) )
+    {
+      slot[ntk.node_to_index( n )] = ntk.constant_value( n ) ? 1u : 0u;
+    }
+  } );
+  ntk.foreach_pi( [&]( auto const& signal, auto index ) {
+    slot[ntk.node_to_index( ntk.get_node( signal ) )] = sim.num_slots;
+    sim.pis.push_back( sim.num_slots++ );
+    std::string name = ntk.has_name( signal ) ? ntk.get_name( signal ) : "";
+    sim.pi_names.push_back( name.empty() ? "pi" + std::to_string( index ) : name );
+  } );
+  ntk.foreach_gate( [&]( auto const& n ) {
+    sim_network::gate g;
+    g.slot = sim.num_slots++;
+    g.fanin_begin = static_cast<uint32_t>( sim.fanins.size() );
+    g.tt_begin = static_cast<uint32_t>( sim.tt_words.size() );
+    slot[ntk.node_to_index( n )] = g.slot;
+    ntk.foreach_fanin( n, [&]( auto const& f ) {
+      sim.fanins.push_back( slot[ntk.node_to_index( ntk.get_node( f ) )] );
+    } );
+    g.num_fanins = static_cast<uint32_t>( sim.fanins.size() ) - g.fanin_begin;
+    auto const function = ntk.node_function( n );
+    sim.tt_words.insert( sim.tt_words.end(), function.cbegin(), function.cend() );
+    sim.gates.push_back( g );
+  } );
+  ntk.foreach_po( [&]( auto const& signal, auto index ) {
+    sim.pos.push_back( slot[ntk.node_to_index( ntk.get_node( signal ) )] );
+    sim.po_names.emplace_back( po_name( index ) );
+  } );
+  return sim;
+}
+
+/*! \brief Flattens a `lut_arena`; its signals are already slots. */
+inline sim_network make_sim_network( lut_arena const& net )
+{
+  sim_network sim;
+  sim.num_slots = net.size();
+  for ( auto i = 0u; i < net.num_pis(); ++i )
+  {
+    sim.pis.push_back( 2u + i );
+    sim.pi_names.emplace_back( net.pi_name( i ) );
+  }
+  for ( auto i = 0u; i < net.num_luts(); ++i )
+  {
+    auto const& l = net.lut_at( i );
+    sim_network::gate g;
+    g.slot = 2u + net.num_pis() + i;
+    g.fanin_begin = static_cast<uint32_t>( sim.fanins.size() );
+    g.num_fanins = l.num_fanins;
+    g.tt_begin = static_cast<uint32_t>( sim.tt_words.size() );
+    sim.fanins.insert( sim.fanins.end(), net.fanins_begin( l ), net.fanins_end( l ) );
+    sim.tt_words.insert( sim.tt_words.end(), net.tt_begin( l ), net.tt_begin( l ) + tt_num_words( l.num_fanins ) );
+    sim.gates.push_back( g );
+  }
+  for ( auto i = 0u; i < net.num_pos(); ++i )
+  {
+    sim.pos.push_back( net.po_driver( i ) );
+    sim.po_names.emplace_back( net.po_name( i ) );
+  }
+  return sim;
+}
+
+struct verify_params
+{
+  /*! \brief Random patterns, rounded up to whole blocks; also the budget for exhaustive simulation. */
+  uint64_t patterns{ 1u << 16u };
+
+  uint64_t seed{ 1u };
+};
+
+struct verify_result
+{
+  bool equivalent{ false };
+
+  /*! \brief All input combinations were simulated. */
+  bool exhaustive{ false };
+
+  uint64_t patterns{ 0u };
+
+  /*! \brief Why the netlists could not be compared (unmatched inputs or outputs), empty otherwise. */
+  std::string error;
+
+  /*! \brief First differing output and the input values (per PI of the first netlist) that show it. */
+  std::string failing_output;
+  std::vector<bool> counterexample;
+};
+
+namespace detail
+{
+
+/*! \brief Minterms with variable `i` at 1, for the exhaustive patterns of the first 6 inputs. */
+constexpr uint64_t sim_projections[] = { 0xaaaaaaaaaaaaaaaau, 0xccccccccccccccccu, 0xf0f0f0f0f0f0f0f0u,
+                                         0xff00ff00ff00ff00u, 0xffff0000ffff0000u, 0xffffffff00000000u };
+
+/*! \brief Simulation values of one `sim_network`, one block per slot. */
+class block_simulator
+{
+public:
+  explicit block_simulator( sim_network const& sim ) : _sim( sim ), _values( sim.num_slots )
+  {
+    _values[0].words.fill( 0u );
+    _values[1].words.fill( ~uint64_t( 0 ) );
+  }
+
+  sim_block& operator[]( uint32_t slot )
+  {
+    return _values[slot];
+  }
+
+  void simulate()
+  {
+    for ( auto const& g : _sim.gates )
+    {
+      if ( g.num_fanins <= max_tree_fanins )
+        eval_tree( g );
+      else
+        eval_patterns( g );
+    }
+  }
+
+private:
+  /*! \brief Fanins up to which the multiplexer tree (2^n - 1 block operations) beats evaluating 512 patterns one by one. */
+  static constexpr uint32_t max_tree_fanins = 10u;
+
+  /* Shannon expansion bottom-up: entry j of level v is the cofactor of the
+   * truth table by the minterm bits v and up of j*2^v, so level n is `f`. */
+  void eval_tree( sim_network::gate const& g )
+  {
+    auto const size = 1u << g.num_fanins;
+    _tree.resize( size );
+    auto const tt = _sim.tt_words.data() + g.tt_begin;
+    for ( auto m = 0u; m < size; ++m )
+    {
+      _tree[m].words.fill( ( tt[m >> 6u] >> ( m & 63u ) ) & 1u ? ~uint64_t( 0 ) : 0u );
+    }
+    auto const fanins = _sim.fanins.data() + g.fanin_begin;
+    for ( auto v = 0u; v < g.num_fanins; ++v )
+    {
+      auto const& x = _values[fanins[v]].words;
+      for ( auto j = 0u; j < ( size >> ( v + 1u ) ); ++j )
+      {
+        auto const& lo = _tree[2u * j].words;
+        auto const& hi = _tree[2u * j + 1u].words;
+        auto& out = _tree[j].words;
+        for ( auto w = 0u; w < sim_block_words; ++w )
+        {
+          out[w] = ( x[w] & hi[w] ) | ( ~x[w] & lo[w] );
+        }
+      }
+    }
+    _values[g.slot] = _tree[0];
+  }
+
+  void eval_patterns( sim_network::gate const& g )
+  {
+    auto const tt = _sim.tt_words.data() + g.tt_begin;
+    auto const fanins = _sim.fanins.data() + g.fanin_begin;
+    auto& out = _values[g.slot].words;
+    for ( auto w = 0u; w < sim_block_words; ++w )
+    {
+      uint64_t word = 0u;
+      for ( auto b = 0u; b < 64u; ++b )
+      {
+        uint64_t m = 0u;
+        for ( auto v = 0u; v < g.num_fanins; ++v )
+        {
+          m |= ( ( _values[fanins[v]].words[w] >> b ) & 1u ) << v;
+        }
+        word |= ( ( tt[m >> 6u] >> ( m & 63u ) ) & 1u ) << b;
+      }
+      out[w] = word;
+    }
+  }
+
+  sim_network const& _sim;
+  std::vector<sim_block> _values;
+  std::vector<sim_block> _tree;
+};
+
+inline uint64_t splitmix64( uint64_t& state )
+{
+  auto z = ( state += 0x9e3779b97f4a7c15u );
+  z = ( z ^ ( z >> 30u ) ) * 0xbf58476d1ce4e5b9u;
+  z = ( z ^ ( z >> 27u ) ) * 0x94d049bb133111ebu;
+  return z ^ ( z >> 31u );
+}
+
+} // namespace detail
+
+/*! \brief Compares the outputs of `a` and `b` on exhaustive or random patterns. */
+inline verify_result check_equivalence( sim_network const& a, sim_network const& b, verify_params const& ps = {} )
+{
+  constexpr uint64_t block_patterns = 64u * sim_block_words;
+  verify_result res;
+
+  if ( a.pis.size() != b.pis.size() )
+  {
+    res.error = "input counts differ (" + std::to_string( a.pis.size() ) + " vs " + std::to_string( b.pis.size() ) + ")";
+    return res;
+  }
+  std::unordered_map<std::string_view, uint32_t> b_pis;
+  for ( auto i = 0u; i < b.pis.size(); ++i )
+  {
+    b_pis.emplace( b.pi_names[i], i );
+  }
+  std::vector<uint32_t> pi_pairs( a.pis.size() );
+  for ( auto i = 0u; i < a.pis.size(); ++i )
+  {
+    auto const it = b_pis.find( a.pi_names[i] );
+    if ( it == b_pis.end() )
+    {
+      res.error = "input '" + a.pi_names[i] + "' is missing";
+      return res;
+    }
+    pi_pairs[i] = it->second;
+  }
+
+  /* the k-th output of a name in `a` is compared with the k-th of that name in `b` */
+  if ( a.pos.size() != b.pos.size() )
+  {
+    res.error = "output counts differ (" + std::to_string( a.pos.size() ) + " vs " + std::to_string( b.pos.size() ) + ")";
+    return res;
+  }
+  std::unordered_map<std::string_view, std::vector<uint32_t>> b_pos;
+  for ( auto i = b.pos.size(); i-- > 0u; )
+  {
+    b_pos[b.po_names[i]].push_back( static_cast<uint32_t>( i ) );
+  }
+  std::vector<uint32_t> po_pairs( a.pos.size() );
+  for ( auto i = 0u; i < a.pos.size(); ++i )
+  {
+    auto const it = b_pos.find( a.po_names[i] );
+    if ( it == b_pos.end() || it->second.empty() )
+    {
+      res.error = "output '" + a.po_names[i] + "' is missing";
+      return res;
+    }
+    po_pairs[i] = it->second.back();
+    it->second.pop_back();
+  }
+
+  auto const num_pis = static_cast<uint32_t>( a.pis.size() );
+  res.exhaustive = num_pis < 64u && ( uint64_t( 1 ) << num_pis ) <= std::max( ps.patterns, block_patterns );
+  auto const num_blocks = res.exhaustive ? std::max<uint64_t>( ( uint64_t( 1 ) << num_pis ) / block_patterns, 1u )
+                                         : ( std::max<uint64_t>( ps.patterns, 1u ) + block_patterns - 1u ) / block_patterns;
+
+  detail::block_simulator sim_a( a ), sim_b( b );
+  auto state = ps.seed;
+  for ( uint64_t block = 0u; block < num_blocks; ++block )
+  {
+    for ( auto i = 0u; i < num_pis; ++i )
+    {
+      auto& words = sim_a[a.pis[i]].words;
+      for ( auto w = 0u; w < sim_block_words; ++w )
+      {
+        if ( !res.exhaustive )
+          words[w] = detail::splitmix64( state );
+        else if ( i < 6u )
+          words[w] = detail::sim_projections[i];
+        else
+          words[w] = ( ( ( block * sim_block_words + w ) >> ( i - 6u ) ) & 1u ) ? ~uint64_t( 0 ) : 0u;
+      }
+      sim_b[b.pis[pi_pairs[i]]] = sim_a[a.pis[i]];
+    }
+    sim_a.simulate();
+    sim_b.simulate();
+
+    for ( auto o = 0u; o < a.pos.size(); ++o )
+    {
+      auto const& wa = sim_a[a.pos[o]].words;
+      auto const& wb = sim_b[b.pos[po_pairs[o]]].words;
+      for ( auto w = 0u; w < sim_block_words; ++w )
+      {
+        if ( wa[w] == wb[w] )
+        {
+          continue;
+        }
+        auto bit = 0u;
+        while ( !( ( ( wa[w] ^ wb[w] ) >> bit ) & 1u ) )
+        {
+          ++bit;
+        }
+        res.failing_output = a.po_names[o];
+        for ( auto i = 0u; i < num_pis; ++i )
+        {
+          res.counterexample.push_back( ( sim_a[a.pis[i]].words[w] >> bit ) & 1u );
+        }
+        res.patterns = block * block_patterns + w * 64u + bit + 1u;
+        return res;
+      }
+    }
+  }
+  res.patterns = std::min<uint64_t>( num_blocks * block_patterns, res.exhaustive ? uint64_t( 1 ) << num_pis : ~uint64_t( 0 ) );
+  res.equivalent = true;
+  return res;
+}
+
+} // namespace cpsat
@@ -0,0 +1,314 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include "cut_database.hpp"
+
+/* Window partitioning of a cut database (`cut_enumeration --window-size`).
+ *
+ * The exported nodes are split into runs of `window_size` consecutive nodes
+ * in topological order. A window's outputs are its nodes that are network
+ * outputs or have a structural fanout in another window; those boundary
+ * signals are forced in their own window and act as inputs of later ones.
+ * A cut stays in a window only if each leaf is a PI, a node of the window
+ * or a boundary signal of an earlier window, so every window can be solved
+ * on its own and any combination of window covers is a cover of the
+ * network. All windows keep the node indices of the network, so
+ * `merge_windows` stitches them back into one database and the chosen cut
+ * indices of each window stay valid.
+ *
+ * The manifest lists the window files relative to its own directory:
+ *
+ *   {"window_size": S, "outputs": [name, ...], "output_indices": [index, ...],
+ *    "windows": [{"cuts": file, "chosen": file, "nodes": n, "cuts_count": c,
+ *                 "inputs": i, "outputs": o}, ...]}
+ *
+ * `outputs` are the network outputs, which become the POs of the stitched
+ * network.
+ */
+namespace cpsat
+{
+
+constexpr uint32_t no_window = std::numeric_limits<uint32_t>::max();
+
+/*! \brief Window assignment and boundary signals of a cut database. */
+class cut_windows
+{
+public:
+  /*! \brief Splits `db`, exported from `ntk`, into windows of `window_size` nodes. */
+  template<class Ntk>
+  cut_windows( Ntk const& ntk, cut_database_view const& db, uint32_t window_size )
+      : _db( db ), _window_size( std::max( window_size, 1u ) ), _window( db.num_names, no_window ), _boundary( db.num_names, false )
+  {
+    for ( auto i = 0u; i < db.num_nodes; ++i )
+    {
+      _window[db.nodes[i].index] = i / _window_size;
+    }
+    for ( auto i = 0u; i < db.num_nodes; ++i )
+    {
+      auto const idx = db.nodes[i].index;
+      ntk.foreach_fanin( ntk.index_to_node( idx ), [&]( auto const& f ) {
+        auto const leaf = ntk.node_to_index( ntk.get_node( f ) );
+        if ( _window[leaf] != no_window && _window[leaf] != _window[idx] )
+        {
+          _boundary[leaf] = true;
+        }
+      } );
+    }
+    for ( auto i = 0u; i < db.num_outputs; ++i )
+    {
+      if ( _window[db.outputs[i]] != no_window )
+      {
+        _boundary[db.outputs[i]] = true;
+      }
+    }
+  }
+
+  uint32_t num_windows() const
+  {
+    return ( _db.num_nodes + _window_size - 1u ) / _window_size;
+  }
+
+  /*! \brief Number of window outputs over all windows. */
+  uint64_t num_boundary_signals() const
+  {
+    return static_cast<uint64_t>( std::count( _boundary.begin(), _boundary.end(), true ) );
+  }
+
+  /*! \brief Cut database of window `w`; cuts with a leaf outside the window's inputs are left out and counted in `dropped_cuts`.
+   *
+   * Node and cut flags are kept: forced marks only get stronger when cuts
+   * are removed. The level bounds are reset to 0 because they were measured
+   * against the network's inputs and outputs, not the window's. The name
+   * table covers the indices up to the largest one the window uses; other
+   * names are left empty.
+   */
+  cut_database database( uint32_t w, uint64_t& dropped_cuts ) const
+  {
+    auto leaf_allowed = [&]( uint32_t leaf ) {
+      return _window[leaf] == no_window || _window[leaf] == w || ( _window[leaf] < w && _boundary[leaf] );
+    };
+
+    cut_database out;
+    out.cut_size = _db.cut_size;
+    out.cut_limit = _db.cut_limit;
+    out.priority = _db.priority;
+    out.top_n = _db.top_n;
+    out.enumeration = _db.enumeration | enumeration_windowed;
+    std::vector<bool> named( _db.num_names, false );
+    uint32_t num_names = 0u;
+    auto const end = std::min( _db.num_nodes, ( w + 1u ) * _window_size );
+    for ( auto i = w * _window_size; i < end; ++i )
+    {
+      auto const& nd = _db.nodes[i];
+      out.begin_node( nd.index );
+      out.nodes.back().flags = nd.flags;
+      out.nodes.back().signature = nd.signature;
+      named[nd.index] = true;
+      num_names = std::max( num_names, nd.index + 1u );
+      if ( _boundary[nd.index] )
+      {
+        out.outputs.push_back( nd.index );
+      }
+      for ( auto cut = _db.cuts_begin( nd ); cut != _db.cuts_end( nd ); ++cut )
+      {
+        if ( !std::all_of( _db.leaves_begin( *cut ), _db.leaves_end( *cut ), leaf_allowed ) )
+        {
+          ++dropped_cuts;
+          continue;
+        }
+        out.add_cut( _db.leaves_begin( *cut ), _db.leaves_end( *cut ), _db.tt_begin( *cut ),
+                     cut->inv_cost, cut->area_cost, cut->depth_cost, cut->shared_cost, cut->cone_area, cut->cone_depth );
+        out.cuts.back().flags = cut->flags;
+        for ( auto leaf = _db.leaves_begin( *cut ); leaf != _db.leaves_end( *cut ); ++leaf )
+        {
+          if ( !named[*leaf] && _window[*leaf] != w )
+          {
+            out.inputs.push_back( *leaf );
+          }
+          named[*leaf] = true;
+          num_names = std::max( num_names, *leaf + 1u );
+        }
+      }
+      out.end_node();
+    }
+    std::sort( out.inputs.begin(), out.inputs.end() );
+
+    for ( auto i = 0u; i < num_names; ++i )
+    {
+      out.add_name( named[i] ? _db.name( i ) : std::string_view() );
+    }
+    return out;
+  }
+
+private:
+  cut_database_view const& _db;
+  uint32_t _window_size;
+  std::vector<uint32_t> _window;
+  std::vector<bool> _boundary;
+};
+
+/*! \brief Stitches window databases back into one with the network `outputs`; windows must be given in window order. */
+inline cut_database merge_windows( std::vector<cut_database_view> const& windows, std::vector<uint32_t> const& outputs,
+                                   std::vector<std::string> const& output_names )
+{
+  cut_database out;
+  if ( !windows.empty() )
+  {
+    out.cut_size = windows.front().cut_size;
+    out.cut_limit = windows.front().cut_limit;
+    out.priority = windows.front().priority;
+    out.top_n = windows.front().top_n;
+    out.enumeration = windows.front().enumeration;
+  }
+
+  uint32_t num_names = 0u;
+  for ( auto o : outputs )
+  {
+    num_names = std::max( num_names, o + 1u );
+  }
+  for ( auto const& db : windows )
+  {
+    num_names = std::max( num_names, db.num_names );
+  }
+  std::vector<std::string_view> names( num_names );
+  std::vector<bool> is_node( num_names, false );
+  for ( auto const& db : windows )
+  {
+    for ( auto i = 0u; i < db.num_nodes; ++i )
+    {
+      auto const& nd = db.nodes[i];
+      is_node[nd.index] = true;
+      names[nd.index] = db.name( nd.index );
+      out.begin_node( nd.index );
+      out.nodes.back().flags = nd.flags;
+      out.nodes.back().signature = nd.signature;
+      for ( auto cut = db.cuts_begin( nd ); cut != db.cuts_end( nd ); ++cut )
+      {
+        out.add_cut( db.leaves_begin( *cut ), db.leaves_end( *cut ), db.tt_begin( *cut ),
+                     cut->inv_cost, cut->area_cost, cut->depth_cost, cut->shared_cost, cut->cone_area, cut->cone_depth );
+        out.cuts.back().flags = cut->flags;
+      }
+      out.end_node();
+    }
+  }
+
+  /* network inputs are the window inputs that no window implements */
+  std::vector<bool> is_input( num_names, false );
+  for ( auto const& db : windows )
+  {
+    for ( auto i = 0u; i < db.num_inputs; ++i )
+    {
+      auto const idx = db.inputs[i];
+      if ( !is_node[idx] && !is_input[idx] )
+      {
+        is_input[idx] = true;
+        names[idx] = db.name( idx );
+        out.inputs.push_back( idx );
+      }
+    }
+  }
+  std::sort( out.inputs.begin(), out.inputs.end() );
+
+  out.outputs = outputs;
+  for ( auto i = 0u; i < outputs.size() && i < output_names.size(); ++i )
+  {
+    names[outputs[i]] = output_names[i];
+  }
+  for ( auto const& name : names )
+  {
+    out.add_name( name );
+  }
+  return out;
+}
+
+/*! \brief One window of a manifest; paths are resolved against the manifest's directory. */
+struct window_entry
+{
+  std::string cuts;
+  std::string chosen;
+  uint32_t nodes{ 0u };
+  uint32_t cuts_count{ 0u };
+  uint32_t inputs{ 0u };
+  uint32_t outputs{ 0u };
+};
+
+struct window_manifest
+{
+  uint32_t window_size{ 0u };
+  std::vector<uint32_t> outputs;
+  std::vector<std::string> output_names;
+  std::vector<window_entry> windows;
+};
+
+inline bool write_window_manifest( window_manifest const& manifest, std::string const& filename )
+{
+  nlohmann::json windows = nlohmann::json::array();
+  for ( auto const& w : manifest.windows )
+  {
+    windows.push_back( { { "cuts", w.cuts }, { "chosen", w.chosen }, { "nodes", w.nodes }, { "cuts_count", w.cuts_count },
+                         { "inputs", w.inputs }, { "outputs", w.outputs } } );
+  }
+  nlohmann::json j;
+  j["window_size"] = manifest.window_size;
+  j["outputs"] = manifest.output_names;
+  j["output_indices"] = manifest.outputs;
+  j["windows"] = std::move( windows );
+  std::ofstream os( filename );
+  os << j.dump( 2 ) << "\n";
+  return static_cast<bool>( os );
+}
+
+/*! \brief Reads a manifest; `cuts` and `chosen` come back as paths relative to the working directory. */
+inline bool read_window_manifest( std::string const& filename, window_manifest& manifest, std::string& error )
+{
+  std::ifstream is( filename );
+  if ( !is )
+  {
+    error = "cannot open '" + filename + "'";
+    return false;
+  }
+  try
+  {
+    nlohmann::json j;
+    is >> j;
+    if ( !j.contains( "windows" ) || !j.contains( "output_indices" ) )
+    {
+      error = "missing 'windows' or 'output_indices'";
+      return false;
+    }
+    auto const dir = std::filesystem::path( filename ).parent_path();
+    manifest = {};
+    manifest.window_size = j.value( "window_size", 0u );
+    manifest.outputs = j["output_indices"].get<std::vector<uint32_t>>();
+    manifest.output_names = j.value( "outputs", std::vector<std::string>{} );
+    for ( auto const& w : j["windows"] )
+    {
+      window_entry entry;
+      entry.cuts = ( dir / w["cuts"].get<std::string>() ).string();
+      entry.chosen = ( dir / w["chosen"].get<std::string>() ).string();
+      entry.nodes = w.value( "nodes", 0u );
+      entry.cuts_count = w.value( "cuts_count", 0u );
+      entry.inputs = w.value( "inputs", 0u );
+      entry.outputs = w.value( "outputs", 0u );
+      manifest.windows.push_back( std::move( entry ) );
+    }
+  }
+  catch ( nlohmann::json::exception const& e )
+  {
+    error = e.what();
+    return false;
+  }
+  return true;
+}
+
+} // namespace cpsat
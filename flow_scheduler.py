@@ -0,0 +1,190 @@
+"""Job queue that runs the pipeline stages of many designs concurrently.
+
+Each design contributes a chain of stage jobs (cut enumeration -> CP-SAT ->
+rebuild). A job is a command line plus the number of cores it occupies; the
+scheduler starts a job as soon as its predecessor has finished and a worker
+has enough free cores, so the single-core C++ stages of one design overlap
+with the multi-core solve of another. Workers are the local machine and
+optionally remote hosts reached over ssh; remote hosts must see the same
+paths (shared file system), since stages hand their cut databases and
+results to each other as files.
+"""
+
+import shlex
+import subprocess
+import threading
+import time
+from pathlib import Path
+
+
+class Worker:
+    """A machine with a core budget; `host` None runs commands locally."""
+
+    def __init__(self, host, cores):
+        self.host = host
+        self.cores = max(1, int(cores))
+        self.free = self.cores
+
+    @property
+    def name(self):
+        return self.host or "local"
+
+    def command(self, cmd, cwd):
+        if self.host is None:
+            return [str(c) for c in cmd]
+        remote = f"cd {shlex.quote(str(cwd))} && " + " ".join(shlex.quote(str(c)) for c in cmd)
+        return ["ssh", "-o", "BatchMode=yes", self.host, remote]
+
+
+class Job:
+    """One stage of one design.
+
+    `cmd` is either a command line or a callable returning one, called with
+    the number of cores the job was granted when it starts (so it can depend
+    on earlier results and on a worker smaller than `cores`). `on_done`
+    receives the job after it ran and returns False to cancel the
+    successors of the design.
+    """
+
+    def __init__(self, design, stage, cmd, cores=1, log_path=None, on_done=None):
+        self.design = design
+        self.stage = stage
+        self.cmd = cmd
+        self.cores = max(1, int(cores))
+        self.log_path = log_path
+        self.on_done = on_done
+        self.next = None
+        self.returncode = None
+        self.seconds = 0.0
+        self.worker = None
+
+
+def parse_workers(local_cores, hosts):
+    """Workers from `--cores N` and `--hosts host:cores,...` (cores default to the local budget)."""
+    workers = []
+    if local_cores:
+        workers.append(Worker(None, local_cores))
+    for entry in (hosts or "").split(","):
+        entry = entry.strip()
+        if not entry:
+            continue
+        host, _, cores = entry.partition(":")
+        workers.append(Worker(host, int(cores) if cores else (local_cores or 1)))
+    if not workers:
+        workers.append(Worker(None, 1))
+    return workers
+
+
+def parse_stage_cores(spec, defaults):
+    """`stage=cores,...` over `defaults`, e.g. `solve=8,enum=1`."""
+    cores = dict(defaults)
+    for entry in (spec or "").split(","):
+        entry = entry.strip()
+        if not entry:
+            continue
+        stage, _, value = entry.partition("=")
+        if stage not in cores or not value.isdigit() or int(value) < 1:
+            raise ValueError(f"invalid --stage-cores entry '{entry}' (stages: {', '.join(cores)})")
+        cores[stage] = int(value)
+    return cores
+
+
+class Scheduler:
+    """Runs job chains on a set of workers; later stages are preferred so finished designs leave the queue early."""
+
+    def __init__(self, workers, cwd=None):
+        self.workers = workers
+        self.cwd = Path(cwd or Path.cwd()).resolve()
+        self._ready = []
+        self._running = 0
+        # "design:stage: error" of jobs that raised instead of running to completion
+        self.errors = []
+        self._cond = threading.Condition()
+        self._order = 0
+
+    def add_chain(self, jobs):
+        """Queue jobs that run one after another; returns the first."""
+        for job, successor in zip(jobs, jobs[1:]):
+            job.next = successor
+        with self._cond:
+            if jobs:
+                self._push(jobs[0], depth=0)
+        return jobs[0] if jobs else None
+
+    def _push(self, job, depth):
+        self._order += 1
+        # deeper stages first, then first come first served
+        self._ready.append((-depth, self._order, job))
+        self._ready.sort(key=lambda item: (item[0], item[1]))
+
+    def _pick(self):
+        """Next ready job and a worker that fits it, or None; called with the lock held."""
+        largest = max(worker.cores for worker in self.workers)
+        for pos, (neg_depth, _, job) in enumerate(self._ready):
+            for worker in self.workers:
+                # a job larger than every worker runs alone on the largest one
+                if job.cores > worker.cores and worker.cores < largest:
+                    continue
+                need = min(job.cores, worker.cores)
+                if worker.free >= need:
+                    worker.free -= need
+                    del self._ready[pos]
+                    return job, worker, need, -neg_depth
+        return None
+
+    def run(self):
+        """Blocks until every queued job has run or been cancelled."""
+        with self._cond:
+            while self._ready or self._running:
+                picked = self._pick()
+                if picked is None:
+                    self._cond.wait()
+                    continue
+                job, worker, need, depth = picked
+                self._running += 1
+                threading.Thread(target=self._execute, args=(job, worker, need, depth), daemon=True).start()
+
+    def _execute(self, job, worker, need, depth):
+        ok = False
+        try:
+            ok = self._run_job(job, worker, need)
+        except Exception as exc:
+            with self._cond:
+                self.errors.append(f"{job.design}:{job.stage}: {exc}")
+            print(f"[sched] error {job.design}:{job.stage}: {exc}", flush=True)
+        finally:
+            with self._cond:
+                worker.free += need
+                self._running -= 1
+                if ok and job.next is not None:
+                    self._push(job.next, depth + 1)
+                elif job.next is not None:
+                    print(f"[sched] skip  {job.design}: stages after {job.stage} cancelled", flush=True)
+                self._cond.notify_all()
+
+    def _run_job(self, job, worker, need):
+        """Runs `job` on `need` cores of `worker`; returns whether its successors may run."""
+        job.worker = worker.name
+        cmd = job.cmd(need) if callable(job.cmd) else job.cmd
+        if cmd:
+            full_cmd = worker.command(cmd, self.cwd)
+            print(f"[sched] start {job.design}:{job.stage} on {worker.name} ({need} cores)", flush=True)
+            start = time.perf_counter()
+            if job.log_path:
+                with open(job.log_path, "w") as log:
+                    log.write("[run] " + " ".join(str(c) for c in full_cmd) + "\n")
+                    log.flush()
+                    proc = subprocess.run(full_cmd, cwd=self.cwd, stdout=log, stderr=subprocess.STDOUT)
+            else:
+                proc = subprocess.run(full_cmd, cwd=self.cwd)
+            job.seconds = time.perf_counter() - start
+            job.returncode = proc.returncode
+            print(
+                f"[sched] done  {job.design}:{job.stage} rc={job.returncode} {job.seconds:.2f}s",
+                flush=True,
+            )
+        else:
+            job.returncode = 0
+        if job.on_done is not None:
+            return job.on_done(job) is not False
+        return job.returncode == 0
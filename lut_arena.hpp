@@ -0,0 +1,434 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <kitty/dynamic_truth_table.hpp>
+
+#include "cut_database.hpp"
+
+/* Flat k-LUT netlist for the rebuild (`rebuild_from_cpsat --arena`).
+ *
+ * LUT fanins, truth tables and PI/PO names live in a few arrays sized up
+ * front from the chosen cuts, so building a LUT is two appends and no
+ * allocation. Like `klut_network::create_node`, a LUT with the same fanins
+ * and function as an existing one is not created again; the hash table is
+ * sized with the arrays. Signals are numbered 0 and 1 for the constants,
+ * then the PIs, then the LUTs in creation order; all PIs are created before
+ * the first LUT. `write_blif` writes the netlist straight from these arrays in the
+ * layout of mockturtle's `write_blif`: internal nodes are `new_n<signal>`,
+ * each PO is a buffer from its driver, and the covers are irredundant sums
+ * of products (Minato-Morreale on 64-bit words; wider LUTs split on their
+ * upper variables first).
+ */
+namespace cpsat
+{
+
+namespace detail
+{
+
+/*! \brief Copies the `2^num_vars` low bits of `word` over the whole word, so variables `num_vars` and up are don't cares. */
+inline uint64_t replicate_word( uint64_t word, uint32_t num_vars )
+{
+  for ( auto v = num_vars; v < 6u; ++v )
+  {
+    word = ( word & ( ( uint64_t( 1 ) << ( 1u << v ) ) - 1u ) ) | ( word << ( 1u << v ) );
+  }
+  return word;
+}
+
+/*! \brief Minato-Morreale ISOP of a function between `lower` and `upper` over variables `[0, num_vars)`; returns the cover.
+ *
+ * Both words must not depend on variables `num_vars` and up (see
+ * `replicate_word`). Each cube is appended to `cubes` as (literal mask,
+ * literal polarities).
+ */
+inline uint64_t word_isop( uint64_t lower, uint64_t upper, uint32_t num_vars, uint32_t mask, uint32_t bits,
+                           std::vector<std::pair<uint32_t, uint32_t>>& cubes )
+{
+  static constexpr uint64_t projections[] = { 0xaaaaaaaaaaaaaaaau, 0xccccccccccccccccu, 0xf0f0f0f0f0f0f0f0u,
+                                              0xff00ff00ff00ff00u, 0xffff0000ffff0000u, 0xffffffff00000000u };
+  if ( lower == 0u )
+  {
+    return 0u;
+  }
+  if ( upper == ~uint64_t( 0 ) )
+  {
+    cubes.emplace_back( mask, bits );
+    return ~uint64_t( 0 );
+  }
+  auto var = num_vars;
+  uint64_t neg = 0u, pos = 0u;
+  while ( var-- > 0u )
+  {
+    pos = projections[var];
+    neg = ~pos;
+    auto const shift = 1u << var;
+    if ( ( ( lower & pos ) >> shift ) != ( lower & neg ) || ( ( upper & pos ) >> shift ) != ( upper & neg ) )
+    {
+      break;
+    }
+  }
+  auto const shift = 1u << var;
+  auto cofactor0 = [&]( uint64_t t ) { return ( t & neg ) | ( ( t & neg ) << shift ); };
+  auto cofactor1 = [&]( uint64_t t ) { return ( t & pos ) | ( ( t & pos ) >> shift ); };
+  auto const l0 = cofactor0( lower ), l1 = cofactor1( lower );
+  auto const u0 = cofactor0( upper ), u1 = cofactor1( upper );
+
+  auto const f0 = word_isop( l0 & ~u1, u0, var, mask | ( 1u << var ), bits, cubes );
+  auto const f1 = word_isop( l1 & ~u0, u1, var, mask | ( 1u << var ), bits | ( 1u << var ), cubes );
+  auto const rest = ( l0 & ~f0 ) | ( l1 & ~f1 );
+  auto const f2 = word_isop( rest, u0 & u1, var, mask, bits, cubes );
+  return ( f0 & neg ) | ( f1 & pos ) | f2;
+}
+
+} // namespace detail
+
+class lut_arena
+{
+public:
+  using signal = uint32_t;
+  using node = uint32_t;
+
+  struct lut
+  {
+    uint32_t fanin_begin;
+    uint32_t num_fanins;
+    uint32_t tt_begin;
+  };
+
+  void reserve( uint32_t num_pis, uint32_t num_pos, uint64_t num_luts, uint64_t num_fanins, uint64_t num_tt_words, uint64_t name_bytes )
+  {
+    _luts.reserve( num_luts );
+    _fanins.reserve( num_fanins );
+    _tt_words.reserve( num_tt_words );
+    _names.reserve( name_bytes );
+    _name_offsets.reserve( num_pis + num_pos + 1u );
+    _pos.reserve( num_pos );
+    if ( _table.size() < 2u * num_luts )
+    {
+      rehash( num_luts );
+    }
+  }
+
+  signal get_constant( bool value ) const
+  {
+    return value ? 1u : 0u;
+  }
+
+  node get_node( signal s ) const
+  {
+    return s;
+  }
+
+  bool is_constant( node n ) const
+  {
+    return n < 2u;
+  }
+
+  bool constant_value( node n ) const
+  {
+    return n == 1u;
+  }
+
+  signal create_pi( std::string_view name )
+  {
+    add_name( name );
+    return 2u + _num_pis++;
+  }
+
+  /*! \brief LUT over the signals `[leaves_begin, leaves_end)` with the truth table words at `tt_begin`. */
+  template<typename LeafIt, typename WordIt>
+  signal create_lut( LeafIt leaves_begin, LeafIt leaves_end, WordIt tt_begin )
+  {
+    auto const num_fanins = static_cast<uint32_t>( leaves_end - leaves_begin );
+    auto const tt_end = tt_begin + tt_num_words( num_fanins );
+    if ( 2u * ( _luts.size() + 1u ) > _table.size() )
+    {
+      rehash( 2u * _luts.size() + 16u );
+    }
+    auto const mask = _table.size() - 1u;
+    auto slot = hash( leaves_begin, leaves_end, tt_begin, tt_end ) & mask;
+    for ( ; _table[slot] != 0u; slot = ( slot + 1u ) & mask )
+    {
+      auto const& other = _luts[_table[slot] - 1u];
+      if ( other.num_fanins == num_fanins &&
+           std::equal( leaves_begin, leaves_end, _fanins.begin() + other.fanin_begin ) &&
+           std::equal( tt_begin, tt_end, _tt_words.begin() + other.tt_begin ) )
+      {
+        return lut_signal( _table[slot] - 1u );
+      }
+    }
+
+    lut l;
+    l.fanin_begin = static_cast<uint32_t>( _fanins.size() );
+    l.num_fanins = num_fanins;
+    l.tt_begin = static_cast<uint32_t>( _tt_words.size() );
+    _fanins.insert( _fanins.end(), leaves_begin, leaves_end );
+    _tt_words.insert( _tt_words.end(), tt_begin, tt_end );
+    _luts.push_back( l );
+    _table[slot] = static_cast<uint32_t>( _luts.size() );
+    return lut_signal( static_cast<uint32_t>( _luts.size() ) - 1u );
+  }
+
+  /*! \brief `create_node` of a k-LUT network, for `detail::lut_strash`. */
+  signal create_node( std::vector<signal> const& leaves, kitty::dynamic_truth_table const& tt )
+  {
+    return create_lut( leaves.begin(), leaves.end(), tt.cbegin() );
+  }
+
+  void create_po( signal driver, std::string_view name )
+  {
+    add_name( name );
+    _pos.push_back( driver );
+  }
+
+  /*! \brief Constants, PIs and LUTs, as `klut_network::size` counts them. */
+  uint32_t size() const
+  {
+    return 2u + _num_pis + num_luts();
+  }
+
+  uint32_t num_pis() const
+  {
+    return _num_pis;
+  }
+
+  uint32_t num_pos() const
+  {
+    return static_cast<uint32_t>( _pos.size() );
+  }
+
+  uint32_t num_luts() const
+  {
+    return static_cast<uint32_t>( _luts.size() );
+  }
+
+  /*! \brief LUT `i` in creation order; its signal is `2 + num_pis() + i`. */
+  lut const& lut_at( uint32_t i ) const
+  {
+    return _luts[i];
+  }
+
+  signal const* fanins_begin( lut const& l ) const
+  {
+    return _fanins.data() + l.fanin_begin;
+  }
+
+  signal const* fanins_end( lut const& l ) const
+  {
+    return _fanins.data() + l.fanin_begin + l.num_fanins;
+  }
+
+  uint64_t const* tt_begin( lut const& l ) const
+  {
+    return _tt_words.data() + l.tt_begin;
+  }
+
+  signal po_driver( uint32_t i ) const
+  {
+    return _pos[i];
+  }
+
+  std::string_view pi_name( uint32_t i ) const
+  {
+    return name( i );
+  }
+
+  std::string_view po_name( uint32_t i ) const
+  {
+    return name( _num_pis + i );
+  }
+
+  bool is_pi( signal s ) const
+  {
+    return s >= 2u && s < 2u + _num_pis;
+  }
+
+  bool write_blif( std::string const& filename ) const
+  {
+    std::vector<char> buffer( 1u << 20u );
+    std::ofstream os;
+    os.rdbuf()->pubsetbuf( buffer.data(), static_cast<std::streamsize>( buffer.size() ) );
+    os.open( filename );
+    if ( !os )
+    {
+      return false;
+    }
+
+    bool used_constant[2] = { false, false };
+    for ( auto f : _fanins )
+    {
+      if ( f < 2u )
+        used_constant[f] = true;
+    }
+    for ( auto d : _pos )
+    {
+      if ( d < 2u )
+        used_constant[d] = true;
+    }
+
+    os << ".model top\n.inputs";
+    for ( auto i = 0u; i < _num_pis; ++i )
+    {
+      os << ' ' << name( i );
+    }
+    os << "\n.outputs";
+    for ( auto i = 0u; i < _pos.size(); ++i )
+    {
+      os << ' ' << name( _num_pis + i );
+    }
+    os << "\n";
+    if ( used_constant[0] )
+    {
+      os << ".names new_n0\n";
+    }
+    if ( used_constant[1] )
+    {
+      os << ".names new_n1\n1\n";
+    }
+
+    std::vector<std::pair<uint32_t, uint32_t>> cubes;
+    for ( auto i = 0u; i < _luts.size(); ++i )
+    {
+      auto const& l = _luts[i];
+      os << ".names";
+      for ( auto f = l.fanin_begin; f < l.fanin_begin + l.num_fanins; ++f )
+      {
+        os << ' ';
+        write_signal( os, _fanins[f] );
+      }
+      os << " new_n" << ( 2u + _num_pis + i ) << "\n";
+      write_cover( os, l, cubes );
+    }
+
+    for ( auto i = 0u; i < _pos.size(); ++i )
+    {
+      auto const po_name = name( _num_pis + i );
+      if ( is_pi( _pos[i] ) && name( _pos[i] - 2u ) == po_name )
+      {
+        continue; // an output that is the input of the same name needs no buffer
+      }
+      os << ".names ";
+      write_signal( os, _pos[i] );
+      os << ' ' << po_name << "\n1 1\n";
+    }
+    os << ".end\n";
+    os.flush();
+    return static_cast<bool>( os );
+  }
+
+private:
+  signal lut_signal( uint32_t lut_index ) const
+  {
+    return 2u + _num_pis + lut_index;
+  }
+
+  template<typename LeafIt, typename WordIt>
+  static uint64_t hash( LeafIt leaves_begin, LeafIt leaves_end, WordIt tt_begin, WordIt tt_end )
+  {
+    uint64_t h = 0xcbf29ce484222325u;
+    auto mix = [&]( uint64_t v ) {
+      h = ( h ^ v ) * 0x100000001b3u;
+      h ^= h >> 29u;
+    };
+    for ( auto it = leaves_begin; it != leaves_end; ++it )
+    {
+      mix( *it );
+    }
+    for ( auto it = tt_begin; it != tt_end; ++it )
+    {
+      mix( *it );
+    }
+    return h;
+  }
+
+  /*! \brief Resizes the table to a power of two of at least twice `num_luts` slots. */
+  void rehash( uint64_t num_luts )
+  {
+    std::size_t size = 16u;
+    while ( size < 2u * num_luts )
+    {
+      size *= 2u;
+    }
+    _table.assign( size, 0u );
+    auto const mask = size - 1u;
+    for ( auto i = 0u; i < _luts.size(); ++i )
+    {
+      auto const& l = _luts[i];
+      auto const leaves = _fanins.begin() + l.fanin_begin;
+      auto const words = _tt_words.begin() + l.tt_begin;
+      auto slot = hash( leaves, leaves + l.num_fanins, words, words + tt_num_words( l.num_fanins ) ) & mask;
+      while ( _table[slot] != 0u )
+      {
+        slot = ( slot + 1u ) & mask;
+      }
+      _table[slot] = i + 1u;
+    }
+  }
+
+  void add_name( std::string_view name )
+  {
+    if ( _name_offsets.empty() )
+    {
+      _name_offsets.push_back( 0u );
+    }
+    _names.append( name.data(), name.size() );
+    _name_offsets.push_back( static_cast<uint32_t>( _names.size() ) );
+  }
+
+  std::string_view name( uint32_t i ) const
+  {
+    return std::string_view( _names ).substr( _name_offsets[i], _name_offsets[i + 1u] - _name_offsets[i] );
+  }
+
+  void write_signal( std::ostream& os, signal s ) const
+  {
+    if ( is_pi( s ) )
+      os << name( s - 2u );
+    else
+      os << "new_n" << s;
+  }
+
+  /*! \brief ON-set cover of `l`, one cube row per line; variables 6 and up are fixed per 64-bit block. */
+  void write_cover( std::ostream& os, lut const& l, std::vector<std::pair<uint32_t, uint32_t>>& cubes ) const
+  {
+    auto const n = l.num_fanins;
+    auto const word_vars = std::min( n, 6u );
+    for ( auto b = 0u; b < tt_num_words( n ); ++b )
+    {
+      auto const word = detail::replicate_word( _tt_words[l.tt_begin + b], word_vars );
+      cubes.clear();
+      detail::word_isop( word, word, word_vars, 0u, 0u, cubes );
+      for ( auto const& [mask, bits] : cubes )
+      {
+        for ( auto v = 0u; v < n; ++v )
+        {
+          if ( v >= 6u )
+            os << ( ( b >> ( v - 6u ) ) & 1u ? '1' : '0' );
+          else if ( ( mask >> v ) & 1u )
+            os << ( ( bits >> v ) & 1u ? '1' : '0' );
+          else
+            os << '-';
+        }
+        os << ( n > 0u ? " 1\n" : "1\n" );
+      }
+    }
+  }
+
+  uint32_t _num_pis{ 0u };
+  std::vector<lut> _luts;
+  std::vector<signal> _fanins;
+  std::vector<uint64_t> _tt_words;
+  std::vector<signal> _pos;
+  std::string _names;
+  std::vector<uint32_t> _name_offsets;
+  std::vector<uint32_t> _table; /* LUT index + 1 per slot, 0 if empty */
+};
+
+} // namespace cpsat
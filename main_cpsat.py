@@ -1,7 +1,10 @@
 import json
+import mmap
 import os
 import shutil
+import struct
 import subprocess
+import sys
 import tempfile
 from pathlib import Path
 
@@ -78,12 +81,177 @@ def _generate_cuts_json_from_blif(blif_path, binary_hint=None, cut_size=None):
     return tmp_path
 
 
-def _load_cuts_data(cuts_path, binary_hint=None, cut_size=None):
-    """Load cut data either directly from JSON or via BLIF conversion."""
+# Binary cut database written by `cut_enumeration --format binary`; layout in cut_database.hpp.
+CUT_DB_MAGIC = b"CPSATCDB"
+CUT_DB_VERSION = 7
+# Names of the header's cut_priority values (cut_priority enum in cut_database.hpp).
+CUT_PRIORITIES = ("none", "area", "inv", "depth")
+_CUT_DB_HEADER = struct.Struct("<8s12I2Q8Q")
+# node_record words; the last two hold the 64-bit structural signature.
+_CUT_DB_NODE_FIELDS = 8
+_CUT_DB_CUT_FIELDS = 10
+# node_record / cut_record flag bits (node_flags, cut_flags in cut_database.hpp).
+_NODE_FORCED = 1
+_CUT_FORCED = 1
+_CUT_INFEASIBLE = 2
+# node_record::height of a node no output can use (no_level in cut_database.hpp).
+NO_LEVEL = 0xFFFFFFFF
+
+
+def _is_cut_database(path):
+    with open(path, "rb") as f:
+        return f.read(len(CUT_DB_MAGIC)) == CUT_DB_MAGIC
+
+
+def _check_cut_database(path, condition, what):
+    """Raises the error of a corrupt cut database unless `condition` holds (`mapped_cut_database::validate`)."""
+    if not condition:
+        raise ValueError(f"Cut database '{path}' is corrupt: {what}")
+
+
+def _read_cut_database(path):
+    """Decode a binary cut database into the same dict shape as the cuts JSON.
+
+    The header, the section bounds and every index are checked as in
+    `mapped_cut_database::validate`, so a truncated or corrupt file raises a
+    ValueError naming it.
+    """
+    if sys.byteorder != "little":
+        raise ValueError("Binary cut databases are little endian; use the JSON format on this host")
+    if Path(path).stat().st_size < _CUT_DB_HEADER.size:
+        raise ValueError(f"Cut database '{path}' is truncated")
+    with open(path, "rb") as f, mmap.mmap(f.fileno(), 0, access=mmap.ACCESS_READ) as mm:
+        fields = _CUT_DB_HEADER.unpack_from(mm, 0)
+        magic, version, cut_size, cut_limit = fields[0], fields[1], fields[2], fields[3]
+        num_names, num_nodes, num_cuts, num_leaves, num_inputs, num_outputs = fields[4:10]
+        cut_priority = fields[10]
+        num_tt_words, name_bytes = fields[13], fields[14]
+        offsets = fields[15:23]
+        if magic != CUT_DB_MAGIC:
+            raise ValueError(f"'{path}' is not a cut database")
+        if version != CUT_DB_VERSION:
+            raise ValueError(
+                f"Cut database '{path}' has version {version}, expected {CUT_DB_VERSION}"
+            )
+        sizes = (
+            4 * (num_names + 1),
+            4 * _CUT_DB_NODE_FIELDS * num_nodes,
+            4 * _CUT_DB_CUT_FIELDS * num_cuts,
+            4 * num_leaves,
+            4 * num_inputs,
+            4 * num_outputs,
+            8 * num_tt_words,
+            name_bytes,
+        )
+        for section, (offset, size) in enumerate(zip(offsets, sizes)):
+            _check_cut_database(
+                path,
+                offset % 8 == 0 and offset <= len(mm) and size <= len(mm) - offset,
+                f"truncated or corrupt section {section}",
+            )
+
+        view = memoryview(mm)
+        try:
+            def u32(section, count):
+                start = offsets[section]
+                return view[start:start + 4 * count].cast("I").tolist()
+
+            name_offsets = u32(0, num_names + 1)
+            node_words = u32(1, num_nodes * _CUT_DB_NODE_FIELDS)
+            cut_words = u32(2, num_cuts * _CUT_DB_CUT_FIELDS)
+            leaves = u32(3, num_leaves)
+            inputs = u32(4, num_inputs)
+            outputs = u32(5, num_outputs)
+            chars = bytes(view[offsets[7]:offsets[7] + name_bytes])
+        finally:
+            view.release()
+
+    _check_cut_database(
+        path,
+        all(a <= b for a, b in zip(name_offsets, name_offsets[1:])) and name_offsets[-1] <= name_bytes,
+        "corrupt name table",
+    )
+    for n in range(num_nodes):
+        index, cut_begin, cut_count = node_words[_CUT_DB_NODE_FIELDS * n:_CUT_DB_NODE_FIELDS * n + 3]
+        _check_cut_database(path, index < num_names and cut_begin + cut_count <= num_cuts, f"corrupt node record {n}")
+    for c in range(num_cuts):
+        leaf_begin, leaf_count, tt_begin = cut_words[_CUT_DB_CUT_FIELDS * c:_CUT_DB_CUT_FIELDS * c + 3]
+        tt_words = 1 if leaf_count <= 6 else 1 << (leaf_count - 6)
+        _check_cut_database(
+            path,
+            leaf_begin + leaf_count <= num_leaves and leaf_count <= 31 and tt_begin + tt_words <= num_tt_words,
+            f"corrupt cut record {c}",
+        )
+    _check_cut_database(path, all(l < num_names for l in leaves), "leaf index out of range")
+    _check_cut_database(path, all(i < num_names for i in inputs), "input index out of range")
+    _check_cut_database(path, all(o < num_names for o in outputs), "output index out of range")
+
+    try:
+        names = [
+            chars[name_offsets[i]:name_offsets[i + 1]].decode()
+            for i in range(num_names)
+        ]
+    except UnicodeDecodeError as exc:
+        raise ValueError(f"Cut database '{path}' is corrupt: node name is not UTF-8 ({exc})") from None
+    nodes = []
+    for n in range(num_nodes):
+        index, cut_begin, cut_count, node_flags, min_level, height = node_words[8 * n:8 * n + 6]
+        cuts = []
+        for c in range(cut_begin, cut_begin + cut_count):
+            (leaf_begin, leaf_count, _, inv_cost, area_cost, depth_cost, shared_cost,
+             cone_area, cone_depth, cut_flags) = cut_words[10 * c:10 * c + 10]
+            cuts.append({
+                "leaves": [names[l] for l in leaves[leaf_begin:leaf_begin + leaf_count]],
+                "inv_cost": inv_cost,
+                "area_cost": area_cost,
+                "depth_cost": depth_cost,
+                "shared_cost": shared_cost,
+                "cone_area": cone_area,
+                "cone_depth": cone_depth,
+                "forced": bool(cut_flags & _CUT_FORCED),
+                "infeasible": bool(cut_flags & _CUT_INFEASIBLE),
+            })
+        nodes.append({
+            "index": index,
+            "name": names[index],
+            "forced": bool(node_flags & _NODE_FORCED),
+            "min_level": min_level,
+            "height": height,
+            "cuts": cuts,
+        })
+
+    return {
+        "nodes": nodes,
+        "outputs": [names[o] for o in outputs],
+        "inputs": [names[i] for i in inputs],
+        "cuts_per_node": cut_size,
+        "cut_limit": cut_limit,
+        "cut_priority": CUT_PRIORITIES[cut_priority] if cut_priority < len(CUT_PRIORITIES) else "none",
+    }
+
+
+def _load_cuts_data(cuts_path, binary_hint=None, cut_size=None, cut_server=None):
+    """Load cut data from a binary cut database, from JSON, or via BLIF conversion.
+
+    With `cut_server` (the socket of `cut_enumeration --socket`), a BLIF is
+    converted by that server, which keeps the parsed design between calls.
+    """
     cuts_path = Path(cuts_path)
     if not cuts_path.exists():
         raise FileNotFoundError(f"Cuts file '{cuts_path}' does not exist")
 
+    if _is_cut_database(cuts_path):
+        return _read_cut_database(cuts_path)
+
+    if cut_server is not None and cuts_path.suffix.lower() != ".json":
+        from cut_service import cuts_from_server
+
+        served = cuts_from_server(cut_server, cuts_path, cut_size=cut_size)
+        try:
+            return _read_cut_database(served)
+        finally:
+            os.unlink(served)
+
     temp_json = None
     if cuts_path.suffix.lower() != ".json":
         temp_json = _generate_cuts_json_from_blif(
@@ -112,13 +280,28 @@ def _load_cuts_data(cuts_path, binary_hint=None, cut_size=None):
 
 
 def _normalize_cuts_data(data):
-    """Ensure cuts JSON uses dict-form cuts with default costs."""
+    """Ensure cuts JSON uses dict-form cuts with default costs.
+
+    The exporter's reduction lists (`forced_nodes`, `forced_cuts`,
+    `infeasible_cuts`, `level_bounds`) become `forced` / `infeasible` flags
+    and `min_level` / `height` keys on the node and cut dicts, as the binary
+    reader sets them.
+    """
     nodes = data.get("nodes", [])
+    forced_nodes = set(data.get("forced_nodes", []))
+    forced_cuts = {tuple(c) for c in data.get("forced_cuts", [])}
+    infeasible_cuts = {tuple(c) for c in data.get("infeasible_cuts", [])}
+    level_bounds = {b[0]: (b[1], b[2]) for b in data.get("level_bounds", [])}
     normalized_nodes = []
     for nd in nodes:
+        index = nd.get("index")
         cuts = []
-        for cut in nd.get("cuts", []):
+        for i, cut in enumerate(nd.get("cuts", [])):
             if isinstance(cut, dict):
+                if (index, i) in forced_cuts or (index, i) in infeasible_cuts:
+                    cut = dict(cut)
+                    cut["forced"] = cut.get("forced", False) or (index, i) in forced_cuts
+                    cut["infeasible"] = cut.get("infeasible", False) or (index, i) in infeasible_cuts
                 cuts.append(cut)
             else:
                 # Interpret a bare list as leaves-only; fill in default costs.
@@ -130,6 +313,10 @@ def _normalize_cuts_data(data):
                 })
         nd_copy = dict(nd)
         nd_copy["cuts"] = cuts
+        if index in forced_nodes:
+            nd_copy["forced"] = True
+        if index in level_bounds:
+            nd_copy["min_level"], nd_copy["height"] = level_bounds[index]
         normalized_nodes.append(nd_copy)
     data["nodes"] = normalized_nodes
     if "inputs" not in data:
@@ -137,8 +324,25 @@ def _normalize_cuts_data(data):
     return data
 
 
+def _use_cone_costs(data):
+    """Makes `cone_area` / `cone_depth` the area and depth costs of every cut (`--cone-costs`).
+
+    Cuts without them keep their costs. The node level bounds count LUT
+    levels and stay valid: a cut spans at least one level of the input network.
+    """
+    for nd in data["nodes"]:
+        for cut in nd["cuts"]:
+            cut["area_cost"] = cut.get("cone_area", cut.get("area_cost", len(cut["leaves"])))
+            cut["depth_cost"] = cut.get("cone_depth", cut.get("depth_cost", 1))
+    return data
+
+
 def _compute_depth_upper_bound(data):
-    """Compute a heuristic depth upper bound using a greedy depth calculation."""
+    """Compute a heuristic depth upper bound using a greedy depth calculation.
+
+    Cut files with level bounds store the greedy depth of each node as
+    `min_level`; the recursion only runs for files without them.
+    """
     nodes = data.get("nodes", [])
     outputs = data.get("outputs") or []
     node_map = {nd["name"]: nd for nd in nodes}
@@ -148,7 +352,10 @@ def _compute_depth_upper_bound(data):
         elif nodes:
             outputs = [nodes[-1]["name"]]
 
-    memo = {}
+    if nodes and all("min_level" in nd for nd in nodes):
+        memo = {nd["name"]: nd["min_level"] for nd in nodes}
+    else:
+        memo = {}
     visiting = set()
 
     def depth(name):
@@ -165,7 +372,7 @@ def _compute_depth_upper_bound(data):
         best = None
         for cut in nd.get("cuts", []):
             leaves_raw = cut.get("leaves", [])
-            if len(leaves_raw) == 1 and leaves_raw[0] == name:
+            if (len(leaves_raw) == 1 and leaves_raw[0] == name) or cut.get("infeasible"):
                 # Skip self-cuts to stay consistent with model construction.
                 continue
             leaves = [l for l in leaves_raw if l != name]
@@ -200,25 +407,115 @@ def _extract_chosen_cuts(node_dicts, var_node_used, var_cut, solver):
     return chosen_cuts
 
 
+def _load_hint(hint_path, node_dicts):
+    """Chosen cut per node name from a chosen cuts JSON, e.g. the greedy cover of `cut_enumeration --hint-cover`.
+
+    Returns the cover and the names of the nodes it leaves open
+    (`open_node_indices` of a `cut_enumeration --eco-chosen` hint).
+    """
+    with open(hint_path, "r") as f:
+        data = json.load(f)
+    name_of = {nd["index"]: nd["name"] for nd in node_dicts if "index" in nd}
+    open_nodes = {name_of[idx] for idx in data.get("open_node_indices", []) if idx in name_of}
+    if "chosen_cut_indices" in data:
+        return {name_of[idx]: ci for idx, ci in data["chosen_cut_indices"] if idx in name_of}, open_nodes
+    return dict(data.get("chosen_cuts", {})), open_nodes
+
+
+def _add_hint(built, node_dicts, chosen_cuts, open_nodes=()):
+    """Hint the cover `chosen_cuts` (name -> cut index), with the levels and depth it implies in depth models.
+
+    Forced nodes and cuts are constants and get no hint; an infeasible hint
+    is repaired or ignored by CP-SAT. Nodes in `open_nodes` get no hint, and
+    neither do the levels if there are any.
+    """
+    model = built["model"]
+    level_vars = built["level_vars"]
+    level = {}
+    for nd in node_dicts:
+        nname = nd["name"]
+        if nname in open_nodes:
+            continue
+        chosen = chosen_cuts.get(nname)
+        if not nd.get("forced"):
+            model.AddHint(built["var_node_used"][nname], chosen is not None)
+        level[nname] = 0
+        for ci in built["var_cut"][nname]:
+            taken = ci["cut_index"] == chosen
+            if not ci["forced"]:
+                model.AddHint(ci["var"], taken)
+            if taken:
+                step = ci.get("depth_cost", 1) or 1
+                level[nname] = max((level.get(leaf, 0) for leaf in ci["leaves"]), default=0) + step
+    if built["D"] is not None and level_vars and not open_nodes:
+        for nname, lvl in level_vars.items():
+            model.AddHint(lvl, level.get(nname, 0))
+        model.AddHint(built["D"], max(level.values(), default=0))
+
+
+def _fix_cover(built, chosen_cuts):
+    """Fix the cuts of the cover `chosen_cuts`: a covered node that is used takes its chosen cut (`--fix-hint`).
+
+    Whether the node is used is left to the output and leaf constraints, so
+    a cover node the changed logic no longer reaches can be dropped.
+    """
+    model = built["model"]
+    for nname, chosen in chosen_cuts.items():
+        for ci in built["var_cut"].get(nname, []):
+            if ci["cut_index"] == chosen:
+                model.AddImplication(built["var_node_used"][nname], ci["var"])
+
+
 def solve_circuit(
     cuts_path,
     chosen_json_path,
     objective_mode="original",
     cut_enum_bin=None,
     cut_size=None,
+    fix_depth=None,
+    num_workers=None,
+    hint_path=None,
+    fix_hint=False,
+    cut_server=None,
+    cone_costs=False,
 ):
-    data = _load_cuts_data(cuts_path, binary_hint=cut_enum_bin, cut_size=cut_size)
+    """Solve the cut selection; `num_workers` overrides the per-phase CP-SAT worker counts.
+
+    `hint_path` is a chosen cuts JSON (e.g. `cut_enumeration --hint-out`)
+    that seeds the first solve; phase B always starts from phase A. With
+    `fix_hint` the hinted cuts are fixed in every phase, e.g. the unchanged
+    logic of an ECO hint. Area counts cut leaves and depth (`fix_depth`) LUT
+    levels; `cone_costs` counts the input-network nodes covered by a cut and
+    input-network levels instead.
+    """
+    data = _load_cuts_data(cuts_path, binary_hint=cut_enum_bin, cut_size=cut_size, cut_server=cut_server)
     data = _normalize_cuts_data(data)
+    if cone_costs:
+        data = _use_cone_costs(data)
     node_dicts = data["nodes"]
     outputs = data.get("outputs", [])
     inputs = data.get("inputs") or []
+    hint, open_nodes = _load_hint(hint_path, node_dicts) if hint_path else (None, set())
+    if hint is not None:
+        print(f"Loaded hint of {len(hint)} nodes ({len(open_nodes)} open) from {hint_path}")
+
+    def seed(built, start=None):
+        if start is not None:
+            _add_hint(built, node_dicts, start)
+        elif hint is not None:
+            _add_hint(built, node_dicts, hint, open_nodes)
+        if fix_hint and hint is not None:
+            _fix_cover(built, hint)
 
     def build_model(depth_bound=None, fix_depth=None):
         include_depth = depth_bound is not None
         model = cp_model.CpModel()
+        # Nodes and cuts the exporter marked forced are decided already and
+        # share this constant instead of getting a decision variable.
+        forced_1 = model.NewConstant(1)
 
         var_node_used = {
-            nd["name"]: model.NewBoolVar("used_" + nd["name"])
+            nd["name"]: forced_1 if nd.get("forced") else model.NewBoolVar("used_" + nd["name"])
             for nd in node_dicts
         }
 
@@ -230,13 +527,13 @@ def solve_circuit(
             var_cut[nname] = []
             for i, cut_obj in enumerate(nd["cuts"]):
                 leaves = cut_obj["leaves"]
-                if len(leaves) == 1 and leaves[0] == nname:
+                if (len(leaves) == 1 and leaves[0] == nname) or cut_obj.get("infeasible"):
                     continue
 
                 inv_cost = cut_obj.get("inv_cost", 0)
                 area_cost = cut_obj.get("area_cost", len(leaves))
                 depth_cost = cut_obj.get("depth_cost", 1)
-                cvar = model.NewBoolVar(f"cut_{nname}_{i}")
+                cvar = forced_1 if cut_obj.get("forced") else model.NewBoolVar(f"cut_{nname}_{i}")
                 lex_weight = cut_counter
                 cut_counter += 1
                 var_cut[nname].append({
@@ -247,6 +544,7 @@ def solve_circuit(
                     "depth_cost": depth_cost,
                     "lex_weight": lex_weight,
                     "cut_index": i,
+                    "forced": bool(cut_obj.get("forced")),
                 })
 
         # (A) exactly 1 cut if node used, 0 otherwise
@@ -259,7 +557,6 @@ def solve_circuit(
                 model.Add(var_node_used[nname] == 0)
 
         # (B) cut -> leaves used (for internal leaves)
-        forced_1 = model.NewConstant(1)
         for nd in node_dicts:
             nname = nd["name"]
             for ci in var_cut[nname]:
@@ -273,8 +570,24 @@ def solve_circuit(
         D = None
         if include_depth:
             max_depth_bound = max(1, depth_bound or len(node_dicts) or 1)
+            bound = max_depth_bound if fix_depth is None else min(max_depth_bound, fix_depth)
+            # Per-node level bounds of the cut file: a used node lies in
+            # [min_level, bound - height]; files without them get [1, bound].
+            min_level = {}
+            max_level = {}
+            for nd in node_dicts:
+                nname = nd["name"]
+                height = nd.get("height", 0)
+                lo = max(1, nd.get("min_level", 0))
+                hi = -1 if height == NO_LEVEL else bound - height
+                if hi < lo:
+                    # No output can use the node within the bound.
+                    model.Add(var_node_used[nname] == 0)
+                    lo = hi = 0
+                min_level[nname] = lo
+                max_level[nname] = hi
             level_vars = {
-                nd["name"]: model.NewIntVar(0, max_depth_bound, f"L_{nd['name']}")
+                nd["name"]: model.NewIntVar(0, max_level[nd["name"]], f"L_{nd['name']}")
                 for nd in node_dicts
             }
             D = model.NewIntVar(0, max_depth_bound, "D")
@@ -283,21 +596,22 @@ def solve_circuit(
                 if inp in level_vars:
                     model.Add(level_vars[inp] == 0)
 
-            big_m = max_depth_bound
             for nd in node_dicts:
                 nname = nd["name"]
                 if nname not in level_vars:
                     continue
                 node_level = level_vars[nname]
                 # Link levels to usage to avoid floating levels.
-                model.Add(node_level <= big_m * var_node_used[nname])
+                model.Add(node_level <= max_level[nname] * var_node_used[nname])
                 if nname not in inputs:
-                    model.Add(node_level >= var_node_used[nname])
+                    model.Add(node_level >= min_level[nname] * var_node_used[nname])
                 for ci in var_cut[nname]:
                     cvar = ci["var"]
                     step = ci.get("depth_cost", 1) or 1
                     for leaf in ci["leaves"]:
                         if leaf in level_vars:
+                            # Big-M of the leaf: its largest level plus the step.
+                            big_m = max_level[leaf] + step
                             model.Add(node_level >= level_vars[leaf] + step - big_m * (1 - cvar))
 
             for nname, lvl in level_vars.items():
@@ -387,13 +701,13 @@ def solve_circuit(
         time_limit=10,
         absolute_gap=None,
         relative_gap=None,
-        num_workers=50,
+        workers=50,
         seed=1,
         stop_after_first=False,
     ):
         solver = cp_model.CpSolver()
         solver.parameters.random_seed = seed
-        solver.parameters.num_search_workers = num_workers
+        solver.parameters.num_search_workers = num_workers or workers
         solver.parameters.max_time_in_seconds = time_limit
         solver.parameters.log_search_progress = False
         if absolute_gap is not None:
@@ -411,7 +725,38 @@ def solve_circuit(
     final_objective = None
     chosen_cuts = {}
 
-    if objective_mode in ("depth", "overall"):
+    tie_objective = None
+    if fix_depth is not None:
+        depth_bound = _compute_depth_upper_bound(data)
+        depth_bound = max(depth_bound, len(node_dicts) or 1)
+        print(f"Using depth upper bound UB = {depth_bound}, fixed depth D = {fix_depth}")
+
+        # Depth given: only the Phase B solve, with the requested objective as tie-breaker.
+        if objective_mode in ("depth", "overall"):
+            mode = "depth_tiebreak_area" if objective_mode == "depth" else "overall_tiebreak"
+        else:
+            mode = objective_mode
+        fixed = build_model(depth_bound=depth_bound, fix_depth=fix_depth)
+        fixed["apply_objective"](mode)
+        seed(fixed)
+        solver, status = solve_model(
+            fixed["model"],
+            time_limit=60,
+            workers=16,
+            seed=1,
+        )
+        status_str = _status_to_str(status)
+        print(f"Status: {status_str}")
+        if status not in (cp_model.OPTIMAL, cp_model.FEASIBLE):
+            print("No feasible solution with fixed depth.")
+            return {"status": status_str, "objective_value": None}
+        final_solver = solver
+        final_status = status_str
+        final_D = solver.Value(fixed["D"])
+        tie_objective = solver.ObjectiveValue()
+        final_objective = final_D if objective_mode in ("depth", "overall") else tie_objective
+        chosen_cuts = _extract_chosen_cuts(node_dicts, fixed["var_node_used"], fixed["var_cut"], solver)
+    elif objective_mode in ("depth", "overall"):
         depth_bound = _compute_depth_upper_bound(data)
         depth_bound = max(depth_bound, len(node_dicts) or 1)
         print(f"Using depth upper bound UB = {depth_bound}")
@@ -419,12 +764,13 @@ def solve_circuit(
         # Phase A: depth-only minimize D with relaxed gap and short cap.
         phase_a = build_model(depth_bound=depth_bound)
         phase_a["apply_objective"]("depth")
+        seed(phase_a)
         solver_a, status_a = solve_model(
             phase_a["model"],
             time_limit=120,
             absolute_gap=1,
             relative_gap=None,
-            num_workers=16,
+            workers=16,
             seed=1,
             stop_after_first=True,
         )
@@ -443,16 +789,16 @@ def solve_circuit(
         final_status = status_a_str
         final_D = best_depth
         final_objective = best_depth
-        tie_objective = None
 
         # Phase B: fix depth and minimize tie-breaker.
         tie_mode = "depth_tiebreak_area" if objective_mode == "depth" else "overall_tiebreak"
         phase_b = build_model(depth_bound=depth_bound, fix_depth=best_depth)
         phase_b["apply_objective"](tie_mode)
+        seed(phase_b, start=phase_a_cuts)
         solver_b, status_b = solve_model(
             phase_b["model"],
             time_limit=60,
-            num_workers=16,
+            workers=16,
             seed=1,
         )
         status_b_str = _status_to_str(status_b)
@@ -472,11 +818,12 @@ def solve_circuit(
     else:
         single = build_model(depth_bound=None)
         single["apply_objective"](objective_mode)
+        seed(single)
         solver, status = solve_model(
             single["model"],                        #this timing is for the others area/og/inv
             time_limit=15,
             relative_gap=0.05,
-            num_workers=50,
+            workers=50,
             seed=0,
         )
         status_str = _status_to_str(status)
@@ -493,12 +840,16 @@ def solve_circuit(
     print(f"Status: {final_status}")
     if final_objective is not None:
         print(f"Objective value ({objective_mode}) = {final_objective}")
-    if objective_mode in ("depth", "overall"):
+    if objective_mode in ("depth", "overall") or fix_depth is not None:
         print("Global depth D =", final_D)
         if objective_mode in ("depth", "overall"):
             print("Phase B tie-break objective =", tie_objective)
 
-    out = {"chosen_cuts": chosen_cuts}
+    # Sorted (node index, cut index) pairs let the rebuilder skip the name lookups.
+    index_of = {nd["name"]: nd["index"] for nd in node_dicts if "index" in nd}
+    out = {"status": final_status, "objective_value": final_objective, "chosen_cuts": chosen_cuts}
+    if len(index_of) == len(node_dicts):
+        out["chosen_cut_indices"] = sorted([index_of[name], ci] for name, ci in chosen_cuts.items())
     with open(chosen_json_path, "w") as f:
         json.dump(out, f, indent=2)
     print(f"Written chosen cuts to {chosen_json_path}")
@@ -512,7 +863,7 @@ if __name__ == "__main__":
     parser.add_argument(
         "--cuts",
         default="/home/mrunal/Mockturtle-mMIG-main/build/examples/ctrl.json",
-        help="Path to cuts JSON (from cut_enumeration) or a BLIF file that will be converted."
+        help="Path to cuts JSON or binary cut database (from cut_enumeration) or a BLIF file that will be converted."
     )
     parser.add_argument(
         "--out",
@@ -536,12 +887,55 @@ if __name__ == "__main__":
         default=None,
         help="Optional K value to pass to cut_enumeration when converting BLIF inputs.",
     )
+    parser.add_argument(
+        "--cut-server",
+        default=None,
+        help="Socket of a running `cut_enumeration --serve --socket PATH`; BLIF inputs are enumerated there.",
+    )
+    parser.add_argument(
+        "--fix-depth",
+        type=int,
+        default=None,
+        help="Enforce this global depth D in LUT levels, input-network levels with --cone-costs (skips Phase A for depth/overall).",
+    )
+    parser.add_argument(
+        "--num-workers",
+        type=int,
+        default=None,
+        help="CP-SAT search workers for every phase (default: 50 single objective, 16 depth phases).",
+    )
+    parser.add_argument(
+        "--hint",
+        default=None,
+        help="Chosen cuts JSON to start CP-SAT from, e.g. the greedy cover of `cut_enumeration --hint-cover`.",
+    )
+    parser.add_argument(
+        "--fix-hint",
+        action="store_true",
+        help="Fix the hinted cuts of the nodes that stay used instead of only hinting them (ECO hints: keep the cover of the unchanged logic).",
+    )
+    parser.add_argument(
+        "--cone-costs",
+        action="store_true",
+        help="Area and depth objectives on the cut cones in the input network (nodes covered, levels) instead of leaves and LUT levels.",
+    )
     args = parser.parse_args()
+    if args.fix_hint and not args.hint:
+        parser.error("--fix-hint needs --hint")
 
-    solve_circuit(
+    result = solve_circuit(
         args.cuts,
         args.out,
         objective_mode=args.objective,
         cut_enum_bin=args.cut_enum_bin,
         cut_size=args.cut_size,
+        fix_depth=args.fix_depth,
+        num_workers=args.num_workers,
+        hint_path=args.hint,
+        fix_hint=args.fix_hint,
+        cut_server=args.cut_server,
+        cone_costs=args.cone_costs,
     )
+    # same convention as cpsat_solve: exit code 3 when no solution exists
+    if result["status"] not in ("OPTIMAL", "FEASIBLE"):
+        raise SystemExit(3 if result["status"] == "INFEASIBLE" else 1)
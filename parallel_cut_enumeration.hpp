@@ -0,0 +1,592 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <vector>
+
+#include <kitty/dynamic_truth_table.hpp>
+#include <kitty/operations.hpp>
+
+#include "cut_export.hpp"
+#include "thread_pool.hpp"
+
+/* Multi-threaded cut enumeration over topological levels.
+ *
+ * Nodes are bucketed by level (1 + maximum fanin level); the nodes of one
+ * level only read the cuts of lower levels, so a level is processed by all
+ * threads at once. Every thread appends to its own arena per level, which is
+ * never written again once the level is done, so lookups into lower levels
+ * need no locking. Truth tables and inverter costs are computed by the
+ * thread that enumerates the node.
+ *
+ * The cuts of a node are the k-feasible, non-dominated merges of its fanin
+ * cuts, ordered by size and then by leaf indices, truncated to
+ * `cut_limit - 1` and followed by the trivial cut. This only depends on the
+ * network, so the result is the same for any thread count.
+ *
+ * For K in {3, 4, 5, 6} the enumeration is instantiated on K: leaf unions
+ * live in fixed K-leaf buffers and cut functions are single 64-bit words.
+ * Other cut sizes use the dynamic kernel with kitty truth tables; both
+ * produce the same cuts.
+ *
+ * In ECO mode (`reused_cuts`) nodes whose transitive fanin is unchanged
+ * since an earlier run copy their cuts from that run's database, renumbered
+ * to the current node indices, and only the remaining nodes are enumerated.
+ */
+namespace cpsat
+{
+
+struct parallel_cut_params
+{
+  uint32_t cut_size{ 4 };
+  uint32_t cut_limit{ default_cut_limit };
+
+  /*! \brief Worker threads, 0 for one per hardware thread. */
+  uint32_t num_threads{ 0 };
+
+  /*! \brief Use the compile-time kernel when `cut_size` has one; false runs the dynamic kernel for every K (see cut_kernel_check.cpp). */
+  bool specialized_kernel{ true };
+};
+
+/*! \brief Cut sizes with a compile-time kernel in `parallel_network_cuts`. */
+constexpr bool has_specialized_kernel( uint32_t cut_size )
+{
+  return cut_size >= 3u && cut_size <= 6u;
+}
+
+/*! \brief Cuts taken over from an earlier cut database instead of being enumerated (see cut_eco.hpp). */
+struct reused_cuts
+{
+  static constexpr uint32_t no_source = std::numeric_limits<uint32_t>::max();
+
+  cut_database_view db;
+
+  /*! \brief Node position in `db` per node index of the network, `no_source` for nodes to enumerate. */
+  std::vector<uint32_t> source;
+
+  /*! \brief Node index of the network per node index of `db`, `no_source` if unmatched. */
+  std::vector<uint32_t> leaf_map;
+};
+
+/*! \brief Cuts of all nodes of `ntk`, enumerated on `ps.num_threads` threads. */
+template<class Ntk>
+class parallel_network_cuts
+{
+public:
+  using node = typename Ntk::node;
+
+  parallel_network_cuts( Ntk const& ntk, parallel_cut_params const& ps )
+      : _ntk( ntk ), _ps( ps ), _node_cuts( ntk.size() )
+  {
+    _num_threads = resolve_num_threads( ps.num_threads );
+    run();
+  }
+
+  /*! \brief Enumerates only the nodes without a source in `reuse`, which must outlive the constructor. */
+  parallel_network_cuts( Ntk const& ntk, parallel_cut_params const& ps, reused_cuts const& reuse )
+      : _ntk( ntk ), _ps( ps ), _node_cuts( ntk.size() ), _reuse( &reuse )
+  {
+    _num_threads = resolve_num_threads( ps.num_threads );
+    run();
+    _reuse = nullptr;
+  }
+
+  uint32_t num_threads() const
+  {
+    return _num_threads;
+  }
+
+  uint32_t num_levels() const
+  {
+    return static_cast<uint32_t>( _levels.size() );
+  }
+
+  /*! \brief Exports internal nodes in index order, like `cut_exporter::export_nodes`. */
+  template<class Sink>
+  void export_nodes( Sink& sink ) const
+  {
+    cut_cone_costs<Ntk> cone( _ntk );
+    for ( auto idx : _gates )
+    {
+      auto const& nc = _node_cuts[idx];
+      auto const& arena = _arenas[nc.arena];
+      sink.begin_node( idx );
+      for ( auto c = nc.cut_begin; c < nc.cut_begin + nc.num_cuts; ++c )
+      {
+        auto const& cut = arena.cuts[c];
+        auto const leaves = arena.leaves.begin() + cut.leaf_begin;
+        auto const costs = cone( idx, leaves, leaves + cut.num_leaves );
+        sink.add_cut( leaves, leaves + cut.num_leaves, arena.tt_words.begin() + cut.tt_begin,
+                      cut.inv_cost, cut.num_leaves, 1u, costs.shared, costs.area, costs.depth );
+      }
+      sink.end_node();
+    }
+  }
+
+private:
+  struct arena_cut
+  {
+    uint32_t leaf_begin;
+    uint32_t num_leaves;
+    uint32_t tt_begin;
+    uint32_t inv_cost;
+  };
+
+  /*! \brief Cuts written by one thread for one level. */
+  struct cut_arena
+  {
+    std::vector<arena_cut> cuts;
+    std::vector<uint32_t> leaves;
+    std::vector<uint64_t> tt_words;
+  };
+
+  struct node_cuts
+  {
+    uint32_t arena{ 0u };
+    uint32_t cut_begin{ 0u };
+    uint32_t num_cuts{ 0u };
+  };
+
+  struct candidate
+  {
+    uint32_t leaf_begin;
+    uint32_t num_leaves;
+    uint32_t choice_begin;
+    uint64_t signature;
+    bool dominated;
+  };
+
+  /*! \brief Per-thread buffers, reused across nodes. */
+  struct scratch
+  {
+    std::vector<uint32_t> fanins;
+    std::vector<uint32_t> union_leaves; /* one buffer of cut size leaves per fanin depth */
+    inv_cost_cache inv_costs;
+    std::vector<uint32_t> union_sizes;
+    std::vector<uint32_t> choice;
+    std::vector<candidate> candidates;
+    std::vector<uint32_t> candidate_leaves;
+    std::vector<uint32_t> candidate_choices;
+    std::vector<uint32_t> order;
+    std::vector<kitty::dynamic_truth_table> fanin_tts;
+  };
+
+  void run()
+  {
+    // levels; klut node indices are in topological order
+    std::vector<uint32_t> level( _ntk.size(), 0u );
+    _ntk.foreach_node( [&]( auto const& n ) {
+      auto const idx = _ntk.node_to_index( n );
+      if ( _ntk.is_constant( n ) || _ntk.is_pi( n ) )
+      {
+        return;
+      }
+      uint32_t l = 0u;
+      _ntk.foreach_fanin( n, [&]( auto const& f ) {
+        l = std::max( l, level[_ntk.node_to_index( _ntk.get_node( f ) )] );
+      } );
+      level[idx] = l + 1u;
+      if ( _levels.size() <= l )
+      {
+        _levels.resize( l + 1u );
+      }
+      _levels[l].push_back( idx );
+      _gates.push_back( idx );
+    } );
+
+    // arena 0 holds the cuts of constants and PIs; small levels run on the calling thread only
+    std::vector<uint32_t> first_arena( _levels.size() );
+    uint32_t num_arenas = 1u;
+    for ( auto l = 0u; l < _levels.size(); ++l )
+    {
+      first_arena[l] = num_arenas;
+      num_arenas += is_parallel_level( l ) ? _num_threads : 1u;
+    }
+    _arenas.resize( num_arenas );
+
+    _ntk.foreach_node( [&]( auto const& n ) {
+      if ( _ntk.is_constant( n ) )
+      {
+        uint64_t const tt = _ntk.constant_value( n ) ? 1u : 0u;
+        add_cut( _arenas[0], _ntk.node_to_index( n ), nullptr, nullptr, &tt, &tt + 1, 0u );
+      }
+      else if ( _ntk.is_pi( n ) )
+      {
+        add_trivial_cut( _arenas[0], _ntk.node_to_index( n ) );
+      }
+    } );
+
+    // compile-time kernels for the common cut sizes
+    using enumerate_fn = void ( parallel_network_cuts::* )( uint32_t, uint32_t, scratch& );
+    enumerate_fn enumerate = &parallel_network_cuts::enumerate_node<0u>;
+    switch ( _ps.specialized_kernel ? _ps.cut_size : 0u )
+    {
+    case 3u:
+      enumerate = &parallel_network_cuts::enumerate_node<3u>;
+      break;
+    case 4u:
+      enumerate = &parallel_network_cuts::enumerate_node<4u>;
+      break;
+    case 5u:
+      enumerate = &parallel_network_cuts::enumerate_node<5u>;
+      break;
+    case 6u:
+      enumerate = &parallel_network_cuts::enumerate_node<6u>;
+      break;
+    default:
+      break;
+    }
+
+    std::vector<scratch> scratches( _num_threads );
+    thread_pool pool( _num_threads );
+    for ( auto l = 0u; l < _levels.size(); ++l )
+    {
+      auto const& nodes = _levels[l];
+      auto const arena_base = first_arena[l];
+      std::function<void( uint32_t, uint32_t )> const job = [&]( uint32_t tid, uint32_t i ) {
+        if ( _reuse != nullptr && _reuse->source[nodes[i]] != reused_cuts::no_source )
+        {
+          copy_node( nodes[i], arena_base + tid, scratches[tid] );
+          return;
+        }
+        ( this->*enumerate )( nodes[i], arena_base + tid, scratches[tid] );
+      };
+      if ( is_parallel_level( l ) )
+      {
+        pool.parallel_for( static_cast<uint32_t>( nodes.size() ), job );
+      }
+      else
+      {
+        for ( auto i = 0u; i < nodes.size(); ++i )
+        {
+          job( 0u, i );
+        }
+      }
+    }
+  }
+
+  bool is_parallel_level( uint32_t l ) const
+  {
+    return _num_threads > 1u && _levels[l].size() >= 4u * _num_threads;
+  }
+
+  template<typename WordIt>
+  void add_cut( cut_arena& arena, uint32_t idx, uint32_t const* leaves_begin, uint32_t const* leaves_end,
+                WordIt words_begin, WordIt words_end, uint32_t inv_cost )
+  {
+    auto& nc = _node_cuts[idx];
+    if ( nc.num_cuts == 0u )
+    {
+      nc.arena = static_cast<uint32_t>( &arena - _arenas.data() );
+      nc.cut_begin = static_cast<uint32_t>( arena.cuts.size() );
+    }
+    arena_cut cut;
+    cut.leaf_begin = static_cast<uint32_t>( arena.leaves.size() );
+    cut.num_leaves = static_cast<uint32_t>( leaves_end - leaves_begin );
+    cut.tt_begin = static_cast<uint32_t>( arena.tt_words.size() );
+    cut.inv_cost = inv_cost;
+    arena.leaves.insert( arena.leaves.end(), leaves_begin, leaves_end );
+    arena.tt_words.insert( arena.tt_words.end(), words_begin, words_end );
+    arena.cuts.push_back( cut );
+    ++nc.num_cuts;
+  }
+
+  void add_trivial_cut( cut_arena& arena, uint32_t idx )
+  {
+    uint64_t const tt = 0x2u; /* x0 */
+    add_cut( arena, idx, &idx, &idx + 1, &tt, &tt + 1, 0u );
+  }
+
+  /*! \brief Copies the cuts of node `idx` from `_reuse`, adding the trivial cut if the old database dropped it. */
+  void copy_node( uint32_t idx, uint32_t arena_id, scratch& s )
+  {
+    auto& arena = _arenas[arena_id];
+    auto const& db = _reuse->db;
+    auto const& nd = db.nodes[_reuse->source[idx]];
+    bool has_trivial = false;
+    for ( auto cut = db.cuts_begin( nd ); cut != db.cuts_end( nd ); ++cut )
+    {
+      s.candidate_leaves.clear();
+      for ( auto leaf = db.leaves_begin( *cut ); leaf != db.leaves_end( *cut ); ++leaf )
+      {
+        s.candidate_leaves.push_back( _reuse->leaf_map[*leaf] );
+      }
+      has_trivial = has_trivial || ( cut->num_leaves == 1u && s.candidate_leaves[0] == idx );
+      add_cut( arena, idx, s.candidate_leaves.data(), s.candidate_leaves.data() + cut->num_leaves,
+               db.tt_begin( *cut ), db.tt_end( *cut ), cut->inv_cost );
+    }
+    if ( !has_trivial )
+    {
+      add_trivial_cut( arena, idx );
+    }
+  }
+
+  /*! \brief Merges two sorted leaf sets into `out`; fails as soon as the union exceeds `cap` leaves. */
+  static bool merge_leaves( uint32_t const* a, uint32_t na, uint32_t const* b, uint32_t nb, uint32_t* out, uint32_t& n, uint32_t cap )
+  {
+    uint32_t i = 0u, j = 0u;
+    n = 0u;
+    while ( i < na || j < nb )
+    {
+      uint32_t leaf;
+      if ( j == nb || ( i < na && a[i] < b[j] ) )
+      {
+        leaf = a[i++];
+      }
+      else if ( i == na || b[j] < a[i] )
+      {
+        leaf = b[j++];
+      }
+      else
+      {
+        leaf = a[i++];
+        ++j;
+      }
+      if ( n == cap )
+      {
+        return false;
+      }
+      out[n++] = leaf;
+    }
+    return true;
+  }
+
+  /*! \brief Leaves per union buffer: the compile-time cut size, or `cut_size` for the dynamic kernel. */
+  template<uint32_t K>
+  uint32_t union_capacity() const
+  {
+    return K != 0u ? K : _ps.cut_size;
+  }
+
+  /*! \brief Depth-first merge of one cut per fanin, pruning unions larger than the cut size. */
+  template<uint32_t K>
+  void expand( scratch& s, uint32_t j )
+  {
+    auto const cap = union_capacity<K>();
+    auto const merged = s.union_leaves.data() + j * cap;
+    if ( j == s.fanins.size() )
+    {
+      add_candidate( s, merged, s.union_sizes[j] );
+      return;
+    }
+    auto const& fc = _node_cuts[s.fanins[j]];
+    auto const& arena = _arenas[fc.arena];
+    for ( auto c = 0u; c < fc.num_cuts; ++c )
+    {
+      auto const& cut = arena.cuts[fc.cut_begin + c];
+      if ( !merge_leaves( merged, s.union_sizes[j], arena.leaves.data() + cut.leaf_begin, cut.num_leaves,
+                          merged + cap, s.union_sizes[j + 1], cap ) )
+      {
+        continue;
+      }
+      s.choice[j] = c;
+      expand<K>( s, j + 1 );
+    }
+  }
+
+  /*! \brief Keeps the merged cut unless an existing cut is a subset; drops existing supersets. */
+  void add_candidate( scratch& s, uint32_t const* leaves, uint32_t num_leaves )
+  {
+    uint64_t signature = 0u;
+    for ( auto i = 0u; i < num_leaves; ++i )
+    {
+      signature |= uint64_t( 1 ) << ( leaves[i] % 64u );
+    }
+    auto const begin = s.candidate_leaves.data();
+    for ( auto const& other : s.candidates )
+    {
+      if ( !other.dominated && other.num_leaves <= num_leaves && ( other.signature & ~signature ) == 0u &&
+           std::includes( leaves, leaves + num_leaves, begin + other.leaf_begin, begin + other.leaf_begin + other.num_leaves ) )
+      {
+        return;
+      }
+    }
+    for ( auto& other : s.candidates )
+    {
+      if ( !other.dominated && num_leaves <= other.num_leaves && ( signature & ~other.signature ) == 0u &&
+           std::includes( begin + other.leaf_begin, begin + other.leaf_begin + other.num_leaves, leaves, leaves + num_leaves ) )
+      {
+        other.dominated = true;
+      }
+    }
+    s.candidates.push_back( { static_cast<uint32_t>( s.candidate_leaves.size() ), num_leaves,
+                              static_cast<uint32_t>( s.candidate_choices.size() ), signature, false } );
+    s.candidate_leaves.insert( s.candidate_leaves.end(), leaves, leaves + num_leaves );
+    s.candidate_choices.insert( s.candidate_choices.end(), s.choice.begin(), s.choice.end() );
+  }
+
+  /*! \brief Sorts the surviving candidates into `s.order` and keeps room for the trivial cut. */
+  void select_candidates( scratch& s ) const
+  {
+    s.order.clear();
+    for ( auto i = 0u; i < s.candidates.size(); ++i )
+    {
+      if ( !s.candidates[i].dominated )
+      {
+        s.order.push_back( i );
+      }
+    }
+    auto const leaves = s.candidate_leaves.data();
+    std::sort( s.order.begin(), s.order.end(), [&]( uint32_t a, uint32_t b ) {
+      auto const& ca = s.candidates[a];
+      auto const& cb = s.candidates[b];
+      if ( ca.num_leaves != cb.num_leaves )
+      {
+        return ca.num_leaves < cb.num_leaves;
+      }
+      return std::lexicographical_compare( leaves + ca.leaf_begin, leaves + ca.leaf_begin + ca.num_leaves,
+                                           leaves + cb.leaf_begin, leaves + cb.leaf_begin + cb.num_leaves );
+    } );
+    if ( s.order.size() + 1u > _ps.cut_limit )
+    {
+      s.order.resize( _ps.cut_limit > 0u ? _ps.cut_limit - 1u : 0u );
+    }
+  }
+
+  arena_cut const& fanin_cut( scratch const& s, candidate const& cand, uint32_t j ) const
+  {
+    auto const& fc = _node_cuts[s.fanins[j]];
+    return _arenas[fc.arena].cuts[fc.cut_begin + s.candidate_choices[cand.choice_begin + j]];
+  }
+
+  /*! \brief Cut functions of at most 6 leaves and 6 fanins, computed on single words. */
+  template<uint32_t K>
+  void add_word_cuts( uint32_t idx, node const& n, cut_arena& arena, scratch& s )
+  {
+    static_assert( K <= 6u, "word kernel only supports cuts of up to 6 leaves" );
+
+    auto const num_fanins = static_cast<uint32_t>( s.fanins.size() );
+    auto const gate = *_ntk.node_function( n ).cbegin();
+    std::array<uint64_t, 6u> fanin_words;
+    std::array<uint32_t, 6u> fanin_sizes;
+    std::array<std::array<uint8_t, K>, 6u> fanin_pos;
+
+    for ( auto i : s.order )
+    {
+      auto const& cand = s.candidates[i];
+      auto const cut_leaves = s.candidate_leaves.data() + cand.leaf_begin;
+
+      // position of every fanin cut leaf within the merged cut
+      for ( auto j = 0u; j < num_fanins; ++j )
+      {
+        auto const& fc = fanin_cut( s, cand, j );
+        auto const& fanin_arena = _arenas[_node_cuts[s.fanins[j]].arena];
+        auto const fanin_leaves = fanin_arena.leaves.data() + fc.leaf_begin;
+        fanin_words[j] = fanin_arena.tt_words[fc.tt_begin];
+        fanin_sizes[j] = fc.num_leaves;
+        for ( auto v = 0u; v < fc.num_leaves; ++v )
+        {
+          fanin_pos[j][v] = static_cast<uint8_t>( std::lower_bound( cut_leaves, cut_leaves + cand.num_leaves, fanin_leaves[v] ) - cut_leaves );
+        }
+      }
+
+      uint64_t tt = 0u;
+      for ( auto m = 0u; m < ( 1u << cand.num_leaves ); ++m )
+      {
+        uint32_t pattern = 0u;
+        for ( auto j = 0u; j < num_fanins; ++j )
+        {
+          uint32_t minterm = 0u;
+          for ( auto v = 0u; v < fanin_sizes[j]; ++v )
+          {
+            minterm |= ( ( m >> fanin_pos[j][v] ) & 1u ) << v;
+          }
+          pattern |= static_cast<uint32_t>( ( fanin_words[j] >> minterm ) & 1u ) << j;
+        }
+        tt |= ( ( gate >> pattern ) & 1u ) << m;
+      }
+      add_cut( arena, idx, cut_leaves, cut_leaves + cand.num_leaves, &tt, &tt + 1, compute_inv_cost( tt, cand.num_leaves ) );
+    }
+  }
+
+  /*! \brief Cut functions of any size, composed with kitty and the network's `compute`. */
+  void add_dynamic_cuts( uint32_t idx, node const& n, cut_arena& arena, scratch& s )
+  {
+    for ( auto i : s.order )
+    {
+      auto const& cand = s.candidates[i];
+      auto const cut_leaves = s.candidate_leaves.data() + cand.leaf_begin;
+
+      // fanin functions expressed over the leaves of the merged cut
+      s.fanin_tts.clear();
+      for ( auto j = 0u; j < s.fanins.size(); ++j )
+      {
+        auto const& fc = fanin_cut( s, cand, j );
+        auto const& fanin_arena = _arenas[_node_cuts[s.fanins[j]].arena];
+        auto const fanin_leaves = fanin_arena.leaves.data() + fc.leaf_begin;
+
+        kitty::dynamic_truth_table tt( fc.num_leaves );
+        std::copy( fanin_arena.tt_words.begin() + fc.tt_begin,
+                   fanin_arena.tt_words.begin() + fc.tt_begin + tt.num_blocks(), tt.begin() );
+        kitty::extend_to_inplace( tt, cand.num_leaves );
+        for ( auto v = fc.num_leaves; v-- > 0u; )
+        {
+          auto const pos = static_cast<uint32_t>( std::lower_bound( cut_leaves, cut_leaves + cand.num_leaves, fanin_leaves[v] ) - cut_leaves );
+          if ( pos != v )
+          {
+            kitty::swap_inplace( tt, static_cast<uint8_t>( v ), static_cast<uint8_t>( pos ) );
+          }
+        }
+        s.fanin_tts.push_back( std::move( tt ) );
+      }
+
+      auto const tt = _ntk.compute( n, s.fanin_tts.begin(), s.fanin_tts.end() );
+      add_cut( arena, idx, cut_leaves, cut_leaves + cand.num_leaves, tt.cbegin(), tt.cend(), s.inv_costs( tt ) );
+    }
+  }
+
+  /*! \brief Enumerates the cuts of one node; `K` is the compile-time cut size, 0 for the dynamic kernel. */
+  template<uint32_t K>
+  void enumerate_node( uint32_t idx, uint32_t arena_id, scratch& s )
+  {
+    auto& arena = _arenas[arena_id];
+    auto const n = _ntk.index_to_node( idx );
+
+    s.fanins.clear();
+    _ntk.foreach_fanin( n, [&]( auto const& f ) {
+      s.fanins.push_back( _ntk.node_to_index( _ntk.get_node( f ) ) );
+    } );
+    if ( s.fanins.empty() )
+    {
+      add_trivial_cut( arena, idx );
+      return;
+    }
+
+    auto const cap = union_capacity<K>();
+    s.union_leaves.resize( std::max<std::size_t>( s.union_leaves.size(), ( s.fanins.size() + 1u ) * cap ) );
+    s.union_sizes.assign( s.fanins.size() + 1u, 0u );
+    s.choice.assign( s.fanins.size(), 0u );
+    s.candidates.clear();
+    s.candidate_leaves.clear();
+    s.candidate_choices.clear();
+    expand<K>( s, 0u );
+    select_candidates( s );
+
+    if constexpr ( K != 0u )
+    {
+      if ( s.fanins.size() <= 6u )
+      {
+        add_word_cuts<K>( idx, n, arena, s );
+        add_trivial_cut( arena, idx );
+        return;
+      }
+    }
+    add_dynamic_cuts( idx, n, arena, s );
+    add_trivial_cut( arena, idx );
+  }
+
+private:
+  Ntk const& _ntk;
+  parallel_cut_params _ps;
+  uint32_t _num_threads{ 1u };
+  std::vector<node_cuts> _node_cuts;
+  std::vector<cut_arena> _arenas;
+  std::vector<std::vector<uint32_t>> _levels;
+  std::vector<uint32_t> _gates;
+  reused_cuts const* _reuse{ nullptr };
+};
+
+} // namespace cpsat
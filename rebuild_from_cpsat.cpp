@@ -1,251 +1,304 @@
+#include <charconv>
 #include <cstdint>
+#include <cstring>
+#include <deque>
 #include <fstream>
 #include <iostream>
 #include <string>
-#include <unordered_map>
 #include <vector>
 
-#include <kitty/dynamic_truth_table.hpp>
-#include <kitty/operations.hpp>
-
-#include <lorina/blif.hpp>
-
 #include <nlohmann/json.hpp>
 
-#include <mockturtle/algorithms/cut_enumeration.hpp>
-#include <mockturtle/io/blif_reader.hpp>
 #include <mockturtle/io/write_blif.hpp>
 #include <mockturtle/networks/klut.hpp>
 #include <mockturtle/views/names_view.hpp>
 
+#include "aiger_writer.hpp"
+#include "blif_loader.hpp"
+#include "cut_database.hpp"
+#include "cut_database_json.hpp"
+#include "cut_rebuild.hpp"
+#include "cut_verify.hpp"
+#include "cut_windows.hpp"
+#include "tool_stats.hpp"
+
 int main( int argc, char** argv )
 {
   using namespace mockturtle;
 
-  if ( argc != 5 )
-  {
-    std::cerr << "Usage: rebuild_from_cpsat <input.blif> <cuts.json> <chosen_cuts.json> <output.blif>\n";
-    return 1;
-  }
-
-  const std::string input_blif = argv[1];
-  const std::string cuts_json_path = argv[2];
-  const std::string chosen_json_path = argv[3];
-  const std::string output_blif = argv[4];
-
-  nlohmann::json cuts_json;
+  std::vector<std::string> positional;
+  cpsat::rebuild_params ps;
+  std::string stats_file;    /* empty: no --stats-json */
+  std::string manifest_file; /* empty: one cut file and one chosen file */
+  bool arena = false;        /* flat netlist written directly, instead of a klut network and write_blif */
+  bool verify = false;       /* simulate the rebuilt netlist against the input */
+  cpsat::verify_params vps;
+  bool valid = true;
+  for ( int i = 1; i < argc; ++i )
   {
-    std::ifstream cuts_stream( cuts_json_path );
-    if ( !cuts_stream )
+    std::string const arg = argv[i];
+    if ( arg == "--strash" )
     {
-      std::cerr << "Cannot open cuts JSON '" << cuts_json_path << "'\n";
-      return 2;
+      ps.strash = true;
+    }
+    else if ( arg == "--arena" )
+    {
+      arena = true;
+    }
+    else if ( arg == "--verify" )
+    {
+      verify = true;
+    }
+    else if ( arg == "--verify-patterns" && i + 1 < argc )
+    {
+      verify = true;
+      char const* text = argv[++i];
+      char const* end = text + std::strlen( text );
+      auto const [ptr, ec] = std::from_chars( text, end, vps.patterns );
+      valid &= ec == std::errc() && ptr == end && vps.patterns > 0u;
+    }
+    else if ( arg == "--windows" && i + 1 < argc )
+    {
+      manifest_file = argv[++i];
+    }
+    else if ( arg == "--stats-json" && i + 1 < argc )
+    {
+      stats_file = argv[++i];
+    }
+    else
+    {
+      positional.push_back( arg );
     }
-    cuts_stream >> cuts_json;
   }
 
-  if ( !cuts_json.contains( "cuts_per_node" ) || !cuts_json.contains( "nodes" ) )
+  if ( !valid || positional.size() != ( manifest_file.empty() ? 4u : 2u ) )
   {
-    std::cerr << "Invalid cuts JSON: missing required fields\n";
-    return 2;
+    std::cerr << "Usage: rebuild_from_cpsat <input.blif> <cuts.json|cuts.cdb> <chosen_cuts.json> <output.blif|output.aig>\n"
+                 "                          [--strash] [--arena] [--verify] [--verify-patterns N] [--stats-json FILE]\n"
+                 "       rebuild_from_cpsat <input.blif> <output.blif|output.aig> --windows <windows.json> [--strash]\n"
+                 "                          [--arena] [--verify] [--verify-patterns N] [--stats-json FILE]\n"
+                 "An .aig output is written as binary AIGER, with every chosen LUT decomposed into ANDs.\n"
+                 "--verify simulates the rebuilt netlist against the input (exhaustively if 2^PIs <= N; N > 0, default 65536)\n"
+                 "and exits with 5 if an output differs, or with 6 if the inputs or outputs cannot be paired.\n";
+    return 1;
   }
 
-  uint32_t cut_size = cuts_json["cuts_per_node"].get<uint32_t>();
-  std::vector<std::string> output_names;
-  if ( cuts_json.contains( "outputs" ) )
+  const std::string input_blif = positional[0];
+  const std::string output_blif = positional.back();
+  // AIGER is written from the flat netlist, so it always takes the arena path
+  bool const aiger = output_blif.size() >= 4u && output_blif.compare( output_blif.size() - 4u, 4u, ".aig" ) == 0;
+
+  cpsat::tool_stats stats( "rebuild_from_cpsat" );
+
+  // Cuts, leaves and truth tables come from the exported cut files, so the
+  // rebuild uses exactly the cuts the solver saw and never re-enumerates.
+  // Window files are stitched into one database; their chosen cut indices
+  // stay valid because every node lives in exactly one window.
+  stats.begin_phase( "load_cuts" );
+  std::vector<std::string> cut_files;
+  std::vector<std::string> chosen_files;
+  cpsat::window_manifest manifest;
+  if ( manifest_file.empty() )
   {
-    output_names = cuts_json["outputs"].get<std::vector<std::string>>();
+    cut_files.push_back( positional[1] );
+    chosen_files.push_back( positional[2] );
   }
-
-  nlohmann::json chosen_json;
+  else
   {
-    std::ifstream chosen_stream( chosen_json_path );
-    if ( !chosen_stream )
+    std::string error;
+    if ( !cpsat::read_window_manifest( manifest_file, manifest, error ) )
     {
-      std::cerr << "Cannot open chosen cuts JSON '" << chosen_json_path << "'\n";
+      std::cerr << "Invalid window manifest '" << manifest_file << "': " << error << "\n";
       return 2;
     }
-    chosen_stream >> chosen_json;
+    for ( auto const& w : manifest.windows )
+    {
+      cut_files.push_back( w.cuts );
+      chosen_files.push_back( w.chosen );
+    }
   }
 
-  if ( !chosen_json.contains( "chosen_cuts" ) || !chosen_json["chosen_cuts"].is_object() )
+  std::deque<cpsat::loaded_cut_database> cut_file_dbs;
+  std::vector<cpsat::cut_database_view> window_views;
+  uint64_t bytes_read = 0u;
+  for ( auto const& file : cut_files )
+  {
+    std::string error;
+    if ( !cut_file_dbs.emplace_back().load( file, error ) )
+    {
+      std::cerr << "Invalid cut file '" << file << "': " << error << "\n";
+      return 2;
+    }
+    window_views.push_back( cut_file_dbs.back().view() );
+    bytes_read += cpsat::file_bytes( file );
+  }
+  cpsat::cut_database stitched;
+  if ( !manifest_file.empty() )
   {
-    std::cerr << "Invalid chosen cuts JSON: missing 'chosen_cuts' object\n";
-    return 2;
+    stitched = cpsat::merge_windows( window_views, manifest.outputs, manifest.output_names );
   }
+  auto const db = manifest_file.empty() ? window_views.front() : stitched.view();
 
+  stats.begin_phase( "read_blif" );
   names_view<klut_network> ntk;
-  blif_reader reader( ntk );
-  if ( lorina::read_blif( input_blif, reader ) != lorina::return_code::success )
+  if ( !cpsat::read_blif_file( input_blif, ntk ) )
   {
-    std::cerr << "Failed to read BLIF '" << input_blif << "'\n";
     return 3;
   }
 
-  cut_enumeration_params ps;
-  ps.cut_size = cut_size;
-  ps.cut_limit = 32;
-  auto cuts = cut_enumeration<names_view<klut_network>, true>( ntk, ps );
-
-  std::vector<std::string> node_names( ntk.size() );
-  std::unordered_map<std::string, uint32_t> name_to_index;
+  if ( db.num_names > ntk.size() )
+  {
+    std::cerr << "Cut file references " << db.num_names << " nodes but '" << input_blif
+              << "' has only " << ntk.size() << "; was it exported from a different BLIF?\n";
+    return 3;
+  }
 
-  uint32_t pi_index = 0u;
-  ntk.foreach_pi( [&]( auto const& signal ) {
-    const auto node = ntk.get_node( signal );
-    const auto idx = ntk.node_to_index( node );
-    std::string name = ntk.has_name( signal ) ? ntk.get_name( signal ) : "";
-    if ( name.empty() )
+  stats.begin_phase( "load_chosen" );
+  std::vector<uint32_t> chosen_cut( ntk.size(), cpsat::no_chosen_cut );
+  for ( auto w = 0u; w < chosen_files.size(); ++w )
+  {
+    if ( !cpsat::read_chosen_cuts_json( chosen_files[w], window_views[w], chosen_cut ) )
     {
-      name = "pi" + std::to_string( pi_index );
+      return 2;
     }
-    node_names[idx] = name;
-    name_to_index[name] = idx;
-    ++pi_index;
-  } );
+  }
 
-  ntk.foreach_node( [&]( auto const& node ) {
-    const auto idx = ntk.node_to_index( node );
-    if ( ntk.is_constant( node ) )
+  stats.begin_phase( "rebuild" );
+  cpsat::rebuild_stats st;
+  uint32_t rebuilt_nodes = 0u, rebuilt_pis = 0u, rebuilt_pos = 0u;
+  cpsat::aiger_stats aig_st;
+  cpsat::sim_network rebuilt_sim;
+  if ( arena || aiger )
+  {
+    auto const net = cpsat::rebuild_arena( ntk, db, chosen_cut, st, ps );
+    stats.begin_phase( aiger ? "write_aiger" : "write_blif" );
+    if ( !( aiger ? cpsat::write_aiger( net, output_blif, &aig_st ) : net.write_blif( output_blif ) ) )
     {
-      node_names[idx] = ntk.constant_value( node ) ? "const1" : "const0";
-      name_to_index[node_names[idx]] = idx;
-      return;
+      std::cerr << "Error writing '" << output_blif << "'\n";
+      return 4;
     }
-    if ( node_names[idx].empty() )
+    rebuilt_nodes = net.size();
+    rebuilt_pis = net.num_pis();
+    rebuilt_pos = net.num_pos();
+    if ( verify )
     {
-      node_names[idx] = "n" + std::to_string( idx );
+      rebuilt_sim = cpsat::make_sim_network( net );
     }
-    name_to_index[node_names[idx]] = idx;
-  } );
-
-  std::unordered_map<std::string, uint32_t> chosen_cut_index;
-  for ( auto it = chosen_json["chosen_cuts"].begin(); it != chosen_json["chosen_cuts"].end(); ++it )
-  {
-    chosen_cut_index[it.key()] = it.value().get<uint32_t>();
   }
-
-  std::unordered_map<uint32_t, uint32_t> index_to_chosen_cut;
-  for ( auto const& [name, cut_idx] : chosen_cut_index )
+  else
   {
-    auto idx_it = name_to_index.find( name );
-    if ( idx_it == name_to_index.end() )
+    auto new_ntk = cpsat::rebuild_network( ntk, db, chosen_cut, st, ps );
+    stats.begin_phase( "write_blif" );
+    write_blif( new_ntk, output_blif );
+    rebuilt_nodes = new_ntk.size();
+    rebuilt_pis = new_ntk.num_pis();
+    rebuilt_pos = new_ntk.num_pos();
+    if ( verify )
     {
-      std::cerr << "Warning: chosen cut references unknown node '" << name << "'\n";
-      continue;
+      rebuilt_sim = cpsat::make_sim_network( new_ntk, [&]( uint32_t i ) { return new_ntk.get_output_name( i ); } );
     }
-    index_to_chosen_cut[idx_it->second] = cut_idx;
   }
 
-  names_view<klut_network> new_ntk;
-  std::unordered_map<uint32_t, decltype( new_ntk )::signal> index_to_new_signal;
-  std::unordered_map<std::string, decltype( new_ntk )::signal> pi_name_to_signal;
-
-  const auto const0_signal = ntk.get_constant( false );
-  const auto const0_node = ntk.get_node( const0_signal );
-  index_to_new_signal[ntk.node_to_index( const0_node )] = new_ntk.get_constant( false );
-
-  const auto const1_signal = ntk.get_constant( true );
-  const auto const1_node = ntk.get_node( const1_signal );
-  index_to_new_signal[ntk.node_to_index( const1_node )] = new_ntk.get_constant( true );
-
-  ntk.foreach_pi( [&]( auto const& signal ) {
-    const auto node = ntk.get_node( signal );
-    const auto idx = ntk.node_to_index( node );
-    auto const& pi_name = node_names[idx];
-    auto new_sig = new_ntk.create_pi( pi_name );
-    index_to_new_signal[idx] = new_sig;
-    pi_name_to_signal[pi_name] = new_sig;
-  } );
-
-  uint32_t selected_nodes = 0u;
-  ntk.foreach_node( [&]( auto const& node ) {
-    if ( ntk.is_constant( node ) || ntk.is_pi( node ) )
-    {
-      return;
-    }
-    const auto idx = ntk.node_to_index( node );
-    auto chosen_it = index_to_chosen_cut.find( idx );
-    if ( chosen_it == index_to_chosen_cut.end() )
-    {
-      return;
-    }
+  // rebuilt outputs are named after their driver in the cut file, so the input's are too
+  cpsat::sim_network original_sim;
+  cpsat::verify_result vres;
+  if ( verify )
+  {
+    stats.begin_phase( "verify" );
+    original_sim = cpsat::make_sim_network( ntk, [&]( uint32_t i ) {
+      auto const idx = ntk.node_to_index( ntk.get_node( ntk.po_at( i ) ) );
+      return idx < db.num_names ? std::string( db.name( idx ) ) : "n" + std::to_string( idx );
+    } );
+    vres = cpsat::check_equivalence( original_sim, rebuilt_sim, vps );
+  }
+  stats.end_phase();
 
-    const auto& cuts_for_node = cuts.cuts( node );
-    auto cut_count = static_cast<uint32_t>( cuts_for_node.size() );
-    if ( chosen_it->second >= cut_count )
+  // inverter costs of the chosen cuts, next to the inverters the AIG really has
+  uint64_t chosen_inv_cost = 0u;
+  for ( auto i = 0u; i < db.num_nodes; ++i )
+  {
+    auto const& nd = db.nodes[i];
+    auto const c = nd.index < chosen_cut.size() ? chosen_cut[nd.index] : cpsat::no_chosen_cut;
+    if ( c != cpsat::no_chosen_cut && c < nd.num_cuts )
     {
-      std::cerr << "Warning: chosen cut index " << chosen_it->second << " out of range for node " << node_names[idx] << "\n";
-      return;
+      chosen_inv_cost += db.cuts[nd.cut_begin + c].inv_cost;
     }
+  }
 
-    auto cut_iter = cuts_for_node.begin();
-    std::advance( cut_iter, chosen_it->second );
-    auto const& cut = **cut_iter;
-
-    std::vector<decltype( new_ntk )::signal> leaf_signals;
-    bool missing_leaf = false;
-    for ( auto leaf : cut )
+  std::cout << "Original nodes: " << ntk.size() << "\n";
+  std::cout << "Rebuilt nodes:  " << rebuilt_nodes << "\n";
+  std::cout << "Rebuilt PIs:    " << rebuilt_pis << "\n";
+  std::cout << "Rebuilt POs:    " << rebuilt_pos << "\n";
+  std::cout << "Selected nodes: " << st.selected_nodes << "\n";
+  if ( ps.strash )
+  {
+    std::cout << "Strashed nodes: " << st.strashed_nodes << "\n";
+  }
+  std::cout << "Inverter cost:  " << chosen_inv_cost << "\n";
+  if ( aiger )
+  {
+    std::cout << "AIG ANDs:       " << aig_st.ands << "\n";
+    std::cout << "AIG inverters:  " << aig_st.complemented_edges << "\n";
+  }
+  if ( verify )
+  {
+    std::cout << "Verification:   ";
+    if ( !vres.error.empty() )
+      std::cout << "not compared, " << vres.error << "\n";
+    else if ( !vres.equivalent )
+      std::cout << "FAILED, output " << vres.failing_output << " differs after " << vres.patterns << " patterns\n";
+    else
+      std::cout << "equivalent on " << vres.patterns << ( vres.exhaustive ? " patterns (exhaustive)\n" : " random patterns\n" );
+    if ( !vres.counterexample.empty() )
     {
-      const auto leaf_idx = leaf;
-      auto map_it = index_to_new_signal.find( leaf_idx );
-      if ( map_it == index_to_new_signal.end() )
+      std::cout << "Counterexample: ";
+      for ( auto i = 0u; i < vres.counterexample.size(); ++i )
       {
-        std::cerr << "Warning: missing mapped leaf for node " << node_names[idx] << "\n";
-        missing_leaf = true;
-        break;
+        std::cout << ( i ? " " : "" ) << original_sim.pi_names[i] << "=" << vres.counterexample[i];
       }
-      leaf_signals.push_back( map_it->second );
+      std::cout << "\n";
     }
-    if ( missing_leaf )
-    {
-      return;
-    }
-
-    auto tt = cuts.truth_table( cut );
-    auto new_sig = new_ntk.create_node( leaf_signals, tt );
-    index_to_new_signal[idx] = new_sig;
-    ++selected_nodes;
-  } );
+  }
+  std::cout << "Cut limit:      " << db.cut_limit << " (priority " << cpsat::cut_priority_name( db.priority ) << ")\n";
 
-  for ( auto const& out_name : output_names )
+  if ( !stats_file.empty() )
   {
-    bool created = false;
-
-    auto idx_it = name_to_index.find( out_name );
-    if ( idx_it != name_to_index.end() )
+    stats.set( "original_nodes", ntk.size() );
+    stats.set( "rebuilt_nodes", rebuilt_nodes );
+    stats.set( "selected_nodes", st.selected_nodes );
+    stats.set( "strashed_nodes", st.strashed_nodes );
+    stats.set( "inv_cost", chosen_inv_cost );
+    if ( aiger )
     {
-      auto sig_it = index_to_new_signal.find( idx_it->second );
-      if ( sig_it != index_to_new_signal.end() )
-      {
-        new_ntk.create_po( sig_it->second, out_name );
-        created = true;
-      }
+      stats.set( "aig_ands", aig_st.ands );
+      stats.set( "aig_complemented_edges", aig_st.complemented_edges );
     }
-
-    if ( !created )
+    if ( verify )
     {
-      auto pi_it = pi_name_to_signal.find( out_name );
-      if ( pi_it != pi_name_to_signal.end() )
+      stats.set( "verify_patterns", vres.patterns );
+      stats.set( "verify_exhaustive", vres.exhaustive );
+      stats.set( "verify_equivalent", vres.equivalent );
+      if ( !vres.error.empty() )
       {
-        new_ntk.create_po( pi_it->second, out_name );
-        created = true;
+        stats.set( "verify_error", vres.error );
       }
     }
-
-    if ( !created )
+    stats.set( "windows", static_cast<uint64_t>( manifest.windows.size() ) );
+    stats.set( "cut_nodes", db.num_nodes );
+    stats.set( "cuts", db.num_cuts );
+    stats.set( "truth_table_words", db.num_tt_words );
+    stats.set( "bytes_read", bytes_read );
+    stats.set( "bytes_written", cpsat::file_bytes( output_blif ) );
+    stats.set_cuts_per_node( cpsat::cut_count_histogram( db ) );
+    if ( !stats.write( stats_file ) )
     {
-      std::cerr << "[warn] could not create PO for " << out_name << "\n";
+      std::cerr << "Warning: could not write stats '" << stats_file << "'\n";
     }
   }
 
-  write_blif( new_ntk, output_blif );
-
-  std::cout << "Original nodes: " << ntk.size() << "\n";
-  std::cout << "Rebuilt nodes:  " << new_ntk.size() << "\n";
-  std::cout << "Rebuilt PIs:    " << new_ntk.num_pis() << "\n";
-  std::cout << "Rebuilt POs:    " << new_ntk.num_pos() << "\n";
-  std::cout << "Selected nodes: " << selected_nodes << "\n";
-
-  return 0;
+  if ( verify && !vres.error.empty() )
+  {
+    return 6;
+  }
+  return verify && !vres.equivalent ? 5 : 0;
 }
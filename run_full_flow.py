@@ -2,12 +2,16 @@
 
 import argparse
 import csv
+import json
 import shutil
 import subprocess
+import sys
+import threading
 import time
 from datetime import datetime
 from pathlib import Path
 
+from flow_scheduler import Job, Scheduler, parse_stage_cores, parse_workers
 from main_cpsat import solve_circuit
 
 
@@ -31,11 +35,107 @@ def _run(cmd, cwd=None):
     subprocess.run(cmd, check=True, cwd=cwd)
 
 
+def _read_solver_result(returncode, chosen_json):
+    """Status and objective of a solver run, read back from the chosen cuts JSON (exit code 3 = infeasible)."""
+    if returncode != 0 or not Path(chosen_json).is_file():
+        return {"status": "INFEASIBLE" if returncode == 3 else "ERROR", "objective_value": None}
+    with open(chosen_json, "r") as f:
+        result = json.load(f)
+    return {"status": result.get("status", ""), "objective_value": result.get("objective_value")}
+
+
+def _run_native_solver(
+    solver_bin, cuts_path, chosen_json, objective, fix_depth=None, num_workers=None, hint_json=None, fix_hint=False,
+    cone_costs=False,
+):
+    """Run cpsat_solve; status and objective are read back from the chosen cuts JSON."""
+    cmd = [solver_bin, "--cuts", str(cuts_path), "--out", str(chosen_json), "--objective", objective]
+    if fix_depth is not None:
+        cmd += ["--fix-depth", str(fix_depth)]
+    if cone_costs:
+        cmd.append("--cone-costs")
+    if num_workers is not None:
+        cmd += ["--num-workers", str(num_workers)]
+    if hint_json is not None:
+        cmd += ["--hint", str(hint_json)]
+        if fix_hint:
+            cmd.append("--fix-hint")
+    print("[run]", " ".join(str(c) for c in cmd))
+    proc = subprocess.run(cmd)
+    return _read_solver_result(proc.returncode, chosen_json)
+
+
+# Columns filled from the --stats-json files of the C++ tools (prefix -> phases, counters)
+TOOL_STATS_COLUMNS = {
+    "cut_enum": (
+        ("cache_lookup", "read_blif", "enumerate", "export", "write"),
+        ("nodes", "cuts", "distinct_truth_tables", "truth_table_words", "pruned_cuts", "bytes_written"),
+    ),
+    "rebuild": (
+        ("load_cuts", "load_chosen", "read_blif", "rebuild", "write_blif", "write_aiger", "verify"),
+        (
+            "rebuilt_nodes",
+            "selected_nodes",
+            "strashed_nodes",
+            "inv_cost",
+            "aig_ands",
+            "aig_complemented_edges",
+            "verify_equivalent",
+            "bytes_written",
+        ),
+    ),
+}
+
+
+def _tool_stats_headers():
+    headers = []
+    for prefix, (phases, counters) in TOOL_STATS_COLUMNS.items():
+        headers += [f"{prefix}_{phase}_s" for phase in phases]
+        headers.append(f"{prefix}_peak_rss_bytes")
+        headers += [f"{prefix}_{counter}" for counter in counters]
+        headers.append(f"{prefix}_cuts_per_node")
+    return headers
+
+
+def _tool_stats_row(prefix, stats_path):
+    """CSV columns of one tool's stats JSON; empty if the tool did not write it."""
+    if stats_path is None or not Path(stats_path).is_file():
+        return {}
+    with open(stats_path, "r") as f:
+        stats = json.load(f)
+    phases, counters = TOOL_STATS_COLUMNS[prefix]
+    row = {}
+    for phase in phases:
+        if phase in stats.get("phases", {}):
+            row[f"{prefix}_{phase}_s"] = f"{stats['phases'][phase]:.4f}"
+    row[f"{prefix}_peak_rss_bytes"] = stats.get("peak_rss_bytes", "")
+    for counter in counters:
+        if counter in stats.get("counters", {}):
+            row[f"{prefix}_{counter}"] = stats["counters"][counter]
+    # histogram as "cuts:nodes" pairs, e.g. "1:12;5:40"
+    histogram = stats.get("cuts_per_node", [])
+    row[f"{prefix}_cuts_per_node"] = ";".join(f"{n}:{count}" for n, count in enumerate(histogram) if count)
+    return row
+
+
 def _append_stats_row(csv_path, headers, row):
     csv_path = Path(csv_path)
     csv_path.parent.mkdir(parents=True, exist_ok=True)
     write_header = not csv_path.exists() or csv_path.stat().st_size == 0
 
+    if not write_header:
+        # rewrite files started with another column set, keeping their rows
+        with csv_path.open("r", newline="") as f:
+            reader = csv.DictReader(f)
+            old_headers = reader.fieldnames or []
+            if old_headers != list(headers):
+                old_rows = list(reader)
+                headers = list(headers) + [h for h in old_headers if h not in headers]
+                with csv_path.open("w", newline="") as out:
+                    writer = csv.DictWriter(out, fieldnames=headers)
+                    writer.writeheader()
+                    writer.writerows(old_rows)
+
     with csv_path.open("a", newline="") as f:
         writer = csv.DictWriter(f, fieldnames=headers)
         if write_header:
@@ -43,7 +143,34 @@ def _append_stats_row(csv_path, headers, row):
         writer.writerow(row)
 
 
-def _run_single_pipeline(args):
+STATS_HEADERS = [
+    "timestamp",
+    "input_blif",
+    "output_dir",
+    "objective",
+    "cut_size",
+    "final_tool",
+    "cuts_json",
+    "chosen_json",
+    "rebuilt_blif",
+    "cp_sat_status",
+    "cp_sat_objective",
+    "cut_enum_time_s",
+    "cp_sat_time_s",
+    "rebuild_time_s",
+    "final_time_s",
+    "t_pre_s",
+    "t_total_s",
+]
+
+# Cores per stage: the C++ tools are single threaded; None leaves the solver at its own worker counts
+DEFAULT_STAGE_CORES = {"enum": 1, "solve": None, "rebuild": 1}
+# Solve budget of the scheduler when --stage-cores does not give one
+SCHEDULED_SOLVE_CORES = 16
+
+
+def _plan_design(args):
+    """Paths, binaries and tool command lines of one design."""
     input_blif = Path(args.input_blif).resolve()
     if not input_blif.is_file():
         raise FileNotFoundError(f"Input BLIF '{input_blif}' not found")
@@ -54,16 +181,19 @@ def _run_single_pipeline(args):
     out_dir.mkdir(parents=True, exist_ok=True)
 
     stem = args.output_stem or input_blif.stem
-    cuts_json = Path(args.cuts_json) if args.cuts_json else out_dir / f"{stem}_cuts.json"
+    cuts_ext = ".cdb" if args.cuts_format == "binary" else ".json"
+    cuts_json = Path(args.cuts_json) if args.cuts_json else out_dir / f"{stem}_cuts{cuts_ext}"
     chosen_json = Path(args.chosen_json) if args.chosen_json else out_dir / f"{stem}_chosen_cuts.json"
+    # rebuild_from_cpsat writes binary AIGER when the output ends in .aig
+    rebuilt_ext = ".aig" if args.aiger else ".blif"
     if args.rebuilt_blif:
         rebuilt_blif = Path(args.rebuilt_blif)
     elif args.rebuilt_dir:
         rebuilt_dir = Path(args.rebuilt_dir).resolve()
         rebuilt_dir.mkdir(parents=True, exist_ok=True)
-        rebuilt_blif = rebuilt_dir / f"{stem}_rebuilt.blif"
+        rebuilt_blif = rebuilt_dir / f"{stem}_rebuilt{rebuilt_ext}"
     else:
-        rebuilt_blif = out_dir / f"{stem}_rebuilt.blif"
+        rebuilt_blif = out_dir / f"{stem}_rebuilt{rebuilt_ext}"
 
     tools_dir = Path(args.tools_dir).resolve() if args.tools_dir else input_blif.parent
     script_dir = Path(__file__).resolve().parent
@@ -89,99 +219,108 @@ def _run_single_pipeline(args):
         flag_hint="rebuild-bin",
     )
 
-    stage_times = {}
+    solver_bin = None
+    if args.solver == "native":
+        solver_bin = _resolve_binary(
+            args.solver_bin,
+            [tools_dir / "cpsat_solve", script_dir / "cpsat_solve", shutil.which("cpsat_solve")],
+            "cpsat_solve binary",
+            flag_hint="solver-bin",
+        )
 
-    def _record(label, func):
-        start = time.perf_counter()
-        result = func()
-        stage_times[label] = time.perf_counter() - start
-        return result
+    hint_json = out_dir / f"{stem}_hint.json" if args.hint_cover else None
+    eco_base = eco_hint_json = None
+    if args.eco_base:
+        eco_base = Path(args.eco_base).resolve()
+        if not eco_base.is_file():
+            raise FileNotFoundError(f"ECO base cut file '{eco_base}' not found")
+        if eco_base == cuts_json.resolve():
+            # cut_enumeration maps the base while writing the new cut file
+            copy = out_dir / f"{stem}_cuts_base{eco_base.suffix}"
+            shutil.copyfile(eco_base, copy)
+            eco_base = copy
+        if args.eco_chosen:
+            eco_hint_json = out_dir / f"{stem}_eco_hint.json"
+    cut_enum_stats = out_dir / f"{stem}_cut_enum_stats.json" if args.tool_stats else None
+    rebuild_stats = out_dir / f"{stem}_rebuild_stats.json" if args.tool_stats else None
 
-    # 1) cut enumeration
     ce_cmd = [cut_enum_bin, str(input_blif), str(cuts_json)]
     if args.cut_size:
         ce_cmd.append(str(args.cut_size))
-    _record("cut_enumeration", lambda: _run(ce_cmd))
+    ce_cmd += ["--format", args.cuts_format]
+    if args.cut_limit:
+        ce_cmd += ["--cut-limit", str(args.cut_limit)]
+    if args.cut_priority != "none":
+        ce_cmd += ["--cut-priority", args.cut_priority]
+    if args.prune_dominated:
+        ce_cmd.append("--prune-dominated")
+    if args.cut_cache:
+        ce_cmd += ["--cache-dir", str(Path(args.cut_cache).expanduser())]
+    if args.top_n:
+        ce_cmd += ["--top-n", str(args.top_n), "--top-n-objective", args.top_n_objective]
+    if hint_json:
+        ce_cmd += ["--hint-cover", args.hint_cover, "--hint-out", str(hint_json)]
+    if eco_base:
+        ce_cmd += ["--eco-base", str(eco_base)]
+    if eco_hint_json:
+        ce_cmd += ["--eco-chosen", str(Path(args.eco_chosen).resolve()), "--eco-hint-out", str(eco_hint_json)]
+        # the base cover of the unchanged logic is a better start than a greedy one
+        hint_json = eco_hint_json
+    if cut_enum_stats:
+        ce_cmd += ["--stats-json", str(cut_enum_stats)]
 
-    # 2) CP-SAT cut selection
-    cp_sat_result = _record(
-        "cp_sat",
-        lambda: solve_circuit(
-            str(cuts_json),
-            str(chosen_json),
-            objective_mode=args.objective,
-        ),
-    ) or {}
+    rebuild_cmd = [rebuild_bin, str(input_blif), str(cuts_json), str(chosen_json), str(rebuilt_blif)]
+    if args.strash:
+        rebuild_cmd.append("--strash")
+    if args.arena_rebuild:
+        rebuild_cmd.append("--arena")
+    if args.verify:
+        rebuild_cmd.append("--verify")
+    if rebuild_stats:
+        rebuild_cmd += ["--stats-json", str(rebuild_stats)]
+
+    return argparse.Namespace(
+        input_blif=input_blif,
+        out_dir=out_dir,
+        stem=stem,
+        cuts_json=cuts_json,
+        chosen_json=chosen_json,
+        rebuilt_blif=rebuilt_blif,
+        solver_bin=solver_bin,
+        hint_json=hint_json,
+        fix_hint=bool(eco_hint_json and args.eco_fix),
+        cut_enum_stats=cut_enum_stats,
+        rebuild_stats=rebuild_stats,
+        ce_cmd=ce_cmd,
+        rebuild_cmd=rebuild_cmd,
+    )
 
-    cp_status = cp_sat_result.get("status", "")
-    cp_good = cp_status in ("FEASIBLE", "OPTIMAL")
+
+def _solver_command(args, plan, num_workers):
+    """Command line of the CP-SAT stage as a separate process (cpsat_solve or main_cpsat.py)."""
+    if plan.solver_bin:
+        cmd = [plan.solver_bin]
+    else:
+        cmd = [sys.executable, str(Path(__file__).resolve().parent / "main_cpsat.py")]
+    cmd += ["--cuts", str(plan.cuts_json), "--out", str(plan.chosen_json), "--objective", args.objective]
+    if args.fix_depth is not None:
+        cmd += ["--fix-depth", str(args.fix_depth)]
+    if args.cone_costs:
+        cmd.append("--cone-costs")
+    if num_workers is not None:
+        cmd += ["--num-workers", str(num_workers)]
+    if plan.hint_json:
+        cmd += ["--hint", str(plan.hint_json)]
+        if plan.fix_hint:
+            cmd.append("--fix-hint")
+    return cmd
+
+
+def _report_design(args, plan, stage_times, cp_sat_result):
+    """Prints the stage times of one design and appends its stats rows."""
+    cp_good = cp_sat_result.get("status", "") in ("FEASIBLE", "OPTIMAL")
     if not cp_good:
-        print(f"CP-SAT returned status {cp_status}; skipping rebuild and final steps.")
         stage_times["rebuild"] = 0.0
-        stage_times["final"] = 0.0
-        t_pre = sum(stage_times.get(key, 0.0) for key in ("cut_enumeration", "cp_sat", "rebuild"))
-        final_time = 0.0
-        t_opt = 0.0
-        t_total = t_pre + t_opt
-        print(
-            f"T_pre   = {t_pre:.2f}s "
-            f"(cut_enum {stage_times.get('cut_enumeration', 0.0):.2f}s + "
-            f"cp_sat {stage_times.get('cp_sat', 0.0):.2f}s + "
-            f"rebuild {stage_times.get('rebuild', 0.0):.2f}s)"
-        )
-        print("T_opt   = 0.00s (skipped)")
-        print(f"T_total = {t_total:.2f}s")
-        print("Pipeline halted after CP-SAT.")
-        stats_path = Path(args.stats_csv).resolve() if args.stats_csv else out_dir / f"{stem}_stats.csv"
-        stats_headers = [
-            "timestamp",
-            "input_blif",
-            "output_dir",
-            "objective",
-            "cut_size",
-            "final_tool",
-            "cuts_json",
-            "chosen_json",
-            "rebuilt_blif",
-            "cp_sat_status",
-            "cp_sat_objective",
-            "cut_enum_time_s",
-            "cp_sat_time_s",
-            "rebuild_time_s",
-            "final_time_s",
-            "t_pre_s",
-            "t_total_s",
-        ]
-        stats_row = {
-            "timestamp": datetime.now().isoformat(timespec="seconds"),
-            "input_blif": str(input_blif),
-            "output_dir": str(out_dir),
-            "objective": args.objective,
-            "cut_size": args.cut_size if args.cut_size is not None else "",
-            "final_tool": args.final_tool,
-            "cuts_json": str(cuts_json),
-            "chosen_json": str(chosen_json),
-            "rebuilt_blif": str(rebuilt_blif),
-            "cp_sat_status": cp_sat_result.get("status", ""),
-            "cp_sat_objective": cp_sat_result.get("objective_value", ""),
-            "cut_enum_time_s": f"{stage_times.get('cut_enumeration', 0.0):.4f}",
-            "cp_sat_time_s": f"{stage_times.get('cp_sat', 0.0):.4f}",
-            "rebuild_time_s": f"{stage_times.get('rebuild', 0.0):.4f}",
-            "final_time_s": f"{final_time:.4f}",
-            "t_pre_s": f"{t_pre:.4f}",
-            "t_total_s": f"{t_total:.4f}",
-        }
-        _append_stats_row(stats_path, stats_headers, stats_row)
-        print(f"Stats appended to {stats_path}")
-        summary_path = Path(args.summary_csv).resolve() if args.summary_csv else out_dir / "summary_stats.csv"
-        _append_stats_row(summary_path, stats_headers, stats_row)
-        print(f"Summary appended to {summary_path}")
-        return
-
-    # 3) rebuild netlist
-    rebuild_cmd = [rebuild_bin, str(input_blif), str(cuts_json), str(chosen_json), str(rebuilt_blif)]
-    _record("rebuild", lambda: _run(rebuild_cmd))
-
     final_time = 0.0
     # No final mapping step; pipeline ends after rebuild
     stage_times["final"] = 0.0
@@ -195,43 +334,27 @@ def _run_single_pipeline(args):
         f"cp_sat {stage_times.get('cp_sat', 0.0):.2f}s + "
         f"rebuild {stage_times.get('rebuild', 0.0):.2f}s)"
     )
-    if args.final_tool != "none":
+    if not cp_good:
+        print("T_opt   = 0.00s (skipped)")
+    elif args.final_tool != "none":
         print(f"T_opt   = {t_opt:.2f}s ({args.final_tool})")
     else:
         print("T_opt   = 0.00s (no final tool)")
     print(f"T_total = {t_total:.2f}s")
-    print("Pipeline finished successfully.")
-
-    stats_path = Path(args.stats_csv).resolve() if args.stats_csv else out_dir / f"{stem}_stats.csv"
-    stats_headers = [
-        "timestamp",
-        "input_blif",
-        "output_dir",
-        "objective",
-        "cut_size",
-            "final_tool",
-            "cuts_json",
-            "chosen_json",
-            "rebuilt_blif",
-            "cp_sat_status",
-            "cp_sat_objective",
-            "cut_enum_time_s",
-            "cp_sat_time_s",
-            "rebuild_time_s",
-            "final_time_s",
-            "t_pre_s",
-        "t_total_s",
-    ]
+    print("Pipeline finished successfully." if cp_good else "Pipeline halted after CP-SAT.")
+
+    stats_path = Path(args.stats_csv).resolve() if args.stats_csv else plan.out_dir / f"{plan.stem}_stats.csv"
+    stats_headers = STATS_HEADERS + _tool_stats_headers()
     stats_row = {
         "timestamp": datetime.now().isoformat(timespec="seconds"),
-        "input_blif": str(input_blif),
-        "output_dir": str(out_dir),
+        "input_blif": str(plan.input_blif),
+        "output_dir": str(plan.out_dir),
         "objective": args.objective,
         "cut_size": args.cut_size if args.cut_size is not None else "",
         "final_tool": args.final_tool,
-        "cuts_json": str(cuts_json),
-        "chosen_json": str(chosen_json),
-        "rebuilt_blif": str(rebuilt_blif),
+        "cuts_json": str(plan.cuts_json),
+        "chosen_json": str(plan.chosen_json),
+        "rebuilt_blif": str(plan.rebuilt_blif),
         "cp_sat_status": cp_sat_result.get("status", ""),
         "cp_sat_objective": cp_sat_result.get("objective_value", ""),
         "cut_enum_time_s": f"{stage_times.get('cut_enumeration', 0.0):.4f}",
@@ -241,20 +364,161 @@ def _run_single_pipeline(args):
         "t_pre_s": f"{t_pre:.4f}",
         "t_total_s": f"{t_total:.4f}",
     }
+    stats_row.update(_tool_stats_row("cut_enum", plan.cut_enum_stats))
+    if cp_good:
+        stats_row.update(_tool_stats_row("rebuild", plan.rebuild_stats))
     _append_stats_row(stats_path, stats_headers, stats_row)
     print(f"Stats appended to {stats_path}")
-    summary_path = Path(args.summary_csv).resolve() if args.summary_csv else out_dir / "summary_stats.csv"
+    summary_path = Path(args.summary_csv).resolve() if args.summary_csv else plan.out_dir / "summary_stats.csv"
     _append_stats_row(summary_path, stats_headers, stats_row)
     print(f"Summary appended to {summary_path}")
 
 
+def _run_single_pipeline(args):
+    plan = _plan_design(args)
+    solve_workers = parse_stage_cores(args.stage_cores, DEFAULT_STAGE_CORES)["solve"]
+    stage_times = {}
+
+    def _record(label, func):
+        start = time.perf_counter()
+        result = func()
+        stage_times[label] = time.perf_counter() - start
+        return result
+
+    # 1) cut enumeration
+    _record("cut_enumeration", lambda: _run(plan.ce_cmd))
+
+    # 2) CP-SAT cut selection
+    if plan.solver_bin:
+        cp_sat_result = _record(
+            "cp_sat",
+            lambda: _run_native_solver(
+                plan.solver_bin,
+                plan.cuts_json,
+                plan.chosen_json,
+                args.objective,
+                args.fix_depth,
+                solve_workers,
+                plan.hint_json,
+                plan.fix_hint,
+                args.cone_costs,
+            ),
+        )
+    else:
+        cp_sat_result = _record(
+            "cp_sat",
+            lambda: solve_circuit(
+                str(plan.cuts_json),
+                str(plan.chosen_json),
+                objective_mode=args.objective,
+                fix_depth=args.fix_depth,
+                num_workers=solve_workers,
+                hint_path=str(plan.hint_json) if plan.hint_json else None,
+                fix_hint=plan.fix_hint,
+                cone_costs=args.cone_costs,
+            ),
+        ) or {}
+
+    cp_status = cp_sat_result.get("status", "")
+    if cp_status in ("FEASIBLE", "OPTIMAL"):
+        # 3) rebuild netlist
+        _record("rebuild", lambda: _run(plan.rebuild_cmd))
+    else:
+        print(f"CP-SAT returned status {cp_status}; skipping rebuild and final steps.")
+    _report_design(args, plan, stage_times, cp_sat_result)
+
+
+def _run_scheduled(args, blif_files):
+    """Runs the designs as enum -> solve -> rebuild job chains on the workers of --cores/--hosts."""
+    stage_cores = parse_stage_cores(args.stage_cores, DEFAULT_STAGE_CORES)
+    if stage_cores["solve"] is None:
+        stage_cores["solve"] = SCHEDULED_SOLVE_CORES
+    workers = parse_workers(args.cores, args.hosts)
+    print(
+        "Scheduling on "
+        + ", ".join(f"{w.name} ({w.cores} cores)" for w in workers)
+        + "; stage cores "
+        + ", ".join(f"{stage}={cores}" for stage, cores in stage_cores.items())
+    )
+
+    scheduler = Scheduler(workers)
+    report_lock = threading.Lock()
+    failed = []
+
+    for blif in blif_files:
+        file_args = argparse.Namespace(**vars(args))
+        file_args.input_blif = str(blif)
+        plan = _plan_design(file_args)
+        stage_times = {}
+        state = {"cp_sat": {}}
+
+        def _log(stage, plan=plan):
+            return plan.out_dir / f"{plan.stem}_{stage}.log"
+
+        def _enum_done(job, plan=plan, stage_times=stage_times):
+            stage_times["cut_enumeration"] = job.seconds
+            if job.returncode != 0:
+                with report_lock:
+                    failed.append(f"{plan.stem} (cut_enumeration, see {job.log_path})")
+                return False
+            return True
+
+        def _solve_done(job, file_args=file_args, plan=plan, stage_times=stage_times, state=state):
+            stage_times["cp_sat"] = job.seconds
+            result = _read_solver_result(job.returncode, plan.chosen_json)
+            state["cp_sat"] = result
+            if result["status"] in ("FEASIBLE", "OPTIMAL"):
+                return True
+            with report_lock:
+                print(f"\n=== {plan.stem}: CP-SAT returned status {result['status']}; skipping rebuild ===")
+                _report_design(file_args, plan, stage_times, result)
+            return False
+
+        def _rebuild_done(job, file_args=file_args, plan=plan, stage_times=stage_times, state=state):
+            stage_times["rebuild"] = job.seconds
+            with report_lock:
+                if job.returncode != 0:
+                    failed.append(f"{plan.stem} (rebuild, see {job.log_path})")
+                    return False
+                print(f"\n=== {plan.stem} ===")
+                _report_design(file_args, plan, stage_times, state["cp_sat"])
+            return True
+
+        scheduler.add_chain(
+            [
+                Job(plan.stem, "enum", plan.ce_cmd, stage_cores["enum"], _log("enum"), _enum_done),
+                Job(
+                    plan.stem,
+                    "solve",
+                    lambda cores, file_args=file_args, plan=plan: _solver_command(file_args, plan, cores),
+                    stage_cores["solve"],
+                    _log("solve"),
+                    _solve_done,
+                ),
+                Job(plan.stem, "rebuild", plan.rebuild_cmd, stage_cores["rebuild"], _log("rebuild"), _rebuild_done),
+            ]
+        )
+
+    start = time.perf_counter()
+    scheduler.run()
+    print(f"\nScheduled {len(blif_files)} designs in {time.perf_counter() - start:.2f}s")
+    failed += scheduler.errors
+    if failed:
+        raise RuntimeError(f"{len(failed)} design(s) failed: " + "; ".join(failed))
+
+
 def run_pipeline(args):
     input_path = Path(args.input_blif).resolve()
+    if input_path.is_dir() and args.eco_base:
+        raise ValueError("--eco-base takes the cut file of one design; pass a BLIF file, not a directory")
     if input_path.is_dir():
         blif_files = sorted(p for p in input_path.glob("*.blif") if p.is_file())
         if not blif_files:
             raise FileNotFoundError(f"No BLIF files found in directory '{input_path}'")
         print(f"Found {len(blif_files)} BLIF files in {input_path}")
+        if args.cores or args.hosts:
+            _run_scheduled(args, blif_files)
+            return
         for blif in blif_files:
             print(f"\n=== Processing {blif.name} ===")
             file_args = argparse.Namespace(**vars(args))
@@ -269,22 +533,49 @@ def main(argv=None):
     parser = argparse.ArgumentParser(description="Full BLIF->CP-SAT->rebuild pipeline")
     parser.add_argument("input_blif", help="Original BLIF file to process")
     parser.add_argument("--objective", default="og", choices=["og", "inv", "area", "depth", "overall"], help="CP-SAT objective")
+    parser.add_argument("--fix-depth", type=int, default=None, help="Enforce this global depth in the CP-SAT model, in LUT levels (input-network levels with --cone-costs)")
+    parser.add_argument("--cone-costs", action="store_true", help="Area and depth objectives on the cut cones in the input network instead of leaves and LUT levels")
     parser.add_argument("--cut-size", type=int, default=None, help="Optional K passed to cut_enumeration")
     parser.add_argument("--output-dir", default=None, help="Directory for generated artifacts (defaults to BLIF dir)")
     parser.add_argument("--output-stem", default=None, help="Base name for generated files")
-    parser.add_argument("--cuts-json", default=None, help="Override path for the cut enumeration JSON")
+    parser.add_argument("--cuts-json", default=None, help="Override path for the cut enumeration output (JSON or binary)")
+    parser.add_argument("--cuts-format", choices=["json", "binary"], default="json", help="Cut file format written by cut_enumeration (binary = mmap-able .cdb)")
+    parser.add_argument("--cut-limit", type=int, default=None, help="Cuts kept per node by cut_enumeration, trivial cut included (default 32)")
+    parser.add_argument("--cut-priority", choices=["none", "area", "inv", "depth"], default="none", help="Keep the best --cut-limit cuts per node by this cost")
+    parser.add_argument("--prune-dominated", action="store_true", help="Drop cuts dominated on inv/area/depth cost before export")
+    parser.add_argument("--top-n", type=int, default=None, help="Keep at most N non-trivial cuts per node")
+    parser.add_argument("--top-n-objective", choices=["inv", "area", "depth", "overall"], default="inv", help="Cost ranking used by --top-n")
+    parser.add_argument("--cut-cache", default=None, help="Directory of cut files reused across runs with the same BLIF and cut settings")
+    parser.add_argument("--hint-cover", choices=["area", "depth"], default=None, help="Have cut_enumeration write a greedy cover (<stem>_hint.json) that seeds CP-SAT")
+    parser.add_argument("--eco-base", default=None, help="Cut file of the previous netlist; unchanged logic reuses its cuts (ECO mode)")
+    parser.add_argument("--eco-chosen", default=None, help="Chosen cuts of --eco-base; CP-SAT starts from this cover on the unchanged logic")
+    parser.add_argument("--eco-fix", action="store_true", help="Keep the --eco-chosen cover fixed on the unchanged logic and solve only the changed part")
     parser.add_argument("--chosen-json", default=None, help="Override path for the chosen cuts JSON")
     parser.add_argument("--rebuilt-blif", default=None, help="Override path for the rebuilt BLIF")
     parser.add_argument("--rebuilt-dir", default=None, help="Directory to place rebuilt BLIFs (default: output dir)")
     parser.add_argument("--tools-dir", default=None, help="Directory containing cut_enumeration/rebuild binaries")
     parser.add_argument("--cut-enum-bin", default=None, help="Explicit cut_enumeration binary path")
     parser.add_argument("--rebuild-bin", default=None, help="Explicit rebuild_from_cpsat binary path")
+    parser.add_argument("--strash", action="store_true", help="Merge duplicate LUTs (same function on the same leaves) while rebuilding")
+    parser.add_argument("--arena-rebuild", action="store_true", help="Rebuild into flat preallocated arrays and write the BLIF directly (rebuild_from_cpsat --arena)")
+    parser.add_argument("--aiger", action="store_true", help="Write the rebuilt netlist as binary AIGER (<stem>_rebuilt.aig) for the DAC'19 flow, without blif_to_aig.py")
+    parser.add_argument("--verify", action="store_true", help="Simulate the rebuilt netlist against the input (rebuild_from_cpsat --verify); a difference fails the rebuild")
+    parser.add_argument("--solver", choices=["python", "native"], default="python", help="CP-SAT model builder: main_cpsat.py or the cpsat_solve binary")
+    parser.add_argument("--solver-bin", default=None, help="Explicit cpsat_solve binary path (with --solver native)")
     parser.add_argument("--final-tool", choices=["none"], default="none", help="No downstream tool (mock2abc removed)")
     parser.add_argument("--stop-after-rebuild", action="store_true", help="Skip any final mapping tool and stop after writing rebuilt BLIF")
     parser.add_argument("--final-base", default=None, help="(unused) kept for backward compat")
     parser.add_argument("--stats-csv", default=None, help="CSV file to append pipeline stats (default: <output_dir>/<stem>_stats.csv)")
+    parser.add_argument("--tool-stats", action="store_true", help="Collect per-phase times, peak RSS and cut counts from the C++ tools (--stats-json) into the stats CSV")
     parser.add_argument("--summary-csv", default=None, help="CSV file to append combined stats for all runs (default: <output_dir>/summary_stats.csv)")
+    parser.add_argument("--cores", type=int, default=None, help="Local core budget; with a BLIF directory, runs the stages of different designs concurrently")
+    parser.add_argument("--hosts", default=None, help="Remote workers 'host:cores,...' reached over ssh (shared file system); enables the scheduler")
+    parser.add_argument("--stage-cores", default=None, help="Cores per stage, e.g. 'enum=1,solve=8,rebuild=1'; the solve budget is passed as CP-SAT num_workers")
     args = parser.parse_args(argv)
+    if args.eco_chosen and not args.eco_base:
+        parser.error("--eco-chosen needs --eco-base")
+    if args.eco_fix and not args.eco_chosen:
+        parser.error("--eco-fix needs --eco-chosen")
 
     run_pipeline(args)
 
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/* Worker pool shared by the multi-threaded stages (cut enumeration, BLIF loading). */
+namespace cpsat
+{
+
+/*! \brief Thread count for a `num_threads` setting: 0 means one per hardware thread. */
+inline uint32_t resolve_num_threads( uint32_t num_threads )
+{
+  return num_threads != 0u ? num_threads : std::max( 1u, std::thread::hardware_concurrency() );
+}
+
+/*! \brief Persistent workers running one index range at a time. */
+class thread_pool
+{
+public:
+  explicit thread_pool( uint32_t num_threads )
+  {
+    for ( auto t = 1u; t < num_threads; ++t )
+    {
+      _workers.emplace_back( [this, t]() { worker( t ); } );
+    }
+  }
+
+  ~thread_pool()
+  {
+    {
+      std::lock_guard<std::mutex> lock( _mutex );
+      _stop = true;
+      ++_generation;
+    }
+    _wake.notify_all();
+    for ( auto& w : _workers )
+    {
+      w.join();
+    }
+  }
+
+  uint32_t num_threads() const
+  {
+    return static_cast<uint32_t>( _workers.size() ) + 1u;
+  }
+
+  /*! \brief Calls `fn( thread_id, i )` for all `i < size`; the calling thread is thread 0.
+   *
+   * Threads claim `chunk` consecutive indices at a time; use 1 for few, long items.
+   */
+  void parallel_for( uint32_t size, std::function<void( uint32_t, uint32_t )> const& fn, uint32_t chunk = 16u )
+  {
+    {
+      std::lock_guard<std::mutex> lock( _mutex );
+      _job = &fn;
+      _size = size;
+      _chunk = std::max( chunk, 1u );
+      _next = 0u;
+      _pending = static_cast<uint32_t>( _workers.size() );
+      ++_generation;
+    }
+    _wake.notify_all();
+    run_job( 0u );
+
+    std::unique_lock<std::mutex> lock( _mutex );
+    _done.wait( lock, [this]() { return _pending == 0u; } );
+    _job = nullptr;
+  }
+
+private:
+  void worker( uint32_t tid )
+  {
+    uint64_t seen = 0u;
+    while ( true )
+    {
+      {
+        std::unique_lock<std::mutex> lock( _mutex );
+        _wake.wait( lock, [&]() { return _generation != seen; } );
+        seen = _generation;
+        if ( _stop )
+        {
+          return;
+        }
+      }
+      run_job( tid );
+      {
+        std::lock_guard<std::mutex> lock( _mutex );
+        if ( --_pending == 0u )
+        {
+          _done.notify_one();
+        }
+      }
+    }
+  }
+
+  void run_job( uint32_t tid )
+  {
+    while ( true )
+    {
+      auto const begin = _next.fetch_add( _chunk );
+      if ( begin >= _size )
+      {
+        return;
+      }
+      auto const end = std::min( begin + _chunk, _size );
+      for ( auto i = begin; i < end; ++i )
+      {
+        ( *_job )( tid, i );
+      }
+    }
+  }
+
+private:
+  std::vector<std::thread> _workers;
+  std::mutex _mutex;
+  std::condition_variable _wake;
+  std::condition_variable _done;
+  std::function<void( uint32_t, uint32_t )> const* _job{ nullptr };
+  uint32_t _size{ 0u };
+  uint32_t _chunk{ 16u };
+  std::atomic<uint32_t> _next{ 0u };
+  uint32_t _pending{ 0u };
+  uint64_t _generation{ 0u };
+  bool _stop{ false };
+};
+
+} // namespace cpsat
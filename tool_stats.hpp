@@ -0,0 +1,216 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <system_error>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include <sys/resource.h>
+
+#include "cut_database.hpp"
+
+/* Structured run statistics behind the `--stats-json` flag of the C++ tools.
+ *
+ * A stats file is one JSON object:
+ *
+ *   tool            binary name
+ *   phases          wall time in seconds per phase, in execution order
+ *   total_s         sum of the phases
+ *   peak_rss_bytes  peak resident set size of the process
+ *   counters        tool specific counts (nodes, cuts, truth tables, bytes written, ...)
+ *   cuts_per_node   histogram; entry i is the number of nodes with i cuts
+ *
+ * run_full_flow.py flattens these fields into its stats CSV rows.
+ */
+namespace cpsat
+{
+
+/*! \brief Peak resident set size of this process in bytes (0 if unknown). */
+inline uint64_t peak_rss_bytes()
+{
+  struct rusage usage;
+  if ( ::getrusage( RUSAGE_SELF, &usage ) != 0 )
+  {
+    return 0u;
+  }
+#if defined( __APPLE__ )
+  return static_cast<uint64_t>( usage.ru_maxrss );
+#else
+  return static_cast<uint64_t>( usage.ru_maxrss ) * 1024u;
+#endif
+}
+
+/*! \brief Size of `filename` in bytes (0 if it does not exist). */
+inline uint64_t file_bytes( std::string const& filename )
+{
+  std::error_code ec;
+  auto const size = std::filesystem::file_size( filename, ec );
+  return ec ? 0u : static_cast<uint64_t>( size );
+}
+
+/*! \brief Phase timer and counters of one tool run. */
+class tool_stats
+{
+public:
+  explicit tool_stats( std::string tool )
+      : _tool( std::move( tool ) )
+  {
+  }
+
+  /*! \brief Ends the running phase, if any, and starts `name`. */
+  void begin_phase( std::string name )
+  {
+    end_phase();
+    _phase = std::move( name );
+    _phase_start = std::chrono::steady_clock::now();
+  }
+
+  /*! \brief Ends the running phase; its time is added to earlier runs of the same phase. */
+  void end_phase()
+  {
+    if ( _phase.empty() )
+    {
+      return;
+    }
+    auto const seconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - _phase_start ).count();
+    auto& total = _phases[_phase];
+    total = ( total.is_null() ? 0.0 : total.get<double>() ) + seconds;
+    _phase.clear();
+  }
+
+  template<typename T>
+  void set( std::string const& key, T&& value )
+  {
+    _counters[key] = std::forward<T>( value );
+  }
+
+  void set_cuts_per_node( std::vector<uint64_t> histogram )
+  {
+    _cuts_per_node = std::move( histogram );
+  }
+
+  /*! \brief The statistics as JSON; ends the running phase. */
+  nlohmann::ordered_json to_json()
+  {
+    end_phase();
+    double total = 0.0;
+    for ( auto const& [name, seconds] : _phases.items() )
+    {
+      total += seconds.get<double>();
+    }
+    nlohmann::ordered_json j;
+    j["tool"] = _tool;
+    j["phases"] = _phases;
+    j["total_s"] = total;
+    j["peak_rss_bytes"] = peak_rss_bytes();
+    j["counters"] = _counters;
+    j["cuts_per_node"] = _cuts_per_node;
+    return j;
+  }
+
+  /*! \brief Writes `to_json()` to `filename`; returns false on an I/O error. */
+  bool write( std::string const& filename )
+  {
+    std::ofstream os( filename );
+    os << to_json().dump( 2 ) << "\n";
+    return static_cast<bool>( os );
+  }
+
+private:
+  std::string _tool;
+  std::string _phase;
+  std::chrono::steady_clock::time_point _phase_start;
+  nlohmann::ordered_json _phases = nlohmann::ordered_json::object();
+  nlohmann::ordered_json _counters = nlohmann::ordered_json::object();
+  std::vector<uint64_t> _cuts_per_node;
+};
+
+/*! \brief Cuts-per-node histogram of a cut database. */
+inline std::vector<uint64_t> cut_count_histogram( cut_database_view const& db )
+{
+  std::vector<uint64_t> histogram;
+  for ( auto i = 0u; i < db.num_nodes; ++i )
+  {
+    auto const n = db.nodes[i].num_cuts;
+    if ( n >= histogram.size() )
+    {
+      histogram.resize( n + 1u, 0u );
+    }
+    ++histogram[n];
+  }
+  return histogram;
+}
+
+/*! \brief Cut sink that forwards to `Sink` and counts nodes, cuts and distinct truth tables. */
+template<class Sink>
+class stats_cut_sink
+{
+public:
+  explicit stats_cut_sink( Sink& sink )
+      : _sink( sink )
+  {
+  }
+
+  void begin_node( uint32_t index )
+  {
+    _node_cuts = 0u;
+    _sink.begin_node( index );
+  }
+
+  template<typename LeafIt, typename WordIt>
+  void add_cut( LeafIt leaves_begin, LeafIt leaves_end, WordIt tt_begin, uint32_t inv_cost, uint32_t area_cost, uint32_t depth_cost,
+                uint32_t shared_cost, uint32_t cone_area, uint32_t cone_depth )
+  {
+    auto const num_words = tt_num_words( static_cast<uint32_t>( std::distance( leaves_begin, leaves_end ) ) );
+    _key.assign( tt_begin, tt_begin + num_words );
+    if ( _functions.insert( _key ).second )
+    {
+      _function_words += num_words;
+    }
+    ++_node_cuts;
+    ++_num_cuts;
+    _sink.add_cut( leaves_begin, leaves_end, tt_begin, inv_cost, area_cost, depth_cost, shared_cost, cone_area, cone_depth );
+  }
+
+  void end_node()
+  {
+    if ( _node_cuts >= _histogram.size() )
+    {
+      _histogram.resize( _node_cuts + 1u, 0u );
+    }
+    ++_histogram[_node_cuts];
+    ++_num_nodes;
+    _sink.end_node();
+  }
+
+  /*! \brief Adds the counts to `stats` (counters `nodes`, `cuts`, `truth_tables`, `distinct_truth_tables`, `truth_table_words`). */
+  void report( tool_stats& stats ) const
+  {
+    stats.set( "nodes", _num_nodes );
+    stats.set( "cuts", _num_cuts );
+    stats.set( "truth_tables", _num_cuts );
+    stats.set( "distinct_truth_tables", static_cast<uint64_t>( _functions.size() ) );
+    stats.set( "truth_table_words", _function_words );
+    stats.set_cuts_per_node( _histogram );
+  }
+
+private:
+  Sink& _sink;
+  uint32_t _node_cuts{ 0u };
+  uint64_t _num_nodes{ 0u };
+  uint64_t _num_cuts{ 0u };
+  uint64_t _function_words{ 0u };
+  std::vector<uint64_t> _key;
+  std::unordered_set<std::vector<uint64_t>, detail::word_vector_hash> _functions;
+  std::vector<uint64_t> _histogram;
+};
+
+} // namespace cpsat